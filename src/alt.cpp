@@ -1,6 +1,704 @@
 ﻿// ✅ file verified.
 #include "incl.h"
 #include "decl.h"
+#include "search.h"
+
+/**
+ * @brief Writes the distances of one landmark into its column of the landmark table.
+ *
+ * @detailed
+ * Full tables store the distances as is. Compact tables first derive the landmark scale
+ * `s = ceil(max_d / 65534)` (`1` if the landmark fits in 16 bits, which keeps it exact),
+ * then store `floor(d / s)`, or `0xFFFF` for unreachable nodes. Rounding down is what keeps
+ * the kernels' bound `s * (|dq| - 1) + 1` below the real difference.
+ *
+ * @param table Landmark table (already sized with `assign`).
+ * @param landmark Column to write.
+ * @param dist Distances from the landmark, indexed by node index (`-1` if unreachable).
+ *
+ * @complexity
+ * - Time Complexity: O(V).
+ * - Space Complexity: O(1).
+ */
+void setLandmarkColumn(landmark_table& table, size_t landmark, const std::vector<int>& dist)
+{
+    size_t n = std::min(table.nodeCount(), dist.size());
+    if (!table.compact) {
+        for (size_t idx = 0; idx < n; ++idx) {
+            table.row(idx)[landmark] = dist[idx];
+        }
+        return;
+    }
+
+    int max_d = 0;
+    for (size_t idx = 0; idx < n; ++idx) {
+        max_d = std::max(max_d, dist[idx]);
+    }
+    const int max_q = landmark_table::compact_unreachable - 1;
+    int step = (max_d <= max_q) ? 1 : (int)(((int64_t)max_d + max_q - 1) / max_q);
+    table.scale[landmark] = step;
+    for (size_t idx = 0; idx < n; ++idx) {
+        table.row16(idx)[landmark] = (dist[idx] < 0) ? landmark_table::compact_unreachable : (uint16_t)(dist[idx] / step);
+    }
+}
+
+/**
+ * @brief Converts a full-precision landmark table to the compact 16-bit layout in place.
+ *
+ * @complexity
+ * - Time Complexity: O(V × L).
+ * - Space Complexity: O(V × L) for the compact copy (the full table is released afterwards).
+ */
+void compactLandmarkTable(landmark_table& table)
+{
+    if (table.compact || table.empty()) {
+        return;
+    }
+
+    landmark_table packed;
+    packed.assign(table.nodeCount(), table.landmark_count, -1, true);
+    std::vector<int> column(table.nodeCount());
+    for (size_t l = 0; l < table.landmark_count; ++l) {
+        for (size_t idx = 0; idx < column.size(); ++idx) {
+            column[idx] = table.row(idx)[l];
+        }
+        setLandmarkColumn(packed, l, column);
+    }
+    packed.landmark_nodes = table.landmark_nodes;
+    table = std::move(packed);
+}
+
+/**
+ * @brief Chooses the landmark table layout that fits inside `conf.alt_memory`.
+ *
+ * @detailed
+ * - No budget (`0`) or a budget large enough: full `int` rows.
+ * - Otherwise, compact 16-bit rows (half the memory, slightly weaker bounds).
+ * - If even the compact table does not fit, `nb_alt` is reduced to what does (and saved),
+ *   but never below one padded row of `lane_width` landmarks, which costs the same memory.
+ *
+ * @return `true` if the compact layout must be used.
+ *
+ * @complexity
+ * - Time Complexity: O(1).
+ * - Space Complexity: O(1).
+ */
+static bool chooseCompactLayout(size_t n, config& conf)
+{
+    if (conf.alt_memory <= 0 || n == 0) {
+        return false;
+    }
+    const size_t budget = (size_t)conf.alt_memory * 1048576;
+    if (landmark_table::estimateBytes(n, conf.nb_alt, false) <= budget) {
+        return false;
+    }
+
+    const size_t lane_width = landmark_table::lane_width;
+    if (landmark_table::estimateBytes(n, conf.nb_alt, true) > budget && (size_t)conf.nb_alt > lane_width) {
+        // rows are padded to whole SIMD lanes, so one lane group is the smallest possible table.
+        size_t lanes = budget / (n * sizeof(uint16_t));
+        size_t fitting = std::max(lane_width, lanes / lane_width * lane_width);
+        console("warning", "ALT memory budget too small for " + std::to_string(conf.nb_alt) + " landmarks, using " + std::to_string(fitting) + ". setting new value inside the config.");
+        logger("warning: ALT memory budget too small for " + std::to_string(conf.nb_alt) + " landmarks, using " + std::to_string(fitting) + ". setting new value inside the config.");
+        conf.nb_alt = (int)fitting;
+        updateNbAlt(conf, conf.nb_alt);
+    }
+
+    console("info", "using compact 16-bit landmark distances to fit the ALT memory budget (" + std::to_string(conf.alt_memory) + " MB)");
+    logger("using compact 16-bit landmark distances to fit the ALT memory budget (" + std::to_string(conf.alt_memory) + " MB)");
+    return true;
+}
+
+/**
+ * @brief Resolves the number of worker threads for landmark preprocessing.
+ */
+static size_t landmarkWorkerCount(const config& conf, size_t jobs)
+{
+    size_t nb_workers = (conf.nb_threads > 0) ? (size_t)conf.nb_threads : (size_t)std::thread::hardware_concurrency();
+    return std::max<size_t>(1, std::min(nb_workers, jobs));
+}
+
+/**
+ * @brief Computes one-to-all distances for several landmarks in parallel.
+ *
+ * @detailed
+ * Landmarks are handed out to the workers through an atomic counter; each worker runs
+ * `computeOneToAll()` (Dijkstra, or PHAST if a contraction hierarchy is built) with its
+ * own distance vector and passes it to `on_distances(position, dist)`. Callbacks run
+ * concurrently, so they must only touch data owned by their position (e.g. one column).
+ *
+ * @param gdata Reference to the graph data.
+ * @param conf Configuration (`nb_threads`).
+ * @param nodes Landmark node IDs.
+ * @param first Position of the first landmark to compute (earlier ones are skipped).
+ * @param on_distances Callback `void(size_t position, const std::vector<int>& dist)`.
+ *
+ * @complexity
+ * - Time Complexity: O(L × E log V / T) with `T` workers.
+ * - Space Complexity: O(T × V).
+ */
+template <typename OnDistances>
+static void computeLandmarkDistances(const graph& gdata, const config& conf, const std::vector<int>& nodes, size_t first, OnDistances&& on_distances)
+{
+    if (first >= nodes.size()) {
+        return;
+    }
+    const size_t n = gdata.index_to_node.size();
+    std::atomic<size_t> next(first);
+    std::mutex log_mutex;
+
+    auto workerFunc = [&]() {
+        while (true) {
+            size_t pos = next.fetch_add(1, std::memory_order_relaxed);
+            if (pos >= nodes.size()) {
+                break;
+            }
+            {
+                std::lock_guard<std::mutex> lk(log_mutex);
+                console("info", "processing landmark " + std::to_string(nodes[pos]) + " (" + std::to_string(pos + 1) + "/" + std::to_string(nodes.size()) + ")");
+                logger("processing landmark " + std::to_string(nodes[pos]) + " (" + std::to_string(pos + 1) + "/" + std::to_string(nodes.size()) + ")");
+            }
+            std::vector<int> dist = computeOneToAll(gdata, nodes[pos], n, 1);
+            on_distances(pos, dist);
+        }
+    };
+
+    size_t nb_workers = landmarkWorkerCount(conf, nodes.size() - first);
+    std::vector<std::thread> workers;
+    for (size_t w = 1; w < nb_workers; ++w) {
+        workers.emplace_back(workerFunc);
+    }
+    workerFunc();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+/**
+ * @brief Runs Dijkstra from `root_idx` and records the shortest path tree.
+ *
+ * @param gdata Reference to the graph data.
+ * @param root_idx Internal index of the root.
+ * @param dist Output distances (`-1` if unreachable).
+ * @param parent Output parent index in the tree (`-1` for the root and unreachable nodes).
+ * @param order Output settle order (parents always come before their children).
+ *
+ * @complexity
+ * - Time Complexity: O(E log V).
+ * - Space Complexity: O(V).
+ */
+static void shortestPathTree(const graph& gdata, size_t root_idx, std::vector<int>& dist, std::vector<int>& parent, std::vector<int>& order)
+{
+    const size_t n = gdata.index_to_node.size();
+    dist.assign(n, -1);
+    parent.assign(n, -1);
+    order.clear();
+
+    using state = std::pair<int, size_t>;
+    std::priority_queue<state, std::vector<state>, std::greater<state>> pq;
+    dist[root_idx] = 0;
+    pq.push({ 0, root_idx });
+
+    while (!pq.empty()) {
+        auto [cur_dist, cur_idx] = pq.top();
+        pq.pop();
+        if (dist[cur_idx] != cur_dist) {
+            continue;
+        }
+        order.push_back((int)cur_idx);
+
+        size_t start_edge = gdata.offsets[cur_idx];
+        size_t end_edge = gdata.offsets[cur_idx + 1];
+        for (size_t i = start_edge; i < end_edge; ++i) {
+            size_t nbr_idx = (size_t)gdata.edges[i].target;
+            int nd = cur_dist + gdata.edges[i].weight;
+            if (dist[nbr_idx] < 0 || nd < dist[nbr_idx]) {
+                dist[nbr_idx] = nd;
+                parent[nbr_idx] = (int)cur_idx;
+                pq.push({ nd, nbr_idx });
+            }
+        }
+    }
+}
+
+/**
+ * @brief Farthest-node selection: each new landmark maximizes its distance to the previous ones.
+ *
+ * @detailed
+ * Landmarks already present in the table (its first `landmarks.size()` columns) seed the
+ * minimum distance of every node, so the selection can also continue an existing set. Each
+ * new landmark needs the distances of the previous one, so landmarks are computed one after
+ * the other; the one-to-all search itself is parallel (delta-stepping on `conf.nb_threads`),
+ * or uses PHAST when a hierarchy is built.
+ *
+ * @param gdata Reference to the graph data (table already sized).
+ * @param conf Configuration (`nb_threads`, `sssp_delta`).
+ * @param landmarks Selected landmark node IDs (input: existing ones, output: all of them).
+ * @param count Requested number of landmarks.
+ *
+ * @complexity
+ * - Time Complexity: O(L × (E log V + V)).
+ * - Space Complexity: O(V).
+ */
+static void selectFarthestLandmarks(graph& gdata, const config& conf, std::vector<int>& landmarks, size_t count)
+{
+    auto& table = gdata.dist_landmark;
+    const size_t n = gdata.index_to_node.size();
+    std::vector<int> md(n, std::numeric_limits<int>::max());
+
+    auto absorb = [&](size_t l) {
+        for (size_t idx = 0; idx < n; ++idx) {
+            int d = table.value(idx, l);
+            if (d >= 0 && d < md[idx]) {
+                md[idx] = d;
+            }
+        }
+    };
+    for (size_t l = 0; l < landmarks.size(); ++l) {
+        absorb(l);
+        md[gdata.node_to_index.at(landmarks[l])] = -1;
+    }
+
+    while (landmarks.size() < count) {
+        int nl = -1;
+        if (landmarks.empty()) {
+            for (size_t idx = 0; idx < n; ++idx) {
+                if (nl == -1 || gdata.index_to_node[idx] < nl) {
+                    nl = gdata.index_to_node[idx];
+                }
+            }
+        }
+        else {
+            int mx = -1;
+            for (size_t idx = 0; idx < n; ++idx) {
+                if (md[idx] > mx) {
+                    mx = md[idx];
+                    nl = gdata.index_to_node[idx];
+                }
+            }
+        }
+        if (nl == -1) {
+            return;
+        }
+
+        size_t l = landmarks.size();
+        landmarks.push_back(nl);
+        console("info", "processing landmark " + std::to_string(nl) + " (" + std::to_string(l + 1) + "/" + std::to_string(count) + ")");
+        logger("processing landmark " + std::to_string(nl) + " (" + std::to_string(l + 1) + "/" + std::to_string(count) + ")");
+
+        setLandmarkColumn(table, l, computeOneToAll(gdata, nl, n, conf.nb_threads, conf.sssp_delta));
+        table.landmark_nodes[l] = nl;
+        absorb(l);
+        md[gdata.node_to_index.at(nl)] = -1;
+    }
+}
+
+/**
+ * @brief "Avoid" selection (Goldberg & Harrelson): puts landmarks where the current bounds are weakest.
+ *
+ * @detailed
+ * For each new landmark:
+ * - Grow a shortest path tree from a random root `r`.
+ * - Weight every node by how badly the current landmarks bound it: `d(r,v) - h(r,v)`.
+ * - Size every subtree as the sum of its weights, or `0` if it already contains a landmark.
+ * - Walk down from `r`, always into the largest child subtree; the leaf reached is the new landmark.
+ *
+ * This spreads landmarks "behind" the regions that are poorly covered, which usually
+ * gives smaller search spaces than farthest-node. Like farthest-node, landmarks are chosen
+ * one after the other, and each column is computed with the parallel one-to-all search.
+ *
+ * A round whose leaf is already a landmark adds nothing (e.g. a root drawn in a small
+ * component that is already covered). The count is capped at the number of nodes, and
+ * after `max_stalled_rounds` such rounds in a row, the remaining landmarks are chosen by
+ * `selectFarthestLandmarks()`, which continues from the columns already computed.
+ *
+ * @complexity
+ * - Time Complexity: O(L × (E log V + V × L)).
+ * - Space Complexity: O(V).
+ */
+static void selectAvoidLandmarks(graph& gdata, const config& conf, std::vector<int>& landmarks, size_t count)
+{
+    const int max_stalled_rounds = 32;
+    auto& table = gdata.dist_landmark;
+    const size_t n = gdata.index_to_node.size();
+    count = std::min(count, n);
+    std::mt19937 rng(20240531);
+    int stalled = 0;
+    std::vector<int> dist, parent, order;
+    std::vector<long long> subtree(n);
+    std::vector<int> best_child(n);
+    std::vector<char> is_landmark(n, 0), has_landmark(n);
+    for (int node : landmarks) {
+        is_landmark[gdata.node_to_index.at(node)] = 1;
+    }
+
+    while (landmarks.size() < count && n > 0) {
+        size_t root_idx = rng() % n;
+        shortestPathTree(gdata, root_idx, dist, parent, order);
+
+        for (int v : order) {
+            int bound = table.empty() ? 0 : landmarkLowerBound(table, root_idx, (size_t)v);
+            subtree[v] = std::max(0, dist[v] - bound);
+            best_child[v] = -1;
+            has_landmark[v] = is_landmark[v];
+        }
+        for (size_t k = order.size(); k-- > 1;) {
+            int v = order[k];
+            int p = parent[v];
+            if (has_landmark[v]) {
+                subtree[v] = 0;
+                has_landmark[p] = 1;
+            }
+            subtree[p] += subtree[v];
+            if (best_child[p] < 0 || subtree[v] > subtree[best_child[p]]) {
+                best_child[p] = v;
+            }
+        }
+
+        int leaf = (int)root_idx;
+        while (best_child[leaf] >= 0) {
+            leaf = best_child[leaf];
+        }
+        if (is_landmark[leaf]) {
+            if (++stalled >= max_stalled_rounds) {
+                console("warning", "avoid selection stalled, choosing the remaining landmarks by farthest selection");
+                logger("warning: avoid selection stalled after " + std::to_string(landmarks.size()) + " landmarks, choosing the remaining ones by farthest selection.");
+                selectFarthestLandmarks(gdata, conf, landmarks, count);
+                return;
+            }
+            continue;
+        }
+        stalled = 0;
+
+        size_t l = landmarks.size();
+        int nl = gdata.index_to_node[leaf];
+        landmarks.push_back(nl);
+        is_landmark[leaf] = 1;
+        console("info", "processing landmark " + std::to_string(nl) + " (" + std::to_string(l + 1) + "/" + std::to_string(count) + ")");
+        logger("processing landmark " + std::to_string(nl) + " (" + std::to_string(l + 1) + "/" + std::to_string(count) + ")");
+
+        setLandmarkColumn(table, l, computeOneToAll(gdata, nl, n, conf.nb_threads, conf.sssp_delta));
+        table.landmark_nodes[l] = nl;
+    }
+}
+
+/**
+ * @brief Picks `count` well-spread nodes with a single tree, without computing any landmark distance.
+ *
+ * @detailed
+ * The CSV has no coordinates, so the planar "sector" partition is approximated on the graph:
+ * - A center is found with a double sweep (farthest node `b` from an arbitrary node, then
+ *   the node halfway along the tree path from `b` to its own farthest node).
+ * - The shortest path tree of the center is laid out in DFS pre-order: contiguous ranges of
+ *   this order are subtrees, i.e. connected regions around the center (like angular sectors).
+ * - The order is cut into `count` equal ranges, and the node farthest from the center in each
+ *   range becomes a landmark.
+ *
+ * Selection only costs three Dijkstra runs, so all landmark distances can then be computed
+ * in parallel.
+ *
+ * @complexity
+ * - Time Complexity: O(E log V + V).
+ * - Space Complexity: O(V).
+ */
+static std::vector<int> partitionLandmarkNodes(const graph& gdata, size_t count)
+{
+    const size_t n = gdata.index_to_node.size();
+    std::vector<int> nodes;
+    if (n == 0 || count == 0) {
+        return nodes;
+    }
+
+    std::vector<int> dist, parent, order;
+    auto farthest = [&]() {
+        int best = order.front();
+        for (int v : order) {
+            if (dist[v] > dist[best]) {
+                best = v;
+            }
+        }
+        return best;
+    };
+
+    shortestPathTree(gdata, 0, dist, parent, order);
+    int b = farthest();
+    shortestPathTree(gdata, (size_t)b, dist, parent, order);
+    int c = farthest();
+    int center = c;
+    while (parent[center] >= 0 && dist[center] * 2 > dist[c]) {
+        center = parent[center];
+    }
+    shortestPathTree(gdata, (size_t)center, dist, parent, order);
+
+    // children lists (CSR), then an iterative DFS pre-order.
+    std::vector<size_t> child_offsets(n + 1, 0);
+    for (int v : order) {
+        if (parent[v] >= 0) {
+            child_offsets[parent[v] + 1]++;
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        child_offsets[i + 1] += child_offsets[i];
+    }
+    std::vector<int> children(child_offsets[n]);
+    std::vector<size_t> fill(child_offsets.begin(), child_offsets.end() - 1);
+    for (int v : order) {
+        if (parent[v] >= 0) {
+            children[fill[parent[v]]++] = v;
+        }
+    }
+
+    std::vector<int> preorder;
+    preorder.reserve(order.size());
+    std::vector<int> stack{ center };
+    while (!stack.empty()) {
+        int v = stack.back();
+        stack.pop_back();
+        preorder.push_back(v);
+        for (size_t k = child_offsets[v + 1]; k-- > child_offsets[v];) {
+            stack.push_back(children[k]);
+        }
+    }
+
+    count = std::min(count, preorder.size());
+    for (size_t part = 0; part < count; ++part) {
+        size_t begin = part * preorder.size() / count;
+        size_t end = (part + 1) * preorder.size() / count;
+        int best = preorder[begin];
+        for (size_t k = begin; k < end; ++k) {
+            if (dist[preorder[k]] > dist[best]) {
+                best = preorder[k];
+            }
+        }
+        nodes.push_back(gdata.index_to_node[best]);
+    }
+    return nodes;
+}
+
+/**
+ * @brief Tells whether landmark distances `d` make the bound tight on the arc `u -> v`.
+ */
+static inline bool coversArc(const std::vector<int>& d, size_t u, size_t v, int weight)
+{
+    return d[u] >= 0 && d[v] >= 0 && (d[v] - d[u] == weight || d[u] - d[v] == weight);
+}
+
+/**
+ * @brief "maxCover" selection (Goldberg & Werneck): keeps the candidates covering the most arcs.
+ *
+ * @detailed
+ * An arc is covered by a landmark when its reduced cost is `0`, i.e. the landmark bound is
+ * exact along it; arcs covered by no landmark are where A* loses its guidance.
+ * - `4 × count` candidates are picked with the partition method and their distances are
+ *   computed in parallel. With an ALT memory budget (`conf.alt_memory`), only as many
+ *   candidates as the budget holds full distance vectors for are used; if that is not more
+ *   than `count`, the partition landmarks are returned as they are.
+ * - Landmarks are then chosen greedily by number of newly covered arcs, followed by one
+ *   pass of swaps (replace a landmark by a candidate if the total coverage grows).
+ * - Coverage gains are evaluated in parallel over the candidates.
+ *
+ * @return Selected landmark node IDs (their distances are computed by the caller).
+ *
+ * @complexity
+ * - Time Complexity: O(C × E log V / T + L × C × E / T) with `C = 4L` candidates.
+ * - Space Complexity: O(C × V) for the candidate distances (within `conf.alt_memory`).
+ */
+static std::vector<int> maxCoverLandmarkNodes(const graph& gdata, const config& conf, size_t count)
+{
+    const size_t n = gdata.index_to_node.size();
+    size_t nb_candidates = 4 * count;
+    if (conf.alt_memory > 0 && n > 0) {
+        nb_candidates = std::min(nb_candidates, (size_t)conf.alt_memory * 1048576 / (n * sizeof(int)));
+        if (nb_candidates <= count) {
+            console("warning", "ALT memory budget too small for the maxCover candidates (" + std::to_string(conf.alt_memory) + " MB), using the partition landmarks.");
+            logger("warning: ALT memory budget too small for the maxCover candidates (" + std::to_string(conf.alt_memory) + " MB), using the partition landmarks.");
+            return partitionLandmarkNodes(gdata, count);
+        }
+    }
+    std::vector<int> candidates = partitionLandmarkNodes(gdata, nb_candidates);
+    if (candidates.size() <= count) {
+        return candidates;
+    }
+
+    console("info", "computing " + std::to_string(candidates.size()) + " maxCover candidates");
+    logger("computing " + std::to_string(candidates.size()) + " maxCover candidates");
+    std::vector<std::vector<int>> cand_dist(candidates.size());
+    computeLandmarkDistances(gdata, conf, candidates, 0, [&](size_t pos, const std::vector<int>& dist) {
+        cand_dist[pos] = dist;
+    });
+
+    std::vector<uint16_t> cover_count(gdata.edges.size(), 0);
+    auto forEachArc = [&](auto&& on_arc) {
+        for (size_t u = 0; u < n; ++u) {
+            size_t end_edge = gdata.offsets[u + 1];
+            for (size_t i = gdata.offsets[u]; i < end_edge; ++i) {
+                on_arc(u, i);
+            }
+        }
+    };
+    // arcs that candidate `c` would cover and that are covered `threshold` times now.
+    auto coverage = [&](size_t c, uint16_t threshold) {
+        size_t total = 0;
+        forEachArc([&](size_t u, size_t i) {
+            if (cover_count[i] == threshold && coversArc(cand_dist[c], u, (size_t)gdata.edges[i].target, gdata.edges[i].weight)) {
+                total++;
+            }
+        });
+        return total;
+    };
+    auto apply = [&](size_t c, int delta) {
+        forEachArc([&](size_t u, size_t i) {
+            if (coversArc(cand_dist[c], u, (size_t)gdata.edges[i].target, gdata.edges[i].weight)) {
+                cover_count[i] = (uint16_t)(cover_count[i] + delta);
+            }
+        });
+    };
+    auto parallelGains = [&](const std::vector<char>& selected) {
+        std::vector<size_t> gains(candidates.size(), 0);
+        std::atomic<size_t> next(0);
+        auto workerFunc = [&]() {
+            while (true) {
+                size_t c = next.fetch_add(1, std::memory_order_relaxed);
+                if (c >= candidates.size()) {
+                    break;
+                }
+                if (!selected[c]) {
+                    gains[c] = coverage(c, 0);
+                }
+            }
+        };
+        std::vector<std::thread> workers;
+        for (size_t w = 1; w < landmarkWorkerCount(conf, candidates.size()); ++w) {
+            workers.emplace_back(workerFunc);
+        }
+        workerFunc();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        return gains;
+    };
+
+    std::vector<char> selected(candidates.size(), 0);
+    std::vector<size_t> chosen;
+    while (chosen.size() < count) {
+        std::vector<size_t> gains = parallelGains(selected);
+        size_t best = 0;
+        for (size_t c = 0; c < candidates.size(); ++c) {
+            if (!selected[c] && (selected[best] || gains[c] > gains[best])) {
+                best = c;
+            }
+        }
+        selected[best] = 1;
+        chosen.push_back(best);
+        apply(best, +1);
+    }
+
+    for (size_t k = 0; k < chosen.size(); ++k) {
+        apply(chosen[k], -1);
+        size_t loss = coverage(chosen[k], 0);
+        selected[chosen[k]] = 0;
+        std::vector<size_t> gains = parallelGains(selected);
+        size_t best = chosen[k];
+        for (size_t c = 0; c < candidates.size(); ++c) {
+            if (!selected[c] && c != chosen[k] && gains[c] > loss && (best == chosen[k] || gains[c] > gains[best])) {
+                best = c;
+            }
+        }
+        selected[best] = 1;
+        chosen[k] = best;
+        apply(best, +1);
+    }
+
+    std::vector<int> nodes;
+    for (size_t c : chosen) {
+        nodes.push_back(candidates[c]);
+    }
+    return nodes;
+}
+
+/**
+ * @brief Shrinks the table and the configuration when fewer landmarks than requested were selected, then saves it.
+ *
+ * @complexity
+ * - Time Complexity: O(V × L) if the table is resized or saved, O(1) otherwise.
+ * - Space Complexity: O(V × L).
+ */
+static void finishLandmarkSelection(graph& gdata, config& conf, size_t selected)
+{
+    if (selected < (size_t)std::max(conf.nb_alt, 0)) {
+        logger("warning: only selected " + std::to_string(selected) + " landmarks as the number of requested landmarks exceeds the number of available nodes. setting new value inside the config.");
+        console("warning", "only selected " + std::to_string(selected) + " landmarks as the number of requested landmarks exceeds the number of available nodes. setting new value inside the config.");
+
+        gdata.dist_landmark.resizeLandmarks(selected);
+        conf.nb_alt = selected;
+        updateNbAlt(conf, conf.nb_alt);
+    }
+
+    console("success", "ALT pre-processing complete.");
+    logger("ALT pre-processing complete.");
+
+    if (conf.save_alt) {
+        saveAltData(gdata, conf);
+    }
+}
+
+/**
+ * @brief Reuses a stored landmark table whose landmark count differs from `conf.nb_alt`.
+ *
+ * @detailed
+ * - Same count: the table is used as is.
+ * - More stored landmarks: only the first `nb_alt` columns are kept (a prefix of a greedy
+ *   selection is itself a valid selection), the file is left untouched.
+ * - Fewer stored landmarks: the stored columns are kept and the selection continues from
+ *   them (`avoid`, or farthest-node for every other strategy, since maxcover and partition
+ *   pick their whole set at once), so growing from 16 to 24 landmarks costs 8 searches.
+ *   The grown table is saved again.
+ * - Fewer stored landmarks without their node IDs, or IDs that are not in the
+ *   graph anymore: the table is dropped and everything is recomputed.
+ *
+ * @return `true` if the table can be used, `false` if a full preprocessing is required.
+ *
+ * @complexity
+ * - Time Complexity: O(V × L) to resize, plus one search per added landmark.
+ * - Space Complexity: O(V × L).
+ */
+static bool reuseStoredLandmarks(graph& gdata, config& conf)
+{
+    auto& table = gdata.dist_landmark;
+    size_t stored = table.landmark_count;
+    size_t count = (size_t)std::max(conf.nb_alt, 0);
+    if (stored == count) {
+        return true;
+    }
+    if (stored > count) {
+        console("info", "using the first " + std::to_string(count) + " of the " + std::to_string(stored) + " stored landmarks");
+        logger("using the first " + std::to_string(count) + " of the " + std::to_string(stored) + " stored landmarks");
+        table.resizeLandmarks(count);
+        return true;
+    }
+
+    std::vector<int> landmarks(table.landmark_nodes.begin(), table.landmark_nodes.end());
+    for (int node : landmarks) {
+        if (gdata.node_to_index.find(node) == gdata.node_to_index.end()) {
+            console("warning", "stored landmarks cannot be extended (landmark nodes missing or not in the graph), processing landmarks again");
+            logger("warning: stored landmarks cannot be extended (landmark nodes missing or not in the graph), processing landmarks again.");
+            table.clear();
+            return false;
+        }
+    }
+
+    console("info", "adding " + std::to_string(count - stored) + " landmarks to the " + std::to_string(stored) + " stored ones");
+    logger("adding " + std::to_string(count - stored) + " landmarks to the " + std::to_string(stored) + " stored ones");
+    table.resizeLandmarks(count);
+    if (conf.alt_strategy == "avoid") {
+        selectAvoidLandmarks(gdata, conf, landmarks, count);
+    }
+    else {
+        selectFarthestLandmarks(gdata, conf, landmarks, count);
+    }
+    finishLandmarkSelection(gdata, conf, landmarks.size());
+    return true;
+}
 
 // ✅ function + comment verified.
 /**
@@ -11,21 +709,27 @@
  * heuristic pathfinding by precomputing distances from selected landmark nodes.
  *
  * Functionality:
- * - Uses the farthest-node method to select optimal landmarks.
- * - Computes shortest-path distances using Dijkstra’s algorithm.
+ * - Selects landmarks with the strategy set in `conf.alt_strategy`:
+ *   - `farthest`: farthest-node selection (sequential, the historical default).
+ *   - `avoid`: landmarks placed behind the regions the current ones bound worst (sequential).
+ *   - `maxcover`: best arc coverage among 4× more candidates (parallel).
+ *   - `partition`: one per region of the center's shortest path tree (parallel).
+ * - Computes shortest-path distances using Dijkstra’s algorithm (or the PHAST sweep
+ *   through `computeOneToAll()` when a contraction hierarchy has been built); when the
+ *   landmarks are known in advance, their distances are computed on `conf.nb_threads` workers.
  * - Optionally loads or stores precomputed landmark data for reuse.
  *
  * Steps of the Algorithm:
- * 1. If `save_alt` is enabled, attempt to load precomputed landmark data from storage.
- * 2. Initialize storage structures for distance calculations.
- * 3. Select the first landmark as the node with the smallest ID (e.g., ID 1 if available).
- * 4. Compute shortest-path distances using Dijkstra’s algorithm:
- *    - `dist_landmark[i][j]` stores the shortest path distance from landmark `j` to node `i`.
- * 5. Iteratively select `nb_alt` landmarks using the farthest-node heuristic:
- *    - Find the node that has the maximum minimum distance from previous landmarks.
- *    - Recompute shortest-path distances using Dijkstra’s algorithm.
- *    - If no more landmarks can be choosen, break the loop and modify the configuration.
- * 6. If `save_alt` is enabled, store the precomputed landmark data.
+ * 1. If `save_alt` is enabled, attempt to load precomputed landmark data from storage;
+ *    if it holds a different number of landmarks, `reuseStoredLandmarks()` truncates it or
+ *    only computes the missing landmarks.
+ * 2. Initialize storage structures for distance calculations (compact 16-bit rows if the
+ *    full table would exceed `conf.alt_memory`).
+ * 3. Select the landmarks and fill the table:
+ *    - `dist_landmark.row(i)[j]` stores the shortest path distance from landmark `j` to node `i`.
+ *    - All node loops run over dense indices (no `node_to_index` scans).
+ * 4. If fewer landmarks than requested could be chosen, shrink the table and update the configuration.
+ * 5. If `save_alt` is enabled, store the precomputed landmark data.
  *
  * Mathematical Background:
  * - Landmark heuristics use the triangle inequality:
@@ -35,8 +739,8 @@
  *   where:
  *   - `d_L(n)` is the precomputed distance from landmark `L` to node `n`.
  *
- * - The farthest-node landmark selection ensures a wide spread of landmarks,
- *   improving heuristic accuracy in large graphs.
+ * - Well-spread landmarks (behind the source or beyond the target of most queries)
+ *   give tighter bounds, hence smaller search spaces.
  *
  * Edge Cases:
  * - If no valid landmarks are found, preprocessing stops early.
@@ -46,100 +750,50 @@
  * @param conf Reference to the configuration settings, which determine landmark count and storage options.
  *
  * @complexity
- * - Time Complexity: O(nb_alt * (E log V))
- *   - Each landmark selection involves a Dijkstra search → O(E log V).
- *   - `nb_alt` landmark selections are performed.
+ * - Time Complexity: O(nb_alt * (E log V)), divided by the number of threads for the parallel strategies.
  * - Space Complexity: O(V * nb_alt)
- *   - Each node stores distances to all selected landmarks.
+ *   - Each node stores distances to all selected landmarks (4 bytes each, 2 in compact mode).
  */
 void preprocessAlt(graph& gdata, config& conf)
 {
     if (conf.save_alt)
     {
-        if (loadAltData(gdata, conf)) {
+        if (loadAltData(gdata, conf) && reuseStoredLandmarks(gdata, conf)) {
+            if (!gdata.dist_landmark.compact && conf.alt_memory > 0
+                && gdata.dist_landmark.byteSize() > (size_t)conf.alt_memory * 1048576) {
+                console("info", "compacting loaded landmark distances to fit the ALT memory budget");
+                logger("compacting loaded landmark distances to fit the ALT memory budget");
+                compactLandmarkTable(gdata.dist_landmark);
+            }
             return;
         }
     }
 
-    logger("selecting landmarks using farthest-node strategy");
+    logger("selecting landmarks using " + conf.alt_strategy + " strategy");
 
-    size_t n = gdata.node_to_index.size();
+    size_t n = gdata.index_to_node.size();
+    bool compact = chooseCompactLayout(n, conf);
+    gdata.dist_landmark.assign(n, conf.nb_alt, -1, compact);
 
+    size_t count = (size_t)std::max(conf.nb_alt, 0);
     std::vector<int> landmarks;
-    landmarks.reserve(conf.nb_alt);
-    std::vector<int> md(n, std::numeric_limits<int>::max());
-    std::vector<int> d(n, -1);
-
-    gdata.dist_landmark.resize(n, std::vector<int>(conf.nb_alt, -1));
+    landmarks.reserve(count);
 
-    int fl = std::numeric_limits<int>::max();
-    for (const auto& kv : gdata.node_to_index)
-    {
-        if (kv.first < fl)
-            fl = kv.first;
+    if (conf.alt_strategy == "avoid") {
+        selectAvoidLandmarks(gdata, conf, landmarks, count);
     }
-    
-    landmarks.push_back(fl);
-    console("info", "processing landmark " + std::to_string(fl) + " (1/" + std::to_string(conf.nb_alt) + ")");
-    logger("processing landmark " + std::to_string(fl) + " (1/" + std::to_string(conf.nb_alt) + ")");
-
-    d = dijkstraSingleSource(gdata, fl, n);
-    {
-        int i = 0;
-        for (auto& kv : gdata.node_to_index) {
-            size_t idx = kv.second;
-            gdata.dist_landmark[idx][i] = d[idx];
-            if (d[idx] >= 0 && d[idx] < md[idx])
-                md[idx] = d[idx];
-        }
+    else if (conf.alt_strategy == "maxcover" || conf.alt_strategy == "partition") {
+        landmarks = (conf.alt_strategy == "maxcover") ? maxCoverLandmarkNodes(gdata, conf, count)
+                                                      : partitionLandmarkNodes(gdata, count);
+        auto& table = gdata.dist_landmark;
+        computeLandmarkDistances(gdata, conf, landmarks, 0, [&](size_t pos, const std::vector<int>& dist) {
+            setLandmarkColumn(table, pos, dist);
+            table.landmark_nodes[pos] = landmarks[pos];
+        });
     }
-    
-    md[gdata.node_to_index[fl]] = -1;
-
-    for (int i = 1; i < conf.nb_alt; ++i) {
-        int nl = -1;
-        int mx = -1;
-
-        for (auto& kv : gdata.node_to_index) {
-            size_t idx = kv.second;
-            if (md[idx] > mx) {
-                mx = md[idx];
-                nl = kv.first;
-            }
-        }
-
-        if (nl == -1) {
-            logger("warning: only selected " + std::to_string(landmarks.size()) + " landmarks as the number of requested landmarks exceeds the number of available nodes. setting new value inside the config.");
-            console("warning", "only selected " + std::to_string(landmarks.size()) + " landmarks as the number of requested landmarks exceeds the number of available nodes. setting new value inside the config.");
-            
-            conf.nb_alt = landmarks.size();
-            updateNbAlt(conf, conf.nb_alt);
-
-            break;
-        }
-
-        landmarks.push_back(nl);
-        console("info", "processing landmark " + std::to_string(nl) +
-            " (" + std::to_string(i + 1) + "/" + std::to_string(conf.nb_alt) + ")");
-        logger("processing landmark " + std::to_string(nl) +
-            " (" + std::to_string(i + 1) + "/" + std::to_string(conf.nb_alt) + ")");
-
-        d = dijkstraSingleSource(gdata, nl, n);
-        for (auto& kv : gdata.node_to_index) {
-            size_t idx = kv.second;
-            gdata.dist_landmark[idx][i] = d[idx];
-            if (d[idx] >= 0 && d[idx] < md[idx])
-                md[idx] = d[idx];
-        }
-
-        size_t selected_idx = gdata.node_to_index[nl];
-        md[selected_idx] = -1;
+    else {
+        selectFarthestLandmarks(gdata, conf, landmarks, count);
     }
 
-    console("success", "ALT pre-processing complete.");
-    logger("ALT pre-processing complete.");
-
-    if (conf.save_alt) {
-        saveAltData(gdata, conf);
-    }
-}
\ No newline at end of file
+    finishLandmarkSelection(gdata, conf, landmarks.size());
+}
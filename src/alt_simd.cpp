@@ -0,0 +1,259 @@
+﻿#include "incl.h"
+#include "decl.h"
+
+/**
+ * @brief Vectorized kernels for the ALT heuristic.
+ *
+ * Every kernel computes `max_L |a[L] - b[L]|` over two rows of the flat landmark table,
+ * ignoring landmarks where one of the distances is negative (unreachable). Rows are
+ * padded with zeros to a multiple of 8 values, so the AVX2 kernel has no scalar tail.
+ *
+ * The `16` variants read the quantised rows of a compact table: they widen the values
+ * to 32 bits, ignore `0xFFFF` and return `max_L scale[L] * (|a[L] - b[L]| - 1) + 1`
+ * (`0` when the quantised values are equal), a lower bound of the real difference.
+ *
+ * The best kernel supported by the CPU is selected once at startup; binaries built
+ * without `-mavx2` still use AVX2/AVX-512 through per-function target attributes.
+ */
+
+#if defined(HAS_X86_SIMD) && (defined(__GNUC__) || defined(__clang__))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx2,avx512f")))
+#else
+#define TARGET_AVX2
+#define TARGET_AVX512
+#endif
+
+/**
+ * @brief Portable fallback: branch-free loop the compiler can auto-vectorize.
+ *
+ * @complexity
+ * - Time Complexity: O(L).
+ * - Space Complexity: O(1).
+ */
+static int altMaxAbsDiffScalar(const int* row_a, const int* row_b, size_t count)
+{
+    int best_val = 0;
+    for (size_t l = 0; l < count; ++l) {
+        int diff = row_a[l] - row_b[l];
+        diff = (diff < 0) ? -diff : diff;
+        diff = (row_a[l] < 0 || row_b[l] < 0) ? 0 : diff;
+        best_val = (diff > best_val) ? diff : best_val;
+    }
+    return best_val;
+}
+
+/**
+ * @brief Portable fallback for compact (16-bit) rows.
+ *
+ * @complexity
+ * - Time Complexity: O(L).
+ * - Space Complexity: O(1).
+ */
+static int altMaxAbsDiff16Scalar(const uint16_t* row_a, const uint16_t* row_b, const int* scale, size_t count)
+{
+    int best_val = 0;
+    for (size_t l = 0; l < count; ++l) {
+        int diff = (int)row_a[l] - (int)row_b[l];
+        diff = (diff < 0) ? -diff : diff;
+        int bound = diff * scale[l] - (scale[l] - 1);
+        bool valid = row_a[l] != landmark_table::compact_unreachable && row_b[l] != landmark_table::compact_unreachable;
+        bound = valid ? bound : 0;
+        best_val = (bound > best_val) ? bound : best_val;
+    }
+    return best_val;
+}
+
+#if defined(HAS_X86_SIMD)
+
+/**
+ * @brief Horizontal maximum of 8 signed 32-bit lanes.
+ */
+TARGET_AVX2 static inline int horizontalMax8(__m256i v)
+{
+    __m128i m = _mm_max_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    m = _mm_max_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+    m = _mm_max_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(m);
+}
+
+/**
+ * @brief AVX2 kernel: 8 landmarks per iteration, invalid lanes masked to `0`.
+ *
+ * @complexity
+ * - Time Complexity: O(L / 8).
+ * - Space Complexity: O(1).
+ */
+TARGET_AVX2 static int altMaxAbsDiffAvx2(const int* row_a, const int* row_b, size_t count)
+{
+    const __m256i minus_one = _mm256_set1_epi32(-1);
+    __m256i best_val = _mm256_setzero_si256();
+    for (size_t l = 0; l < count; l += 8) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row_a + l));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row_b + l));
+        __m256i diff = _mm256_abs_epi32(_mm256_sub_epi32(va, vb));
+        __m256i valid = _mm256_and_si256(_mm256_cmpgt_epi32(va, minus_one), _mm256_cmpgt_epi32(vb, minus_one));
+        best_val = _mm256_max_epi32(best_val, _mm256_and_si256(diff, valid));
+    }
+    return horizontalMax8(best_val);
+}
+
+/**
+ * @brief AVX-512 kernel: 16 landmarks per iteration, a masked load for the last 8.
+ *
+ * @complexity
+ * - Time Complexity: O(L / 16).
+ * - Space Complexity: O(1).
+ */
+TARGET_AVX512 static int altMaxAbsDiffAvx512(const int* row_a, const int* row_b, size_t count)
+{
+    const __m512i zero = _mm512_setzero_si512();
+    __m512i best_val = zero;
+    size_t l = 0;
+    for (; l + 16 <= count; l += 16) {
+        __m512i va = _mm512_loadu_si512(row_a + l);
+        __m512i vb = _mm512_loadu_si512(row_b + l);
+        __mmask16 valid = _mm512_cmpge_epi32_mask(va, zero) & _mm512_cmpge_epi32_mask(vb, zero);
+        best_val = _mm512_mask_max_epi32(best_val, valid, best_val, _mm512_maskz_abs_epi32(valid, _mm512_sub_epi32(va, vb)));
+    }
+    if (l < count) {
+        __mmask16 tail = (__mmask16)((1u << (count - l)) - 1);
+        __m512i va = _mm512_maskz_loadu_epi32(tail, row_a + l);
+        __m512i vb = _mm512_maskz_loadu_epi32(tail, row_b + l);
+        __mmask16 valid = tail & _mm512_cmpge_epi32_mask(va, zero) & _mm512_cmpge_epi32_mask(vb, zero);
+        best_val = _mm512_mask_max_epi32(best_val, valid, best_val, _mm512_maskz_abs_epi32(valid, _mm512_sub_epi32(va, vb)));
+    }
+    __m256i lo = _mm512_maskz_extracti64x4_epi64(0xFF, best_val, 0);
+    __m256i hi = _mm512_maskz_extracti64x4_epi64(0xFF, best_val, 1);
+    return horizontalMax8(_mm256_max_epi32(lo, hi));
+}
+
+/**
+ * @brief AVX2 kernel for compact rows: 8 landmarks widened to 32 bits per iteration.
+ *
+ * @complexity
+ * - Time Complexity: O(L / 8).
+ * - Space Complexity: O(1).
+ */
+TARGET_AVX2 static int altMaxAbsDiff16Avx2(const uint16_t* row_a, const uint16_t* row_b, const int* scale, size_t count)
+{
+    const __m256i unreachable = _mm256_set1_epi32(landmark_table::compact_unreachable);
+    const __m256i one = _mm256_set1_epi32(1);
+    __m256i best_val = _mm256_setzero_si256();
+    for (size_t l = 0; l < count; l += 8) {
+        __m256i va = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row_a + l)));
+        __m256i vb = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row_b + l)));
+        __m256i vs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(scale + l));
+        __m256i invalid = _mm256_or_si256(_mm256_cmpeq_epi32(va, unreachable), _mm256_cmpeq_epi32(vb, unreachable));
+        __m256i diff = _mm256_abs_epi32(_mm256_sub_epi32(va, vb));
+        __m256i bound = _mm256_sub_epi32(_mm256_mullo_epi32(diff, vs), _mm256_sub_epi32(vs, one));
+        best_val = _mm256_max_epi32(best_val, _mm256_andnot_si256(invalid, bound));
+    }
+    return horizontalMax8(best_val);
+}
+
+/**
+ * @brief AVX-512 kernel for compact rows: 16 landmarks per iteration, a masked step for the last 8.
+ *
+ * @complexity
+ * - Time Complexity: O(L / 16).
+ * - Space Complexity: O(1).
+ */
+TARGET_AVX512 static int altMaxAbsDiff16Avx512(const uint16_t* row_a, const uint16_t* row_b, const int* scale, size_t count)
+{
+    const __m512i unreachable = _mm512_set1_epi32(landmark_table::compact_unreachable);
+    const __m512i one = _mm512_set1_epi32(1);
+    __m512i best_val = _mm512_setzero_si512();
+    size_t l = 0;
+    for (; l < count; l += 16) {
+        __m512i va, vb, vs;
+        __mmask16 lanes = 0xFFFF;
+        if (l + 16 <= count) {
+            va = _mm512_maskz_cvtepu16_epi32(lanes, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row_a + l)));
+            vb = _mm512_maskz_cvtepu16_epi32(lanes, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row_b + l)));
+            vs = _mm512_loadu_si512(scale + l);
+        }
+        else {
+            lanes = 0x00FF;
+            __m256i ha = _mm256_inserti128_si256(_mm256_setzero_si256(), _mm_loadu_si128(reinterpret_cast<const __m128i*>(row_a + l)), 0);
+            __m256i hb = _mm256_inserti128_si256(_mm256_setzero_si256(), _mm_loadu_si128(reinterpret_cast<const __m128i*>(row_b + l)), 0);
+            va = _mm512_maskz_cvtepu16_epi32(lanes, ha);
+            vb = _mm512_maskz_cvtepu16_epi32(lanes, hb);
+            vs = _mm512_maskz_loadu_epi32(lanes, scale + l);
+        }
+        __mmask16 valid = lanes & _mm512_cmpneq_epi32_mask(va, unreachable) & _mm512_cmpneq_epi32_mask(vb, unreachable);
+        __m512i diff = _mm512_maskz_abs_epi32(valid, _mm512_sub_epi32(va, vb));
+        __m512i bound = _mm512_maskz_sub_epi32(valid, _mm512_maskz_mullo_epi32(valid, diff, vs), _mm512_maskz_sub_epi32(valid, vs, one));
+        best_val = _mm512_mask_max_epi32(best_val, valid, best_val, bound);
+    }
+    __m256i lo = _mm512_maskz_extracti64x4_epi64(0xFF, best_val, 0);
+    __m256i hi = _mm512_maskz_extracti64x4_epi64(0xFF, best_val, 1);
+    return horizontalMax8(_mm256_max_epi32(lo, hi));
+}
+
+#endif
+
+/**
+ * @brief Detects the widest vector extension supported by the running CPU (and OS).
+ *
+ * @return `2` for AVX-512F, `1` for AVX2, `0` otherwise.
+ *
+ * @complexity
+ * - Time Complexity: O(1).
+ * - Space Complexity: O(1).
+ */
+static int detectSimdLevel()
+{
+#if defined(HAS_X86_SIMD) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return 2;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return 1;
+    }
+#elif defined(HAS_X86_SIMD) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+    __cpuid(info, 1);
+    bool os_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28));
+    if (max_leaf >= 7 && os_avx) {
+        unsigned long long xcr0 = _xgetbv(0);
+        __cpuidex(info, 7, 0);
+        if ((info[1] & (1 << 16)) && (xcr0 & 0xE6) == 0xE6) {
+            return 2;
+        }
+        if ((info[1] & (1 << 5)) && (xcr0 & 0x6) == 0x6) {
+            return 1;
+        }
+    }
+#endif
+    return 0;
+}
+
+static const int simd_level = detectSimdLevel();
+
+#if defined(HAS_X86_SIMD)
+alt_kernel_fn altMaxAbsDiff = (simd_level == 2) ? altMaxAbsDiffAvx512 : (simd_level == 1) ? altMaxAbsDiffAvx2 : altMaxAbsDiffScalar;
+alt_kernel16_fn altMaxAbsDiff16 = (simd_level == 2) ? altMaxAbsDiff16Avx512 : (simd_level == 1) ? altMaxAbsDiff16Avx2 : altMaxAbsDiff16Scalar;
+#else
+alt_kernel_fn altMaxAbsDiff = altMaxAbsDiffScalar;
+alt_kernel16_fn altMaxAbsDiff16 = altMaxAbsDiff16Scalar;
+#endif
+
+/**
+ * @brief Returns the name of the selected kernels (for logs).
+ */
+std::string altKernelName()
+{
+#if defined(HAS_X86_SIMD)
+    if (simd_level == 2) {
+        return "avx512";
+    }
+    if (simd_level == 1) {
+        return "avx2";
+    }
+#endif
+    return "scalar";
+}
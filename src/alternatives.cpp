@@ -0,0 +1,322 @@
+﻿#include "incl.h"
+#include "decl.h"
+#include "search.h"
+
+/**
+ * @brief Grows a bounded shortest path tree for the alternative routes engine.
+ *
+ * @detailed
+ * Plain Dijkstra expansion from `seeds` that writes either the forward buffers
+ * (`dist_from_start` / `parent_forward`) or the backward ones (`dist_from_end` /
+ * `parent_backward`), without bumping `current_search_id`, so both trees of the same
+ * query stay valid at the same time. A seed is its own parent.
+ *
+ * Functionality:
+ * - The seeds are the exits of the root (`searchGraphExits()`, a single seed at `0` for
+ *   a node of the search graph), and `targets` the exits of the opposite endpoint.
+ * - The distance `D` to the opposite endpoint is the best `dist + cost` over the settled
+ *   targets; the search keeps going until the next node would be farther than
+ *   `D × max_stretch`, so every node that can lie on an admissible alternative is settled
+ *   with its exact distance and tree parent.
+ * - Settled nodes are appended to `settled` (in increasing distance order).
+ * - Polls `buffers.cancel`; once it expires the tree stops growing, `buffers.cancel.cancelled`
+ *   is set and `-1` is returned.
+ *
+ * @tparam Forward `true` to fill the forward buffers, `false` for the backward ones.
+ * @param gdata Reference to the graph data.
+ * @param buffers Reference to `search_buffers` (already bumped by the caller).
+ * @param seeds `(index, initial distance)` pairs of the root.
+ * @param targets `(index, cost)` pairs of the opposite endpoint.
+ * @param max_stretch Maximum allowed ratio between an alternative and the shortest path.
+ * @param settled Output list of settled node indices.
+ * @return Distance from the root to the opposite endpoint, or `-1` if it is unreachable.
+ *
+ * @complexity
+ * - Time Complexity: O(E' log V'), with `V'`/`E'` the nodes/edges within `D × max_stretch`.
+ * - Space Complexity: O(V') for the priority queue and the settled list.
+ */
+template <bool Forward>
+static int growBoundedTree(const graph& gdata, search_buffers& buffers, const std::vector<std::pair<size_t, int>>& seeds, const std::vector<std::pair<size_t, int>>& targets, double max_stretch, std::vector<int>& settled)
+{
+    auto getDist = [&](size_t idx) { return Forward ? getDistFromStart(buffers, idx) : getDistFromEnd(buffers, idx); };
+    auto setDist = [&](size_t idx, int value) { Forward ? setDistFromStart(buffers, idx, value) : setDistFromEnd(buffers, idx, value); };
+    auto setParent = [&](size_t idx, std::pair<int, int> value) { Forward ? setParentForward(buffers, idx, value) : setParentBackward(buffers, idx, value); };
+
+    using pq_item = std::pair<int, size_t>;
+    std::priority_queue<pq_item, std::vector<pq_item>, std::greater<pq_item>> open_list;
+    for (const auto& [seed_idx, seed_dist] : seeds) {
+        int old_dist = getDist(seed_idx);
+        if (old_dist >= 0 && old_dist <= seed_dist) {
+            continue;
+        }
+        setDist(seed_idx, seed_dist);
+        setParent(seed_idx, { (int)seed_idx, 0 });
+        open_list.push({ seed_dist, seed_idx });
+    }
+
+    int target_dist = -1;
+    long long limit = std::numeric_limits<long long>::max();
+    size_t polls = 0;
+
+    while (!open_list.empty()) {
+        auto [cur_dist, cur_idx] = open_list.top();
+        open_list.pop();
+
+        if (getDist(cur_idx) != cur_dist) {
+            continue;
+        }
+        if (buffers.cancel.poll(polls)) {
+            buffers.cancel.cancelled = true;
+            return -1;
+        }
+        if (cur_dist > limit) {
+            break;
+        }
+        settled.push_back((int)cur_idx);
+        for (const auto& [target_idx, cost] : targets) {
+            if (target_idx == cur_idx && (target_dist < 0 || cur_dist + cost < target_dist)) {
+                target_dist = cur_dist + cost;
+                limit = (long long)(target_dist * max_stretch);
+            }
+        }
+
+        size_t start_edge = gdata.offsets[cur_idx];
+        size_t end_edge = gdata.offsets[cur_idx + 1];
+
+        for (size_t i = start_edge; i < end_edge; ++i) {
+            const auto& edge = gdata.edges[i];
+            size_t nbr_idx = (size_t)edge.target;
+            int new_dist = cur_dist + edge.weight;
+            int old_dist = getDist(nbr_idx);
+            if (old_dist < 0 || new_dist < old_dist) {
+                setDist(nbr_idx, new_dist);
+                setParent(nbr_idx, { (int)cur_idx, edge.weight });
+                open_list.push({ new_dist, nbr_idx });
+            }
+        }
+    }
+    return target_dist;
+}
+
+/**
+ * @brief Computes up to `max_routes` diverse near-optimal routes between two nodes.
+ *
+ * @detailed
+ * Plateau / via-node method: a single pair of bounded searches (a forward tree from the
+ * start and a backward tree from the end) provides every candidate at once, instead of
+ * issuing one point-to-point query per alternative.
+ *
+ * Functionality:
+ * - Plateaus: a tree edge `x -> y` of the forward tree that is also a tree edge `y -> x`
+ *   of the backward tree belongs to a plateau. A maximal chain of such edges `a ... b` is
+ *   a shortest subpath shared by both trees, and `start -> a -> b -> end` (forward parents
+ *   up to `a`, backward parents after it) is a candidate route of length
+ *   `d_start(a) + d_end(a)`.
+ * - The plateau starting at a root of the forward tree with the shortest length always
+ *   yields a shortest path and is taken first.
+ * - The other candidates are ranked by their detour outside the plateau
+ *   (`length - plateau length`), then filtered by:
+ *   - stretch: `length <= D × max_stretch`,
+ *   - local optimality: `plateau length >= D × min_plateau` (long plateaus mean that the
+ *     route is made of long shortest subpaths, so it has no pointless detours),
+ *   - overlap: the length shared with the already selected routes must not exceed
+ *     `length × max_overlap`,
+ *   - simplicity: routes visiting a node twice are dropped.
+ * - The (otherwise unused) `h_forward` buffer marks nodes already assigned to a plateau.
+ * - Graph reduction: both trees are rooted at the exits of their endpoint
+ *   (`searchGraphExits()`), and each candidate is rebuilt on the original graph by
+ *   `routeThroughTrees()` (walks to the exits, expanded chains). When both endpoints
+ *   share a tree or chain, the walk inside it (`reducedLocalDistance()`) is a candidate
+ *   too, taken first if it is the shortest. Overlap is measured on the search graph.
+ *
+ * @param gdata Reference to the graph data.
+ * @param buffers Reference to `search_buffers` for optimized memory management.
+ * @param start_node The starting node.
+ * @param end_node The target node.
+ * @param max_routes Maximum number of routes to return (shortest path included).
+ * @param max_stretch Maximum ratio between an alternative and the shortest path (e.g. `1.25`).
+ * @param max_overlap Maximum shared fraction with the already selected routes (e.g. `0.8`).
+ * @param min_plateau Minimum plateau length as a fraction of the shortest path (e.g. `0.25`).
+ * @return The selected routes, shortest first (empty if no path exists or `buffers.cancel` expired).
+ *
+ * @complexity
+ * - Time Complexity: O(E' log V') for both trees, plus O(V') for the plateaus and
+ *   O(R × P) to build and check the `R` inspected candidates of `P` nodes.
+ * - Space Complexity: O(V') for the trees, plateaus and selected edges.
+ */
+std::vector<path_result> findAlternativeRoutes(const graph& gdata, search_buffers& buffers, int start_node, int end_node, int max_routes, double max_stretch, double max_overlap, double min_plateau)
+{
+    std::vector<path_result> routes;
+
+    auto start_exits = searchGraphExits(gdata, start_node);
+    auto end_exits = searchGraphExits(gdata, end_node);
+    if (start_exits.empty() || end_exits.empty() || max_routes <= 0) {
+        return routes;
+    }
+    if (start_node == end_node) {
+        routes.push_back({ 0, 0, {} });
+        return routes;
+    }
+
+    auto toSeeds = [&](const std::vector<std::pair<int, int>>& exits) {
+        std::vector<std::pair<size_t, int>> seeds;
+        for (const auto& [node, cost] : exits) {
+            seeds.push_back({ gdata.node_to_index.at(node), cost });
+        }
+        return seeds;
+    };
+    const auto start_seeds = toSeeds(start_exits);
+    const auto end_seeds = toSeeds(end_exits);
+    auto noSearch = [](int, int) { return path_result{ -1, 0, {} }; };
+
+    path_result local{ -1, 0, {} };
+    if (isReducedNode(gdata, start_node) && isReducedNode(gdata, end_node)) {
+        local = routeThroughTrees(gdata, start_node, end_node, false, noSearch);
+    }
+
+    buffers.current_search_id++;
+    std::vector<int> settled_forward;
+    std::vector<int> settled_backward;
+    int shortest = growBoundedTree<true>(gdata, buffers, start_seeds, end_seeds, max_stretch, settled_forward);
+    if (buffers.cancel.cancelled) {
+        return routes;
+    }
+    if (shortest < 0) {
+        if (local.total_time >= 0) {
+            routes.push_back(std::move(local));
+        }
+        return routes;
+    }
+    if (growBoundedTree<false>(gdata, buffers, end_seeds, start_seeds, max_stretch, settled_backward) < 0) {
+        return routes;
+    }
+
+    const int best = (local.total_time >= 0) ? std::min(local.total_time, shortest) : shortest;
+    if (local.total_time >= 0 && local.total_time <= shortest) {
+        routes.push_back(std::move(local));
+    }
+
+    const long long limit = (long long)(best * max_stretch);
+    auto totalVia = [&](int idx) -> long long {
+        int df = getDistFromStart(buffers, idx);
+        int db = getDistFromEnd(buffers, idx);
+        return (df < 0 || db < 0) ? -1 : (long long)df + db;
+    };
+    auto inBothTrees = [&](int idx) {
+        long long total = totalVia(idx);
+        return total >= 0 && total <= limit;
+    };
+    auto isStartRoot = [&](int idx) { return getParentForward(buffers, idx).first == idx; };
+    auto isEndRoot = [&](int idx) { return getParentBackward(buffers, idx).first == idx; };
+
+    struct plateau {
+        int first;          // plateau node closest to the start
+        int length;
+        long long total;
+    };
+    std::vector<plateau> plateaus;
+
+    for (int idx : settled_forward) {
+        if (!inBothTrees(idx) || getHForward(buffers, idx) >= 0) {
+            continue;
+        }
+        int first = idx;
+        while (!isStartRoot(first)) {
+            int prev = getParentForward(buffers, first).first;
+            if (!inBothTrees(prev) || getParentBackward(buffers, prev).first != first) {
+                break;
+            }
+            first = prev;
+        }
+        int last = first;
+        setHForward(buffers, first, 0);
+        while (!isEndRoot(last)) {
+            int next = getParentBackward(buffers, last).first;
+            if (!inBothTrees(next) || getParentForward(buffers, next).first != last) {
+                break;
+            }
+            last = next;
+            setHForward(buffers, last, 0);
+        }
+        plateaus.push_back({ first, getDistFromStart(buffers, last) - getDistFromStart(buffers, first), totalVia(first) });
+    }
+
+    auto isShortest = [&](const plateau& p) { return isStartRoot(p.first) && p.total == shortest; };
+    std::sort(plateaus.begin(), plateaus.end(), [&](const plateau& a, const plateau& b) {
+        if (isShortest(a) != isShortest(b)) {
+            return isShortest(a);
+        }
+        long long detour_a = a.total - a.length;
+        long long detour_b = b.total - b.length;
+        return (detour_a != detour_b) ? detour_a < detour_b : a.total < b.total;
+    });
+
+    std::unordered_set<std::pair<int, int>, pair_hash> used_edges;
+    const int min_plateau_length = (int)(best * min_plateau);
+
+    for (const auto& p : plateaus) {
+        if ((int)routes.size() >= max_routes) {
+            break;
+        }
+        bool is_shortest = routes.empty();
+        if (!is_shortest && p.length < min_plateau_length) {
+            continue;
+        }
+
+        std::vector<int> path;
+        std::vector<int> leg_weights;
+        int cur = p.first;
+        while (!isStartRoot(cur)) {
+            auto par = getParentForward(buffers, cur);
+            path.push_back(cur);
+            leg_weights.push_back(par.second);
+            cur = par.first;
+        }
+        path.push_back(cur);
+        std::reverse(path.begin(), path.end());
+        std::reverse(leg_weights.begin(), leg_weights.end());
+        const int core_start = cur;
+        cur = p.first;
+        while (!isEndRoot(cur)) {
+            auto par = getParentBackward(buffers, cur);
+            leg_weights.push_back(par.second);
+            cur = par.first;
+            path.push_back(cur);
+        }
+        const int core_end = cur;
+
+        long long shared = 0;
+        for (size_t i = 0; i + 1 < path.size(); ++i) {
+            if (used_edges.count({ std::min(path[i], path[i + 1]), std::max(path[i], path[i + 1]) })) {
+                shared += leg_weights[i];
+            }
+        }
+        if (!is_shortest && shared > (long long)(p.total * max_overlap)) {
+            continue;
+        }
+
+        path_result core{};
+        core.total_time = (int)p.total - getDistFromStart(buffers, core_start) - getDistFromEnd(buffers, core_end);
+        core.total_node = (int)path.size();
+        for (int idx : path) {
+            core.steps.push_back(gdata.index_to_node[idx]);
+        }
+        path_result result = routeThroughTrees(gdata, start_node, end_node, false, [&](int a, int b) {
+            return (a == core.steps.front() && b == core.steps.back()) ? core : path_result{ -1, 0, {} };
+        });
+        if (result.total_time != (int)p.total) {
+            continue;
+        }
+        std::unordered_set<int> seen(result.steps.begin(), result.steps.end());
+        if (seen.size() != result.steps.size()) {
+            continue;
+        }
+
+        for (size_t i = 0; i + 1 < path.size(); ++i) {
+            used_edges.insert({ std::min(path[i], path[i + 1]), std::max(path[i], path[i + 1]) });
+        }
+        routes.push_back(std::move(result));
+    }
+
+    return routes;
+}
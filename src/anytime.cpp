@@ -0,0 +1,222 @@
+﻿#include "incl.h"
+#include "decl.h"
+#include "search.h"
+
+namespace {
+    const double anytime_initial_weight = 2.0;      // highest weight accepted by the API
+    const double anytime_weight_step = 0.25;
+    const size_t anytime_clock_interval = 256;      // expansions between two deadline checks
+}
+
+/**
+ * @brief Anytime weighted A* (ARA*): a fast first path, then better ones until the deadline.
+ *
+ * @detailed
+ * Functionality:
+ * - Starts with `weight = 2.0` and runs a weighted A* until the target has the smallest key.
+ *   This first path is always completed, even after the deadline, so a path is returned
+ *   whenever one exists.
+ * - While time remains and the path is not proven optimal, the weight is lowered by `0.25`
+ *   (down to `1.0`) and the search is resumed instead of restarted:
+ *   - nodes improved after being closed (INCONS) go back to the open list,
+ *   - every open key is recomputed with the new weight,
+ *   - the closed set is emptied (a per-round marker stored in `h_backward`).
+ * - A round interrupted by the deadline is dropped; the last completed path is returned.
+ * - The hard timeout (`buffers.cancel`) only applies to the first round: if it expires
+ *   before any path is found, `buffers.cancel.cancelled` is set and "no path" is returned.
+ *
+ * Suboptimality bound:
+ * - After each round, `bound = min(weight, cost / min(g + h))` over OPEN ∪ INCONS.
+ *   Every optimal path keeps a node in that set, so `cost <= bound × optimal`.
+ * - `bound = 1.0` means the returned path is a shortest path.
+ * - The heuristic is the (admissible) ALT bound, so `conf.use_alt` is required.
+ *
+ * Inconsistent bounds:
+ * - Compact (16-bit) tables and unrepaired live decreases (`slack > 0`) keep the ALT bound
+ *   admissible but not consistent, so a node can be closed with a `g` that improves later.
+ *   Such a node is reopened in the current round (pushed back to OPEN) instead of waiting
+ *   in INCONS, as the unidirectional engine does. Every expanded node then keeps the `g`
+ *   it was expanded with, so an optimal path still has a node in OPEN with its exact `g`,
+ *   and the bound above only relies on admissibility.
+ *
+ * @param gdata Reference to the graph data (with landmarks).
+ * @param buffers Reference to `search_buffers` for optimized memory management.
+ * @param conf Configuration settings for heuristic selection.
+ * @param start_node The starting node.
+ * @param end_node The target node.
+ * @param deadline_ms Time budget of the query, in milliseconds.
+ * @param distance_only If `true`, only `total_time` is computed (`total_node = 0`, no `steps`).
+ * @return The best path found, its proven suboptimality bound and the number of completed rounds.
+ *
+ * @complexity
+ * - Time Complexity: O(R × E log V) in the worst case (R rounds), bounded by the deadline
+ *   once the first path is found.
+ * - Space Complexity: O(V) for the search buffers and the INCONS list.
+ */
+anytime_result findShortestPathAnytime(const graph& gdata, search_buffers& buffers, const config& conf, int start_node, int end_node, int deadline_ms, bool distance_only)
+{
+    anytime_result result{ { -1, 0, {} }, 0.0, 0 };
+    auto it_start = gdata.node_to_index.find(start_node);
+    auto it_end = gdata.node_to_index.find(end_node);
+    if (it_start == gdata.node_to_index.end() || it_end == gdata.node_to_index.end()) {
+        return result;
+    }
+    if (start_node == end_node) {
+        return { { 0, 0, {} }, 1.0, 1 };
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(deadline_ms);
+    const size_t start_idx = it_start->second;
+    const size_t end_idx = it_end->second;
+
+    buffers.current_search_id++;
+    buffers.reuse_search_id = 0;        // the open list is reused here, no tree to resume.
+    auto& open_list = buffers.open_list;
+    open_list.clear();
+    std::vector<size_t> incons;
+
+    using pq_item = std::pair<double, size_t>;
+    auto cmp = [](const pq_item& a, const pq_item& b) {
+        return a.first > b.first;
+    };
+    auto heuristic = [&](size_t idx) {
+        int h_val = getHForward(buffers, idx);
+        if (h_val < 0) {
+            h_val = computeHeuristic(idx, end_idx, gdata, conf);
+            setHForward(buffers, idx, h_val);
+        }
+        return h_val;
+    };
+
+    const bool reopen = gdata.dist_landmark.compact || gdata.dist_landmark.slack > 0;
+    double weight = anytime_initial_weight;
+    int round = 1;
+    auto closedThisRound = [&](size_t idx) {
+        return getHBackward(buffers, idx) == round;
+    };
+    auto key = [&](size_t idx) {
+        return (double)getDistFromStart(buffers, idx) + weight * (double)heuristic(idx);
+    };
+
+    setDistFromStart(buffers, start_idx, 0);
+    open_list.push_back({ key(start_idx), start_idx });
+
+    // returns `false` if the round was interrupted by the deadline.
+    size_t expansions = 0;
+    size_t polls = 0;
+    auto improvePath = [&]() -> bool {
+        while (!open_list.empty()) {
+            const pq_item top_item = open_list.front();
+            const size_t cur_idx = top_item.second;
+            if (closedThisRound(cur_idx) || top_item.first != key(cur_idx)) {
+                std::pop_heap(open_list.begin(), open_list.end(), cmp);
+                open_list.pop_back();
+                continue;
+            }
+            int goal_cost = getDistFromStart(buffers, end_idx);
+            if (goal_cost >= 0 && (double)goal_cost <= top_item.first) {
+                return true;
+            }
+            if (result.rounds > 0 && ++expansions % anytime_clock_interval == 0
+                && std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+            if (result.rounds == 0 && buffers.cancel.poll(polls)) {
+                buffers.cancel.cancelled = true;
+                return false;
+            }
+            std::pop_heap(open_list.begin(), open_list.end(), cmp);
+            open_list.pop_back();
+            setHBackward(buffers, cur_idx, round);
+
+            int cur_cost = getDistFromStart(buffers, cur_idx);
+            size_t end_edge = gdata.offsets[cur_idx + 1];
+            for (size_t i = gdata.offsets[cur_idx]; i < end_edge; ++i) {
+                size_t nbr_idx = gdata.edges[i].target;
+                int new_cost = cur_cost + gdata.edges[i].weight;
+                int old_cost = getDistFromStart(buffers, nbr_idx);
+                if (old_cost >= 0 && new_cost >= old_cost) {
+                    continue;
+                }
+                setDistFromStart(buffers, nbr_idx, new_cost);
+                setParentForward(buffers, nbr_idx, { (int)cur_idx, gdata.edges[i].weight });
+                if (closedThisRound(nbr_idx) && !reopen) {
+                    incons.push_back(nbr_idx);
+                }
+                else {
+                    if (reopen) {
+                        setHBackward(buffers, nbr_idx, 0);
+                    }
+                    open_list.push_back({ key(nbr_idx), nbr_idx });
+                    std::push_heap(open_list.begin(), open_list.end(), cmp);
+                }
+            }
+        }
+        return getDistFromStart(buffers, end_idx) >= 0;
+    };
+
+    auto publish = [&]() {
+        int cost = getDistFromStart(buffers, end_idx);
+        if (distance_only) {
+            result.path = { cost, 0, {} };
+        }
+        else {
+            // parents may have improved since they were set, so the cost is re-summed along the path.
+            std::vector<int> path;
+            int path_cost = 0;
+            for (size_t cur = end_idx; cur != start_idx;) {
+                path.push_back(gdata.index_to_node[cur]);
+                auto par = getParentForward(buffers, cur);
+                path_cost += par.second;
+                cur = (size_t)par.first;
+            }
+            path.push_back(gdata.index_to_node[start_idx]);
+            std::reverse(path.begin(), path.end());
+            cost = path_cost;
+            result.path = { cost, (int)path.size(), std::move(path) };
+        }
+
+        double lower = (double)cost;
+        for (const auto& item : open_list) {
+            if (!closedThisRound(item.second)) {
+                lower = std::min(lower, (double)getDistFromStart(buffers, item.second) + (double)heuristic(item.second));
+            }
+        }
+        for (size_t idx : incons) {
+            lower = std::min(lower, (double)getDistFromStart(buffers, idx) + (double)heuristic(idx));
+        }
+        result.bound = (lower > 0.0) ? std::min(weight, (double)cost / lower) : 1.0;
+        result.rounds++;
+    };
+
+    if (!improvePath()) {
+        return result;
+    }
+    publish();
+
+    while (result.bound > 1.0 && std::chrono::steady_clock::now() < deadline) {
+        weight = std::max(1.0, weight - anytime_weight_step);
+        round++;
+
+        for (size_t idx : incons) {
+            open_list.push_back({ 0.0, idx });
+        }
+        incons.clear();
+        std::sort(open_list.begin(), open_list.end(), [](const pq_item& a, const pq_item& b) {
+            return a.second < b.second;
+        });
+        open_list.erase(std::unique(open_list.begin(), open_list.end(), [](const pq_item& a, const pq_item& b) {
+            return a.second == b.second;
+        }), open_list.end());
+        for (auto& item : open_list) {
+            item.first = key(item.second);
+        }
+        std::make_heap(open_list.begin(), open_list.end(), cmp);
+
+        if (!improvePath()) {
+            break;
+        }
+        publish();
+    }
+    return result;
+}
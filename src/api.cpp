@@ -45,6 +45,1035 @@ std::string ipToString(const sockaddr_in& addr)
     return std::string(ip_str);
 }
 
+/**
+ * @brief Response formats supported by the API (selected through the `Accept` header).
+ */
+enum class ResponseType { JSON, XML, UNKNOWN };
+
+/**
+ * @brief Request counters of the gateway, served by `GET /metrics`.
+ */
+struct api_metrics
+{
+    size_t requests = 0;        // every answered request
+    size_t routes = 0;          // point-to-point route queries
+    size_t timeouts = 0;        // queries cancelled by their deadline (503)
+    size_t not_found = 0;       // 404 responses
+    size_t bad_requests = 0;    // 400 responses
+    size_t updates = 0;         // applied weight update batches
+};
+
+/**
+ * @brief Reads a full HTTP request header from a client socket.
+ *
+ * @detailed
+ * A single `recv()` is enough for a point-to-point query, but batch endpoints
+ * (e.g. `/matrix`) can carry thousands of node IDs in the query string. This
+ * function keeps reading until the end of the header (`\r\n\r\n`) is received,
+ * the client closes the connection, or `max_size` bytes have been read.
+ *
+ * @param client_socket The connected client socket.
+ * @param max_size Maximum number of bytes accepted for one request.
+ * @return The raw request (empty on error or empty request).
+ */
+static std::string receiveRequest(SOCKET client_socket, size_t max_size = 1 << 20)
+{
+    std::string request;
+    char recv_buf[4096];
+
+    while (request.size() < max_size) {
+        int bytes_received = recv(client_socket, recv_buf, sizeof(recv_buf), 0);
+        if (bytes_received <= 0) {
+            break;
+        }
+        request.append(recv_buf, bytes_received);
+        if (request.find("\r\n\r\n") != std::string::npos) {
+            break;
+        }
+    }
+
+    return request;
+}
+
+/**
+ * @brief Extracts the value of a `key=value` parameter from a query string.
+ *
+ * The key must start the query or follow a `?` or `&`, so `start=` does not
+ * match inside another parameter name.
+ *
+ * @param query The query part of the request (after `GET /`).
+ * @param key The parameter name (without `=`).
+ * @param value Output value (up to the next `&`).
+ * @return `true` if the parameter is present.
+ */
+static bool getQueryParam(const std::string& query, const std::string& key, std::string& value)
+{
+    std::string pattern = key + "=";
+    size_t pos = query.find(pattern);
+    while (pos != std::string::npos) {
+        if (pos == 0 || query[pos - 1] == '?' || query[pos - 1] == '&') {
+            size_t val_start = pos + pattern.size();
+            size_t amp_pos = query.find('&', val_start);
+            value = query.substr(val_start, amp_pos == std::string::npos ? std::string::npos : amp_pos - val_start);
+            return true;
+        }
+        pos = query.find(pattern, pos + 1);
+    }
+    return false;
+}
+
+/**
+ * @brief Parses a comma-separated list of non-negative integers (e.g. `1,5,42`).
+ *
+ * @param value The raw parameter value (`%2C` is accepted as an encoded comma).
+ * @param out Output list of integers.
+ * @return `true` if every element is a valid non-negative integer and the list is not empty.
+ */
+static bool parseIntList(std::string value, std::vector<int>& out)
+{
+    size_t enc_pos;
+    while ((enc_pos = value.find("%2C")) != std::string::npos || (enc_pos = value.find("%2c")) != std::string::npos) {
+        value.replace(enc_pos, 3, ",");
+    }
+
+    out.clear();
+    size_t start = 0;
+    while (start <= value.size()) {
+        size_t comma_pos = value.find(',', start);
+        std::string item = value.substr(start, comma_pos == std::string::npos ? std::string::npos : comma_pos - start);
+        try {
+            size_t consumed = 0;
+            int parsed = std::stoi(item, &consumed);
+            if (consumed != item.size() || parsed < 0) {
+                return false;
+            }
+            out.push_back(parsed);
+        }
+        catch (...) {
+            return false;
+        }
+        if (comma_pos == std::string::npos) {
+            break;
+        }
+        start = comma_pos + 1;
+    }
+    return !out.empty();
+}
+
+/**
+ * @brief Determines the response format from the `Accept` header of a request.
+ *
+ * @param request The raw HTTP request.
+ * @param response_type Output response type (JSON when no header is present).
+ * @return `false` if the header requests an unsupported format.
+ */
+static bool parseAcceptHeader(const std::string& request, ResponseType& response_type)
+{
+    size_t accept_pos = request.find("Accept:");
+    if (accept_pos == std::string::npos) {
+        response_type = ResponseType::JSON;
+        return true;
+    }
+
+    size_t line_end = request.find("\r\n", accept_pos);
+    if (line_end == std::string::npos) {
+        line_end = request.find("\n", accept_pos);
+    }
+    std::string accept_line = request.substr(accept_pos, (line_end == std::string::npos ? line_end : line_end - accept_pos));
+    std::string accept_line_lower;
+    accept_line_lower.resize(accept_line.size());
+    std::transform(accept_line.begin(), accept_line.end(), accept_line_lower.begin(), ::tolower);
+
+    if (accept_line_lower.find("application/xml") != std::string::npos) {
+        response_type = ResponseType::XML;
+    }
+    else if (accept_line_lower.find("application/json") != std::string::npos) {
+        response_type = ResponseType::JSON;
+    }
+    else if (accept_line_lower.find("*/*") != std::string::npos) {
+        response_type = ResponseType::JSON;
+    }
+    else {
+        response_type = ResponseType::UNKNOWN;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Builds the HTTP status line text for a status code (e.g. `404 Not Found`).
+ */
+static std::string buildStatusLine(int status_code)
+{
+    std::string status_line = (status_code == 200) ? "200 OK" : std::to_string(status_code) + " ";
+
+    switch (status_code) {
+    case 200: status_line += "OK"; break;
+    case 400: status_line += "Bad Request"; break;
+    case 202: status_line += "Accepted"; break;
+    case 404: status_line += "Not Found"; break;
+    case 409: status_line += "Conflict"; break;
+    case 503: status_line += "Service Unavailable"; break;
+    default:  status_line += "Error"; break;
+    }
+    return status_line;
+}
+
+/**
+ * @brief Sends an HTTP response and closes the client socket.
+ */
+static void sendHttpResponse(SOCKET client_socket, int status_code, const std::string& content_type, const std::string& response_str)
+{
+    std::string header =
+        "HTTP/1.1 " + buildStatusLine(status_code) + "\r\n"
+        "Content-Type: " + content_type + "\r\n"
+        "Content-Length: " + std::to_string(response_str.size()) + "\r\n"
+        "Connection: close\r\n\r\n";
+
+    std::string full_response = header + response_str;
+    send(client_socket, full_response.c_str(), static_cast<int>(full_response.size()), 0);
+    closesocket(client_socket);
+}
+
+/**
+ * @brief Handles a `GET /matrix?sources=...&targets=...` request.
+ *
+ * @detailed
+ * Parses the source and target lists, computes the dense travel-time table with
+ * `computeDistanceMatrix()` (parallel over sources, one `search_buffers` per worker)
+ * and serializes it as JSON or XML. Unreachable or unknown pairs are reported as `-1`.
+ *
+ * Errors:
+ * - Missing/invalid lists → `400 INVALID PARAMS`.
+ * - More than `max_cells` cells → `400 MATRIX TOO LARGE`.
+ * - A worker cancelled by the query timeout (armed in every `pool` buffer) → `503 QUERY TIMEOUT`.
+ *
+ * @return The HTTP status code of the response.
+ */
+static int handleMatrixRequest(const std::string& query_part, const graph& gdata, std::vector<search_buffers>& pool, const numa_layout& numa, ResponseType response_type, std::chrono::high_resolution_clock::time_point start_time, std::string& content_type, std::string& response_str, std::string& summary)
+{
+    const size_t max_cells = 10000000;
+
+    std::vector<int> sources;
+    std::vector<int> targets;
+    std::string sources_val;
+    std::string targets_val;
+    int status_code = 200;
+    std::string message_response = "OK";
+
+    if (!getQueryParam(query_part, "sources", sources_val) || !parseIntList(sources_val, sources) ||
+        !getQueryParam(query_part, "targets", targets_val) || !parseIntList(targets_val, targets)) {
+        status_code = 400;
+        message_response = "INVALID PARAMS";
+    }
+    else if (sources.size() * targets.size() > max_cells) {
+        status_code = 400;
+        message_response = "MATRIX TOO LARGE";
+    }
+
+    std::vector<int> matrix;
+    if (status_code == 200) {
+        matrix = computeDistanceMatrix(gdata, pool, numa, sources, targets);
+        if (std::any_of(pool.begin(), pool.end(), [](const search_buffers& b) { return b.cancel.cancelled; })) {
+            status_code = 503;
+            message_response = "QUERY TIMEOUT";
+        }
+    }
+    summary = "matrix: " + std::to_string(matrix.size()) + " cells";
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+
+    auto writeList = [](std::stringstream& ss, const int* values, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            ss << values[i];
+            if (i + 1 < count) ss << ",";
+        }
+    };
+
+    std::stringstream ss;
+    if (response_type == ResponseType::XML) {
+        content_type = "application/xml";
+        ss << "<?xml version=\"1.0\"?>\n";
+        ss << "<response>\n";
+        ss << "  <status>\n";
+        ss << "    <message>" << message_response << "</message>\n";
+        ss << "    <code>" << status_code << "</code>\n";
+        ss << "  </status>\n";
+        ss << "  <response_time>" << elapsed_ms << "</response_time>\n";
+        ss << "  <req>\n";
+        ss << "    <sources>"; writeList(ss, sources.data(), sources.size()); ss << "</sources>\n";
+        ss << "    <targets>"; writeList(ss, targets.data(), targets.size()); ss << "</targets>\n";
+        ss << "  </req>\n";
+        ss << "  <res>\n";
+        ss << "    <matrix>\n";
+        if (status_code == 200) {
+            for (size_t i = 0; i < sources.size(); ++i) {
+                ss << "      <row>"; writeList(ss, matrix.data() + i * targets.size(), targets.size()); ss << "</row>\n";
+            }
+        }
+        ss << "    </matrix>\n";
+        ss << "  </res>\n";
+        ss << "</response>\n";
+    }
+    else {
+        content_type = "application/json";
+        ss << R"({"status":{"message":")" << message_response << R"(","code":)" << status_code
+            << R"(},"response_time":)" << elapsed_ms
+            << R"(,"req":{"sources":[)"; writeList(ss, sources.data(), sources.size());
+        ss << R"(],"targets":[)"; writeList(ss, targets.data(), targets.size());
+        ss << R"(]},"res":{"matrix":[)";
+        if (status_code == 200) {
+            for (size_t i = 0; i < sources.size(); ++i) {
+                ss << "["; writeList(ss, matrix.data() + i * targets.size(), targets.size()); ss << "]";
+                if (i + 1 < sources.size()) ss << ",";
+            }
+        }
+        ss << "]}}";
+    }
+    response_str = ss.str();
+    return status_code;
+}
+
+/**
+ * @brief Handles a `GET /isochrone?start=...&budget=...[&boundary=true]` request.
+ *
+ * @detailed
+ * Returns every node reachable from `start` within `budget` time units with its travel
+ * time (sorted by time), computed by `computeIsochrone()`. With `boundary=true`, only the
+ * nodes on the edge of the reachable area are returned.
+ *
+ * Errors:
+ * - Missing/invalid `start`, `budget` or `boundary` → `400 INVALID PARAMS`.
+ * - Unknown start node → `404 NO PATH FOUND`.
+ * - Search cancelled by the query timeout → `503 QUERY TIMEOUT`.
+ *
+ * @return The HTTP status code of the response.
+ */
+static int handleIsochroneRequest(const std::string& query_part, const graph& gdata, search_buffers& buffers, ResponseType response_type, std::chrono::high_resolution_clock::time_point start_time, std::string& content_type, std::string& response_str, std::string& summary)
+{
+    int status_code = 200;
+    std::string message_response = "OK";
+    int start_val = -1;
+    int budget = -1;
+    bool boundary_only = false;
+
+    std::string val;
+    try {
+        size_t consumed = 0;
+        if (!getQueryParam(query_part, "start", val) || (start_val = std::stoi(val, &consumed)) < 0 || consumed != val.size()) {
+            throw std::invalid_argument("invalid start");
+        }
+        if (!getQueryParam(query_part, "budget", val) || (budget = std::stoi(val, &consumed)) < 0 || consumed != val.size()) {
+            throw std::invalid_argument("invalid budget");
+        }
+        if (getQueryParam(query_part, "boundary", val)) {
+            if (val != "true" && val != "false") {
+                throw std::invalid_argument("invalid boundary");
+            }
+            boundary_only = (val == "true");
+        }
+    }
+    catch (...) {
+        status_code = 400;
+        message_response = "INVALID PARAMS";
+    }
+
+    std::vector<std::pair<int, int>> reached;
+    if (status_code == 200 && !computeIsochrone(gdata, buffers, start_val, budget, boundary_only, reached)) {
+        status_code = 404;
+        message_response = "NO PATH FOUND";
+    }
+    else if (status_code == 200 && buffers.cancel.cancelled) {
+        status_code = 503;
+        message_response = "QUERY TIMEOUT";
+    }
+    summary = "isochrone from " + std::to_string(start_val) + " within " + std::to_string(budget) + ": " + std::to_string(reached.size()) + " nodes";
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+
+    std::stringstream ss;
+    if (response_type == ResponseType::XML) {
+        content_type = "application/xml";
+        ss << "<?xml version=\"1.0\"?>\n";
+        ss << "<response>\n";
+        ss << "  <status>\n";
+        ss << "    <message>" << message_response << "</message>\n";
+        ss << "    <code>" << status_code << "</code>\n";
+        ss << "  </status>\n";
+        ss << "  <response_time>" << elapsed_ms << "</response_time>\n";
+        ss << "  <req>\n";
+        ss << "    <start>" << start_val << "</start>\n";
+        ss << "    <budget>" << budget << "</budget>\n";
+        ss << "    <boundary>" << (boundary_only ? "true" : "false") << "</boundary>\n";
+        ss << "  </req>\n";
+        ss << "  <res>\n";
+        ss << "    <total_node>" << reached.size() << "</total_node>\n";
+        ss << "    <nodes>\n";
+        for (const auto& [node, time] : reached) {
+            ss << "      <node id=\"" << node << "\" time=\"" << time << "\"/>\n";
+        }
+        ss << "    </nodes>\n";
+        ss << "  </res>\n";
+        ss << "</response>\n";
+    }
+    else {
+        content_type = "application/json";
+        ss << R"({"status":{"message":")" << message_response << R"(","code":)" << status_code
+            << R"(},"response_time":)" << elapsed_ms
+            << R"(,"req":{"start":)" << start_val
+            << R"(,"budget":)" << budget
+            << R"(,"boundary":)" << (boundary_only ? "true" : "false")
+            << R"(},"res":{"total_node":)" << reached.size()
+            << R"(,"nodes":[)";
+        for (size_t i = 0; i < reached.size(); ++i) {
+            ss << "[" << reached[i].first << "," << reached[i].second << "]";
+            if (i + 1 < reached.size()) ss << ",";
+        }
+        ss << "]}}";
+    }
+    response_str = ss.str();
+    return status_code;
+}
+
+/**
+ * @brief Handles a `GET /nearest?start=...&set=...&k=...` request.
+ *
+ * @detailed
+ * Returns the `k` members of the registered set `set` (see `loadPoiSets()`) that are
+ * the closest to `start` by travel time, computed by `findNearestTargets()`.
+ *
+ * Errors:
+ * - Missing/invalid `start`, `set` or `k` → `400 INVALID PARAMS`.
+ * - Unknown set → `400 UNKNOWN SET`.
+ * - Unknown start node → `404 NO PATH FOUND`.
+ * - Search cancelled by the query timeout → `503 QUERY TIMEOUT`.
+ *
+ * @return The HTTP status code of the response.
+ */
+static int handleNearestRequest(const std::string& query_part, const graph& gdata, search_buffers& buffers, const config& conf, ResponseType response_type, std::chrono::high_resolution_clock::time_point start_time, std::string& content_type, std::string& response_str, std::string& summary)
+{
+    int status_code = 200;
+    std::string message_response = "OK";
+    int start_val = -1;
+    int k = -1;
+    std::string set_name;
+
+    std::string val;
+    try {
+        size_t consumed = 0;
+        if (!getQueryParam(query_part, "start", val) || (start_val = std::stoi(val, &consumed)) < 0 || consumed != val.size()) {
+            throw std::invalid_argument("invalid start");
+        }
+        if (!getQueryParam(query_part, "k", val) || (k = std::stoi(val, &consumed)) <= 0 || consumed != val.size()) {
+            throw std::invalid_argument("invalid k");
+        }
+        if (!getQueryParam(query_part, "set", set_name) || set_name.empty()) {
+            throw std::invalid_argument("invalid set");
+        }
+    }
+    catch (...) {
+        status_code = 400;
+        message_response = "INVALID PARAMS";
+    }
+
+    if (status_code == 200 && gdata.poi_sets.find(set_name) == gdata.poi_sets.end()) {
+        status_code = 400;
+        message_response = "UNKNOWN SET";
+    }
+
+    std::vector<std::pair<int, int>> nearest;
+    if (status_code == 200 && !findNearestTargets(gdata, buffers, conf, start_val, set_name, k, nearest)) {
+        status_code = 404;
+        message_response = "NO PATH FOUND";
+    }
+    else if (status_code == 200 && buffers.cancel.cancelled) {
+        nearest.clear();
+        status_code = 503;
+        message_response = "QUERY TIMEOUT";
+    }
+    summary = "nearest " + std::to_string(k) + " of '" + set_name + "' from " + std::to_string(start_val);
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+
+    std::stringstream ss;
+    if (response_type == ResponseType::XML) {
+        content_type = "application/xml";
+        ss << "<?xml version=\"1.0\"?>\n";
+        ss << "<response>\n";
+        ss << "  <status>\n";
+        ss << "    <message>" << message_response << "</message>\n";
+        ss << "    <code>" << status_code << "</code>\n";
+        ss << "  </status>\n";
+        ss << "  <response_time>" << elapsed_ms << "</response_time>\n";
+        ss << "  <req>\n";
+        ss << "    <start>" << start_val << "</start>\n";
+        ss << "    <set>" << set_name << "</set>\n";
+        ss << "    <k>" << k << "</k>\n";
+        ss << "  </req>\n";
+        ss << "  <res>\n";
+        ss << "    <nodes>\n";
+        for (const auto& [node, time] : nearest) {
+            ss << "      <node id=\"" << node << "\" time=\"" << time << "\"/>\n";
+        }
+        ss << "    </nodes>\n";
+        ss << "  </res>\n";
+        ss << "</response>\n";
+    }
+    else {
+        content_type = "application/json";
+        ss << R"({"status":{"message":")" << message_response << R"(","code":)" << status_code
+            << R"(},"response_time":)" << elapsed_ms
+            << R"(,"req":{"start":)" << start_val
+            << R"(,"set":")" << set_name
+            << R"(","k":)" << k
+            << R"(},"res":{"nodes":[)";
+        for (size_t i = 0; i < nearest.size(); ++i) {
+            ss << "[" << nearest[i].first << "," << nearest[i].second << "]";
+            if (i + 1 < nearest.size()) ss << ",";
+        }
+        ss << "]}}";
+    }
+    response_str = ss.str();
+    return status_code;
+}
+
+/**
+ * @brief Handles a `GET /customize` request: reloads the travel times of the CCH engine.
+ *
+ * @detailed
+ * The CSV at `conf.map_path` is read again (same topology, new third column) and the CCH is
+ * customized on a background thread, so route queries keep being answered with the current
+ * metric. The new metric is published with `std::atomic_store` once it is complete; the
+ * gateway then clears the result cache before the next query.
+ *
+ * Only the CCH metric changes: point-to-point routes (`/`, `/batch`) use the new travel
+ * times, while the CSR weights read by `/matrix`, `/isochrone`, `/nearest`, `/alternatives`
+ * and the landmarks keep the loaded ones (use `/update` to change those). The response
+ * reports this scope (`applies_to`). A later `/update` customizes the CCH again from the
+ * CSR weights, which drops the reloaded travel times.
+ *
+ * Errors:
+ * - Engine other than CCH → `400 CCH ENGINE DISABLED`.
+ * - Graph loaded with `compress_chains` (the CSV lines of the chains have no CSR entry)
+ *   → `400 COMPRESSED GRAPH CANNOT BE CUSTOMIZED`.
+ * - Graph loaded with `prune_trees` (the CSV lines of the pruned trees have no CSR entry)
+ *   → `400 PRUNED GRAPH CANNOT BE CUSTOMIZED`.
+ * - A customization is still running → `409 CUSTOMIZATION RUNNING`.
+ *
+ * @return The HTTP status code of the response (`202` when the customization started).
+ */
+static int handleCustomizeRequest(const graph& gdata, const config& conf, const std::shared_ptr<std::atomic<bool>>& running, ResponseType response_type, std::string& content_type, std::string& response_str, std::string& summary)
+{
+    int status_code = 202;
+    std::string message_response = "CUSTOMIZATION STARTED";
+    if (conf.search_engine != 4) {
+        status_code = 400;
+        message_response = "CCH ENGINE DISABLED";
+    }
+    else if (gdata.trees.built) {
+        status_code = 400;
+        message_response = "PRUNED GRAPH CANNOT BE CUSTOMIZED";
+    }
+    else if (gdata.chains.built) {
+        status_code = 400;
+        message_response = "COMPRESSED GRAPH CANNOT BE CUSTOMIZED";
+    }
+    else if (running->exchange(true)) {
+        status_code = 409;
+        message_response = "CUSTOMIZATION RUNNING";
+    }
+    else {
+        std::thread([&gdata, &conf, running]() {
+            auto start = std::chrono::steady_clock::now();
+            std::vector<int> edge_weights;
+            if (readEdgeWeights(gdata, conf.map_path, edge_weights)) {
+                std::atomic_store(&gdata.cch.metric, customizeCch(gdata, edge_weights, conf.nb_threads));
+                auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+                console("success", "CCH customized with the new travel times in " + std::to_string(elapsed_ms) + " ms.");
+                logger("CCH customized with the new travel times in " + std::to_string(elapsed_ms) + " ms.");
+            }
+            else {
+                console("error", "customization skipped: the CSV is unreadable or its topology changed (restart required).");
+                logger("error: customization skipped: the CSV is unreadable or its topology changed.");
+            }
+            running->store(false);
+        }).detach();
+    }
+    summary = "customize";
+
+    std::stringstream ss;
+    if (response_type == ResponseType::XML) {
+        content_type = "application/xml";
+        ss << "<?xml version=\"1.0\"?>\n";
+        ss << "<response>\n";
+        ss << "  <status>\n";
+        ss << "    <message>" << message_response << "</message>\n";
+        ss << "    <code>" << status_code << "</code>\n";
+        ss << "  </status>\n";
+        if (status_code == 202) {
+            ss << "  <res>\n";
+            ss << "    <applies_to>routes</applies_to>\n";
+            ss << "  </res>\n";
+        }
+        ss << "</response>\n";
+    }
+    else {
+        content_type = "application/json";
+        ss << R"({"status":{"message":")" << message_response << R"(","code":)" << status_code << "}";
+        if (status_code == 202) {
+            ss << R"(,"res":{"applies_to":"routes"})";
+        }
+        ss << "}";
+    }
+    response_str = ss.str();
+    return status_code;
+}
+
+/**
+ * @brief Customizes the CCH again with the current (live updated) weights of the graph.
+ *
+ * @detailed
+ * The weights are copied on the calling thread (the gateway, which is the only writer), so
+ * the background customization never reads edges that an update is changing. The new
+ * metric is published with `std::atomic_store`, like a `/customize` reload.
+ *
+ * @param gdata Reference to the graph data.
+ * @param conf Configuration (`nb_threads`).
+ * @param running Customization flag, already set by the caller; cleared when done.
+ */
+static void startReweighting(const graph& gdata, const config& conf, const std::shared_ptr<std::atomic<bool>>& running)
+{
+    std::vector<int> edge_weights(gdata.edges.size());
+    for (size_t i = 0; i < gdata.edges.size(); ++i) {
+        edge_weights[i] = gdata.edges[i].weight;
+    }
+    uint64_t epoch = gdata.updates.epoch;
+    std::thread([&gdata, &conf, running, epoch, weights = std::move(edge_weights)]() {
+        auto start = std::chrono::steady_clock::now();
+        std::atomic_store(&gdata.cch.metric, customizeCch(gdata, weights, conf.nb_threads));
+        auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        console("success", "CCH customized for weight epoch " + std::to_string(epoch) + " in " + std::to_string(elapsed_ms) + " ms.");
+        logger("CCH customized for weight epoch " + std::to_string(epoch) + " in " + std::to_string(elapsed_ms) + " ms.");
+        running->store(false);
+    }).detach();
+}
+
+/**
+ * @brief Handles a `GET /update?edges=a:b:t,...&repair=true` request (live travel times).
+ *
+ * @detailed
+ * Each `a:b:t` item sets the travel time of every edge between nodes `a` and `b` to `t`
+ * (both directions) through `applyEdgeUpdates()`. The batch is applied between two requests
+ * on the gateway thread, so queries always run on one weight epoch; the result cache and
+ * the kept search trees are then dropped, and the NUMA replicas are copied again.
+ *
+ * - ALT: increases keep the landmarks valid; decreases raise the table slack (weaker but
+ *   admissible bounds) until `repair=true` runs `repairLandmarks()`.
+ * - CCH: the metric is customized again in the background from a copy of the new weights
+ *   (if a customization is already running, it is started again at the next request).
+ * - Core-ALT keeps its own copy of the core weights and cannot be updated.
+ *
+ * Errors:
+ * - Missing/invalid `edges` (unknown edge, weight below `1`) or `repair` → `400 INVALID PARAMS`.
+ * - Edge inside a tree removed by `prune_trees` → `400 PRUNED NODE CANNOT BE UPDATED`.
+ * - Core-ALT engine → `400 CORE-ALT ENGINE CANNOT BE UPDATED`.
+ *
+ * @return The HTTP status code of the response.
+ */
+static int handleUpdateRequest(const std::string& query_part, graph& gdata, search_buffers& buffers, std::vector<search_buffers>& pool, numa_layout& numa, route_cache& cache, const config& conf, const std::shared_ptr<std::atomic<bool>>& customizing, bool& reweight_pending, ResponseType response_type, std::string& content_type, std::string& response_str, std::string& summary)
+{
+    const size_t max_updates = 10000;
+    int status_code = 200;
+    std::string message_response = "OK";
+    bool repaired = false;
+
+    std::string edges_val;
+    std::string repair_val = "false";
+    std::vector<int> values;
+    getQueryParam(query_part, "repair", repair_val);
+    if (getQueryParam(query_part, "edges", edges_val)) {
+        size_t enc_pos;
+        while ((enc_pos = edges_val.find("%3A")) != std::string::npos || (enc_pos = edges_val.find("%3a")) != std::string::npos) {
+            edges_val.replace(enc_pos, 3, ":");
+        }
+        std::replace(edges_val.begin(), edges_val.end(), ':', ',');
+    }
+
+    std::vector<edge_update> batch;
+    if (!parseIntList(edges_val, values) || values.size() % 3 != 0 || values.size() / 3 > max_updates
+        || (repair_val != "true" && repair_val != "false")) {
+        status_code = 400;
+        message_response = "INVALID PARAMS";
+    }
+    else if (conf.search_engine == 3) {
+        status_code = 400;
+        message_response = "CORE-ALT ENGINE CANNOT BE UPDATED";
+    }
+    else {
+        for (size_t i = 0; i < values.size(); i += 3) {
+            batch.push_back({ values[i], values[i + 1], values[i + 2] });
+        }
+        auto pruned = [&](int node) { return gdata.trees.built && gdata.trees.position.count(node); };
+        if (std::any_of(batch.begin(), batch.end(), [&](const edge_update& upd) { return pruned(upd.from) || pruned(upd.to); })) {
+            status_code = 400;
+            message_response = "PRUNED NODE CANNOT BE UPDATED";
+        }
+        else if (!applyEdgeUpdates(gdata, batch)) {
+            status_code = 400;
+            message_response = "INVALID PARAMS";
+        }
+    }
+
+    if (status_code == 200) {
+        clearRouteCache(cache);
+        buffers.reuse_search_id = 0;
+        for (auto& worker_buffers : pool) {
+            worker_buffers.reuse_search_id = 0;
+        }
+        if (repair_val == "true") {
+            repaired = repairLandmarks(gdata, conf);
+        }
+        refreshNumaReplicas(gdata, numa);
+        if (conf.search_engine == 4) {
+            if (!customizing->exchange(true)) {
+                startReweighting(gdata, conf, customizing);
+            }
+            else {
+                reweight_pending = true;
+            }
+        }
+    }
+    summary = "update edges=" + std::to_string(batch.size());
+
+    const auto& state = gdata.updates;
+    std::stringstream ss;
+    if (response_type == ResponseType::XML) {
+        content_type = "application/xml";
+        ss << "<?xml version=\"1.0\"?>\n";
+        ss << "<response>\n";
+        ss << "  <status>\n";
+        ss << "    <message>" << message_response << "</message>\n";
+        ss << "    <code>" << status_code << "</code>\n";
+        ss << "  </status>\n";
+        if (status_code == 200) {
+            ss << "  <res>\n";
+            ss << "    <updated>" << batch.size() << "</updated>\n";
+            ss << "    <epoch>" << state.epoch << "</epoch>\n";
+            ss << "    <increases>" << state.increases << "</increases>\n";
+            ss << "    <decreases>" << state.decreases << "</decreases>\n";
+            ss << "    <alt_slack>" << gdata.dist_landmark.slack << "</alt_slack>\n";
+            ss << "    <repaired>" << (repaired ? "true" : "false") << "</repaired>\n";
+            ss << "  </res>\n";
+        }
+        ss << "</response>\n";
+    }
+    else {
+        content_type = "application/json";
+        ss << R"({"status":{"message":")" << message_response << R"(","code":)" << status_code << "}";
+        if (status_code == 200) {
+            ss << R"(,"res":{"updated":)" << batch.size()
+                << R"(,"epoch":)" << state.epoch
+                << R"(,"increases":)" << state.increases
+                << R"(,"decreases":)" << state.decreases
+                << R"(,"alt_slack":)" << gdata.dist_landmark.slack
+                << R"(,"repaired":)" << (repaired ? "true" : "false") << "}";
+        }
+        ss << "}";
+    }
+    response_str = ss.str();
+    return status_code;
+}
+
+/**
+ * @brief Handles a `GET /metrics` request (counters since the server started).
+ *
+ * @return The HTTP status code of the response.
+ */
+static int handleMetricsRequest(const api_metrics& metrics, ResponseType response_type, std::string& content_type, std::string& response_str, std::string& summary)
+{
+    summary = "metrics";
+    std::stringstream ss;
+    if (response_type == ResponseType::XML) {
+        content_type = "application/xml";
+        ss << "<?xml version=\"1.0\"?>\n";
+        ss << "<response>\n";
+        ss << "  <status>\n";
+        ss << "    <message>OK</message>\n";
+        ss << "    <code>200</code>\n";
+        ss << "  </status>\n";
+        ss << "  <res>\n";
+        ss << "    <requests>" << metrics.requests << "</requests>\n";
+        ss << "    <routes>" << metrics.routes << "</routes>\n";
+        ss << "    <timeouts>" << metrics.timeouts << "</timeouts>\n";
+        ss << "    <not_found>" << metrics.not_found << "</not_found>\n";
+        ss << "    <bad_requests>" << metrics.bad_requests << "</bad_requests>\n";
+        ss << "    <updates>" << metrics.updates << "</updates>\n";
+        ss << "  </res>\n";
+        ss << "</response>\n";
+    }
+    else {
+        content_type = "application/json";
+        ss << R"({"status":{"message":"OK","code":200},"res":{"requests":)" << metrics.requests
+            << R"(,"routes":)" << metrics.routes
+            << R"(,"timeouts":)" << metrics.timeouts
+            << R"(,"not_found":)" << metrics.not_found
+            << R"(,"bad_requests":)" << metrics.bad_requests
+            << R"(,"updates":)" << metrics.updates << "}}";
+    }
+    response_str = ss.str();
+    return 200;
+}
+
+/**
+ * @brief Handles a `GET /alternatives?start=...&end=...&k=...` request.
+ *
+ * @detailed
+ * Returns up to `k` (default `3`, at most `max_routes`) diverse itineraries between `start`
+ * and `end`, shortest first, computed by `findAlternativeRoutes()` from a single pair of
+ * searches. Alternatives are at most 25% longer than the shortest path, share at most 80%
+ * of their length with the previous routes and keep a plateau of at least 25% of it.
+ *
+ * Errors:
+ * - Missing/invalid `start`, `end` or `k` → `400 INVALID PARAMS`.
+ * - No path between the nodes → `404 NO PATH FOUND`.
+ * - Search cancelled by the query timeout → `503 QUERY TIMEOUT`.
+ *
+ * @return The HTTP status code of the response.
+ */
+static int handleAlternativesRequest(const std::string& query_part, const graph& gdata, search_buffers& buffers, ResponseType response_type, std::chrono::high_resolution_clock::time_point start_time, std::string& content_type, std::string& response_str, std::string& summary)
+{
+    const int max_routes = 10;
+    int status_code = 200;
+    std::string message_response = "OK";
+    int start_val = -1;
+    int end_val = -1;
+    int k = 3;
+
+    std::string val;
+    try {
+        size_t consumed = 0;
+        if (!getQueryParam(query_part, "start", val) || (start_val = std::stoi(val, &consumed)) < 0 || consumed != val.size()) {
+            throw std::invalid_argument("invalid start");
+        }
+        if (!getQueryParam(query_part, "end", val) || (end_val = std::stoi(val, &consumed)) < 0 || consumed != val.size()) {
+            throw std::invalid_argument("invalid end");
+        }
+        if (getQueryParam(query_part, "k", val) && ((k = std::stoi(val, &consumed)) <= 0 || k > max_routes || consumed != val.size())) {
+            throw std::invalid_argument("invalid k");
+        }
+    }
+    catch (...) {
+        status_code = 400;
+        message_response = "INVALID PARAMS";
+    }
+
+    std::vector<path_result> routes;
+    if (status_code == 200) {
+        routes = findAlternativeRoutes(gdata, buffers, start_val, end_val, k, 1.25, 0.8, 0.25);
+        if (buffers.cancel.cancelled) {
+            status_code = 503;
+            message_response = "QUERY TIMEOUT";
+        }
+        else if (routes.empty()) {
+            status_code = 404;
+            message_response = "NO PATH FOUND";
+        }
+    }
+    summary = "alternatives from " + std::to_string(start_val) + " to " + std::to_string(end_val) + " (" + std::to_string(routes.size()) + "/" + std::to_string(k) + " routes)";
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+
+    std::stringstream ss;
+    if (response_type == ResponseType::XML) {
+        content_type = "application/xml";
+        ss << "<?xml version=\"1.0\"?>\n";
+        ss << "<response>\n";
+        ss << "  <status>\n";
+        ss << "    <message>" << message_response << "</message>\n";
+        ss << "    <code>" << status_code << "</code>\n";
+        ss << "  </status>\n";
+        ss << "  <response_time>" << elapsed_ms << "</response_time>\n";
+        ss << "  <req>\n";
+        ss << "    <start>" << start_val << "</start>\n";
+        ss << "    <end>" << end_val << "</end>\n";
+        ss << "    <k>" << k << "</k>\n";
+        ss << "  </req>\n";
+        ss << "  <res>\n";
+        ss << "    <routes>\n";
+        for (const auto& route : routes) {
+            ss << "      <route>\n";
+            ss << "        <total_time>" << route.total_time << "</total_time>\n";
+            ss << "        <total_node>" << route.total_node << "</total_node>\n";
+            ss << "        <itinary>";
+            for (size_t i = 0; i < route.steps.size(); ++i) {
+                ss << route.steps[i];
+                if (i + 1 < route.steps.size()) ss << ",";
+            }
+            ss << "</itinary>\n";
+            ss << "      </route>\n";
+        }
+        ss << "    </routes>\n";
+        ss << "  </res>\n";
+        ss << "</response>\n";
+    }
+    else {
+        content_type = "application/json";
+        ss << R"({"status":{"message":")" << message_response << R"(","code":)" << status_code
+            << R"(},"response_time":)" << elapsed_ms
+            << R"(,"req":{"start":)" << start_val
+            << R"(,"end":)" << end_val
+            << R"(,"k":)" << k
+            << R"(},"res":{"routes":[)";
+        for (size_t r = 0; r < routes.size(); ++r) {
+            ss << R"({"total_time":)" << routes[r].total_time
+                << R"(,"total_node":)" << routes[r].total_node
+                << R"(,"itinary":[)";
+            for (size_t i = 0; i < routes[r].steps.size(); ++i) {
+                ss << routes[r].steps[i];
+                if (i + 1 < routes[r].steps.size()) ss << ",";
+            }
+            ss << "]}";
+            if (r + 1 < routes.size()) ss << ",";
+        }
+        ss << "]}}";
+    }
+    response_str = ss.str();
+    return status_code;
+}
+
+/**
+ * @brief Handles a `GET /batch?starts=...&ends=...[&distance_only=true]` request.
+ *
+ * @detailed
+ * `starts` and `ends` are two lists of the same length; query `i` goes from `starts[i]`
+ * to `ends[i]`. The batch is answered by `computeRouteBatch()`, which groups the queries
+ * by source so that consecutive queries from the same start reuse one search tree.
+ * Results are returned in request order; unreachable or unknown pairs get a
+ * `total_time` of `-1`.
+ *
+ * Errors:
+ * - Missing/invalid lists, lists of different sizes or invalid `distance_only` → `400 INVALID PARAMS`.
+ * - More than `max_queries` queries → `400 BATCH TOO LARGE`.
+ * - A worker cancelled by the query timeout (armed in every `pool` buffer) → `503 QUERY TIMEOUT`.
+ *
+ * @return The HTTP status code of the response.
+ */
+static int handleBatchRequest(const std::string& query_part, const graph& gdata, std::vector<search_buffers>& pool, const numa_layout& numa, route_cache& cache, const config& conf, ResponseType response_type, std::chrono::high_resolution_clock::time_point start_time, std::string& content_type, std::string& response_str, std::string& summary)
+{
+    const size_t max_queries = 50000;
+
+    std::vector<int> starts;
+    std::vector<int> ends;
+    std::string val;
+    bool distance_only = false;
+    int status_code = 200;
+    std::string message_response = "OK";
+
+    if (!getQueryParam(query_part, "starts", val) || !parseIntList(val, starts) ||
+        !getQueryParam(query_part, "ends", val) || !parseIntList(val, ends) ||
+        starts.size() != ends.size()) {
+        status_code = 400;
+        message_response = "INVALID PARAMS";
+    }
+    else if (getQueryParam(query_part, "distance_only", val) && val != "true" && val != "false") {
+        status_code = 400;
+        message_response = "INVALID PARAMS";
+    }
+    else if (starts.size() > max_queries) {
+        status_code = 400;
+        message_response = "BATCH TOO LARGE";
+    }
+    else {
+        distance_only = (val == "true");
+    }
+
+    std::vector<path_result> results;
+    if (status_code == 200) {
+        std::vector<std::pair<int, int>> queries(starts.size());
+        for (size_t i = 0; i < starts.size(); ++i) {
+            queries[i] = { starts[i], ends[i] };
+        }
+        results = computeRouteBatch(gdata, pool, numa, cache, conf, queries, distance_only);
+        if (std::any_of(pool.begin(), pool.end(), [](const search_buffers& b) { return b.cancel.cancelled; })) {
+            results.clear();
+            status_code = 503;
+            message_response = "QUERY TIMEOUT";
+        }
+    }
+    summary = "batch: " + std::to_string(results.size()) + " queries";
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+
+    std::stringstream ss;
+    if (response_type == ResponseType::XML) {
+        content_type = "application/xml";
+        ss << "<?xml version=\"1.0\"?>\n";
+        ss << "<response>\n";
+        ss << "  <status>\n";
+        ss << "    <message>" << message_response << "</message>\n";
+        ss << "    <code>" << status_code << "</code>\n";
+        ss << "  </status>\n";
+        ss << "  <response_time>" << elapsed_ms << "</response_time>\n";
+        ss << "  <req>\n";
+        ss << "    <count>" << starts.size() << "</count>\n";
+        ss << "    <distance_only>" << (distance_only ? "true" : "false") << "</distance_only>\n";
+        ss << "  </req>\n";
+        ss << "  <res>\n";
+        ss << "    <routes>\n";
+        for (size_t q = 0; q < results.size(); ++q) {
+            ss << "      <route>\n";
+            ss << "        <start>" << starts[q] << "</start>\n";
+            ss << "        <end>" << ends[q] << "</end>\n";
+            ss << "        <total_time>" << results[q].total_time << "</total_time>\n";
+            if (!distance_only) {
+                ss << "        <total_node>" << results[q].total_node << "</total_node>\n";
+                ss << "        <itinary>";
+                for (size_t i = 0; i < results[q].steps.size(); ++i) {
+                    ss << results[q].steps[i];
+                    if (i + 1 < results[q].steps.size()) ss << ",";
+                }
+                ss << "</itinary>\n";
+            }
+            ss << "      </route>\n";
+        }
+        ss << "    </routes>\n";
+        ss << "  </res>\n";
+        ss << "</response>\n";
+    }
+    else {
+        content_type = "application/json";
+        ss << R"({"status":{"message":")" << message_response << R"(","code":)" << status_code
+            << R"(},"response_time":)" << elapsed_ms
+            << R"(,"req":{"count":)" << starts.size()
+            << R"(,"distance_only":)" << (distance_only ? "true" : "false")
+            << R"(},"res":{"routes":[)";
+        for (size_t q = 0; q < results.size(); ++q) {
+            ss << R"({"start":)" << starts[q]
+                << R"(,"end":)" << ends[q]
+                << R"(,"total_time":)" << results[q].total_time;
+            if (!distance_only) {
+                ss << R"(,"total_node":)" << results[q].total_node
+                    << R"(,"itinary":[)";
+                for (size_t i = 0; i < results[q].steps.size(); ++i) {
+                    ss << results[q].steps[i];
+                    if (i + 1 < results[q].steps.size()) ss << ",";
+                }
+                ss << "]";
+            }
+            ss << "}";
+            if (q + 1 < results.size()) ss << ",";
+        }
+        ss << "]}}";
+    }
+    response_str = ss.str();
+    return status_code;
+}
+
 // ✅ function + comment verified.
 /**
  * @brief Starts an HTTP API server to process shortest path queries.
@@ -66,12 +1095,29 @@ std::string ipToString(const sockaddr_in& addr)
  *     - `start` (source node)
  *     - `end` (destination node)
  *     - `weight` (optional heuristic weight factor).
+ *     - `distance_only` (optional, `true` to skip the itinerary and only return `total_time`).
+ *     - `deadline_ms` (optional, anytime search returning the best path found in time).
+ *     - `timeout_ms` (optional, hard limit overriding `conf.query_timeout_ms`).
  *   - Parses request headers to determine response format (`JSON` or `XML`).
+ *   - Routes `GET /matrix?sources=...&targets=...` to the many-to-many handler.
+ *   - Routes `GET /isochrone?start=...&budget=...` to the range query handler.
+ *   - Routes `GET /nearest?start=...&set=...&k=...` to the nearest-target handler.
+ *   - Routes `GET /alternatives?start=...&end=...&k=...` to the alternative routes handler.
+ *   - Routes `GET /batch?starts=...&ends=...` to the batched point-to-point handler.
+ *   - Routes `GET /metrics` to the request counters.
+ *   - Routes `GET /customize` to the CCH travel time reload (background customization).
+ *   - Routes `GET /update?edges=a:b:t,...` to the live travel time updates.
+ *   - `/matrix`, `/isochrone`, `/nearest`, `/alternatives` and `/batch` are bounded by the same
+ *     query timeout (`timeout_ms` or `conf.query_timeout_ms`): the token is armed in `buffers`
+ *     and copied into every `pool` buffer, and an expired search answers `503 QUERY TIMEOUT`.
  *
  * - Step 3: Compute Shortest Path
- *   - Calls `findShortestPath()` using the extracted parameters.
+ *   - Answers from the result cache when the same query (in either direction) was seen recently.
+ *   - Otherwise calls `findShortestPath()` using the extracted parameters and caches the result
+ *     (through `routeThroughTrees()`, so nodes removed by tree pruning or chain compression stay routable).
  *   - If the path is found, constructs a valid JSON/XML response.
  *   - If the path does not exist, returns a `404 Not Found` error.
+ *   - If the search is cancelled by its timeout, returns `503 QUERY TIMEOUT` (not cached).
  *
  * - Step 4: Send HTTP Response
  *   - Constructs an HTTP response header.
@@ -91,6 +1137,10 @@ std::string ipToString(const sockaddr_in& addr)
  * - Unsupported Accept Headers → Returns `400 Bad Request`.
  *
  * @param gdata The graph data structure used for shortest path calculations.
+ * @param buffers The search buffers used by point-to-point queries.
+ * @param pool One set of search buffers per worker, used by batch queries.
+ * @param numa Placement of the workers and graph replicas (the API thread runs on the first node).
+ * @param cache Result cache checked before running a point-to-point search (single or batched).
  * @param conf The configuration settings for the API.
  * @return `0` on success, `1` on failure.
  *
@@ -106,8 +1156,12 @@ std::string ipToString(const sockaddr_in& addr)
  *   - Response Buffer: O(1)
  *   - Graph Memory Usage: O(V + E).
  */
-int launchApiGateway(const graph& gdata, search_buffers& buffers, const config& conf)
+int launchApiGateway(graph& gdata, search_buffers& buffers, std::vector<search_buffers>& pool, numa_layout& numa, route_cache& cache, const config& conf)
 {
+    if (numa.mode != 0) {
+        pinToNumaNode(numa, 0);
+    }
+
 #ifdef _WIN32
     WSADATA wsa_data;
     if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) {
@@ -153,6 +1207,11 @@ int launchApiGateway(const graph& gdata, search_buffers& buffers, const config&
         return 1;
     }
 
+    api_metrics metrics;
+    auto customizing = std::make_shared<std::atomic<bool>>(false);
+    bool reweight_pending = false;
+    const cch_metric* served_metric = std::atomic_load(&gdata.cch.metric).get();
+
     console("success", "server is listening on port 80. press any touch to close it.");
     logger("server is listening on port 80.");
 
@@ -172,32 +1231,130 @@ int launchApiGateway(const graph& gdata, search_buffers& buffers, const config&
             return 1;
         }
 
-        char recv_buf[2048];
-        memset(recv_buf, 0, sizeof(recv_buf));
-        int bytes_received = recv(client_socket, recv_buf, sizeof(recv_buf) - 1, 0);
+        std::string request = receiveRequest(client_socket);
 
         auto start_time = std::chrono::high_resolution_clock::now();
         bool success = true;
         int status_code = 200;
         double used_weight = conf.weight;
+        bool distance_only = false;
+        int deadline_ms = 0;
+        int timeout_ms = conf.query_timeout_ms;
         int start_val = -1;
         int end_val = -1;
         std::string message_response = "OK";
         std::string user_ip = ipToString(client_addr);
 
-        enum class ResponseType { JSON, XML, UNKNOWN };
         ResponseType response_type = ResponseType::JSON;
         bool accept_invalid = false;
 
-        if (bytes_received <= 0) {
+        if (request.empty()) {
             console("warning", "empty request or recv error.");
             logger("warning: empty request or recv error.");
             closesocket(client_socket);
             continue;
         }
 
-        std::string request(recv_buf, bytes_received);
+        if (reweight_pending && !customizing->exchange(true)) {
+            reweight_pending = false;
+            startReweighting(gdata, conf, customizing);
+        }
+
+        const cch_metric* current_metric = std::atomic_load(&gdata.cch.metric).get();
+        if (current_metric != served_metric) {
+            clearRouteCache(cache);
+            served_metric = current_metric;
+        }
+
         size_t pos_get = request.find("GET /");
+        if (pos_get != std::string::npos) {
+            size_t pos_http = request.find(" HTTP/1.1", pos_get);
+            std::string route = (pos_http == std::string::npos) ? "" : request.substr(pos_get + 5, pos_http - (pos_get + 5));
+            std::string query_part = route;
+            route = route.substr(0, route.find('?'));
+
+            if (route == "matrix" || route == "isochrone" || route == "nearest" || route == "alternatives" || route == "batch" || route == "metrics" || route == "customize" || route == "update") {
+                std::string content_type;
+                std::string response_str;
+                std::string summary;
+                bool bounded = (route == "matrix" || route == "isochrone" || route == "nearest" || route == "alternatives" || route == "batch");
+                std::string timeout_val;
+                if (bounded && getQueryParam(query_part, "timeout_ms", timeout_val)) {
+                    try {
+                        size_t consumed = 0;
+                        timeout_ms = std::stoi(timeout_val, &consumed);
+                        if (consumed != timeout_val.size() || timeout_ms < 0) {
+                            throw std::invalid_argument("invalid timeout");
+                        }
+                    }
+                    catch (...) {
+                        timeout_ms = -1;
+                    }
+                }
+                if (timeout_ms < 0) {
+                    status_code = 400;
+                    summary = route;
+                    content_type = "application/json";
+                    response_str = R"({"status":{"message":"INVALID PARAMS","code":400}})";
+                }
+                else if (parseAcceptHeader(request, response_type)) {
+                    if (bounded) {
+                        buffers.cancel.arm(timeout_ms);
+                        for (auto& worker_buffers : pool) {
+                            worker_buffers.cancel = buffers.cancel;
+                        }
+                    }
+                    if (route == "matrix") {
+                        status_code = handleMatrixRequest(query_part, gdata, pool, numa, response_type, start_time, content_type, response_str, summary);
+                    }
+                    else if (route == "isochrone") {
+                        status_code = handleIsochroneRequest(query_part, gdata, buffers, response_type, start_time, content_type, response_str, summary);
+                    }
+                    else if (route == "batch") {
+                        status_code = handleBatchRequest(query_part, gdata, pool, numa, cache, conf, response_type, start_time, content_type, response_str, summary);
+                    }
+                    else if (route == "customize") {
+                        status_code = handleCustomizeRequest(gdata, conf, customizing, response_type, content_type, response_str, summary);
+                    }
+                    else if (route == "update") {
+                        status_code = handleUpdateRequest(query_part, gdata, buffers, pool, numa, cache, conf, customizing, reweight_pending, response_type, content_type, response_str, summary);
+                        metrics.updates += (status_code == 200);
+                    }
+                    else if (route == "metrics") {
+                        status_code = handleMetricsRequest(metrics, response_type, content_type, response_str, summary);
+                    }
+                    else if (route == "alternatives") {
+                        status_code = handleAlternativesRequest(query_part, gdata, buffers, response_type, start_time, content_type, response_str, summary);
+                    }
+                    else {
+                        status_code = handleNearestRequest(query_part, gdata, buffers, conf, response_type, start_time, content_type, response_str, summary);
+                    }
+                }
+                else {
+                    status_code = 400;
+                    summary = route;
+                    content_type = "application/json";
+                    response_str = R"({"status":{"message":"INVALID ACCEPT HEADER","code":400}})";
+                }
+                buffers.cancel.disarm();
+                for (auto& worker_buffers : pool) {
+                    worker_buffers.cancel.disarm();
+                }
+                sendHttpResponse(client_socket, status_code, content_type, response_str);
+                metrics.requests++;
+                metrics.timeouts += (status_code == 503);
+                metrics.bad_requests += (status_code == 400);
+                metrics.not_found += (status_code == 404);
+
+                auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
+                success = (status_code == 200);
+                console("info", user_ip + " > " + summary + " > elapsed time: "
+                    + (elapsed_ms > 1000 ? RED : GREEN) + std::to_string(elapsed_ms) + RESET
+                    + " ms / success: " + (success ? GREEN : RED) + (success ? "true" : "false") + RESET + ".");
+                logger(user_ip + " > " + summary + " > elapsed time: " + std::to_string(elapsed_ms) + " ms / success: " + (success ? "true" : "false") + ".");
+                continue;
+            }
+        }
         if (pos_get == std::string::npos) {
             success = false;
             message_response = "INVALID REQUEST";
@@ -286,6 +1443,48 @@ int launchApiGateway(const graph& gdata, search_buffers& buffers, const config&
                         status_code = 400;
                     }
                 }
+                std::string flag_val;
+                if (getQueryParam(query_part, "distance_only", flag_val)) {
+                    if (flag_val != "true" && flag_val != "false") {
+                        success = false;
+                        message_response = "INVALID PARAMS";
+                        status_code = 400;
+                    }
+                    distance_only = (flag_val == "true");
+                }
+                if (getQueryParam(query_part, "deadline_ms", flag_val)) {
+                    try {
+                        size_t consumed = 0;
+                        deadline_ms = std::stoi(flag_val, &consumed);
+                        if (consumed != flag_val.size() || deadline_ms <= 0 || deadline_ms > 60000) {
+                            throw std::invalid_argument("invalid deadline");
+                        }
+                    }
+                    catch (...) {
+                        success = false;
+                        message_response = "INVALID PARAMS";
+                        status_code = 400;
+                    }
+                    if (success && !conf.use_alt) {
+                        success = false;
+                        message_response = "ANYTIME QUERIES REQUIRE ALT";
+                        status_code = 400;
+                    }
+                }
+                if (getQueryParam(query_part, "timeout_ms", flag_val)) {
+                    try {
+                        size_t consumed = 0;
+                        timeout_ms = std::stoi(flag_val, &consumed);
+                        if (consumed != flag_val.size() || timeout_ms < 0) {
+                            throw std::invalid_argument("invalid timeout");
+                        }
+                    }
+                    catch (...) {
+                        success = false;
+                        message_response = "INVALID PARAMS";
+                        status_code = 400;
+                    }
+                }
                 if (!start_ok || !end_ok) {
                     success = false;
                     message_response = "INVALID PARAMS";
@@ -300,47 +1499,66 @@ int launchApiGateway(const graph& gdata, search_buffers& buffers, const config&
         }
 
         if (success) {
-            size_t accept_pos = request.find("Accept:");
-            if (accept_pos == std::string::npos) {
-                response_type = ResponseType::JSON;
-            }
-            else {
-                size_t line_end = request.find("\r\n", accept_pos);
-                if (line_end == std::string::npos) {
-                    line_end = request.find("\n", accept_pos);
-                }
-                std::string accept_line = request.substr(accept_pos, (line_end == std::string::npos ? line_end : line_end - accept_pos));
-                std::string accept_line_lower;
-                accept_line_lower.resize(accept_line.size());
-                std::transform(accept_line.begin(), accept_line.end(), accept_line_lower.begin(), ::tolower);
-
-                if (accept_line_lower.find("application/xml") != std::string::npos) {
-                    response_type = ResponseType::XML;
-                }
-                else if (accept_line_lower.find("application/json") != std::string::npos) {
-                    response_type = ResponseType::JSON;
-                }
-                else if (accept_line_lower.find("*/*") != std::string::npos) {
-                    response_type = ResponseType::JSON;
-                }
-                else {
-                    success = false;
-                    accept_invalid = true;
-                    message_response = "INVALID ACCEPT HEADER";
-                    status_code = 400;
-                }
+            if (!parseAcceptHeader(request, response_type)) {
+                success = false;
+                accept_invalid = true;
+                message_response = "INVALID ACCEPT HEADER";
+                status_code = 400;
             }
         }
 
         path_result pres;
-        if (success) {
-            if(conf.search_engine == 1) {
-                pres = findShortestPathUnidirectional(gdata, buffers, conf, start_val, end_val, used_weight); 
+        anytime_result ares{ { -1, 0, {} }, 0.0, 0 };
+        bool cache_hit = false;
+        buffers.cancel.arm(timeout_ms);
+        if (success && deadline_ms > 0) {
+            // anytime results depend on the time budget, so they bypass the route cache.
+            // with chain compression, each exit pair gets the full deadline; the bound of a
+            // combination of anytime paths is the largest of their bounds.
+            ares.bound = 1.0;
+            pres = routeThroughTrees(gdata, start_val, end_val, distance_only, [&](int s, int t) {
+                anytime_result part = findShortestPathAnytime(gdata, buffers, conf, s, t, deadline_ms, distance_only);
+                ares.bound = std::max(ares.bound, part.bound);
+                ares.rounds = std::max(ares.rounds, part.rounds);
+                return part.path;
+            });
+            ares.path = pres;
+            if (buffers.cancel.cancelled) {
+                success = false;
+                message_response = "QUERY TIMEOUT";
+                status_code = 503;
             }
-            else {
-                pres = findShortestPathBidirectional(gdata, buffers, conf, start_val, end_val, used_weight);
+            else if (pres.total_time < 0) {
+                success = false;
+                message_response = "NO PATH FOUND";
+                status_code = 404;
+            }
+        }
+        else if (success) {
+            cache_hit = lookupRouteCache(cache, start_val, end_val, used_weight, conf.search_engine, distance_only, pres);
+            if (!cache_hit) {
+                pres = routeThroughTrees(gdata, start_val, end_val, distance_only, [&](int s, int t) {
+                    if (conf.search_engine == 1) {
+                        return findShortestPathUnidirectional(gdata, buffers, conf, s, t, used_weight, distance_only);
+                    }
+                    if (conf.search_engine == 3) {
+                        return findShortestPathCoreAlt(gdata, buffers, s, t, used_weight, distance_only);
+                    }
+                    if (conf.search_engine == 4) {
+                        return findShortestPathCch(gdata, buffers, s, t, distance_only);
+                    }
+                    return findShortestPathBidirectional(gdata, buffers, conf, s, t, used_weight, distance_only);
+                });
+                if (!buffers.cancel.cancelled) {
+                    storeRouteCache(cache, start_val, end_val, used_weight, conf.search_engine, pres);
+                }
             }
-            if (pres.total_time < 0) {
+            if (buffers.cancel.cancelled) {
+                success = false;
+                message_response = "QUERY TIMEOUT";
+                status_code = 503;
+            }
+            else if (pres.total_time < 0) {
                 success = false;
                 message_response = "NO PATH FOUND";
                 status_code = 404;
@@ -352,14 +1570,6 @@ int launchApiGateway(const graph& gdata, search_buffers& buffers, const config&
 
         std::string response_str;
         std::string content_type;
-        std::string status_line = (status_code == 200) ? "200 OK" : std::to_string(status_code) + " ";
-
-        switch (status_code) {
-        case 200: status_line += "OK"; break;
-        case 400: status_line += "Bad Request"; break;
-        case 404: status_line += "Not Found"; break;
-        default:  status_line += "Error"; break;
-        }
 
         if (accept_invalid) {
             content_type = "application/json";
@@ -381,9 +1591,20 @@ int launchApiGateway(const graph& gdata, search_buffers& buffers, const config&
             ss << "    <start>" << start_val << "</start>\n";
             ss << "    <end>" << end_val << "</end>\n";
             ss << "    <weight>" << used_weight << "</weight>\n";
+            ss << "    <distance_only>" << (distance_only ? "true" : "false") << "</distance_only>\n";
+            if (deadline_ms > 0) {
+                ss << "    <deadline_ms>" << deadline_ms << "</deadline_ms>\n";
+            }
             ss << "  </req>\n";
             ss << "  <res>\n";
-            if (success) {
+            if (success && deadline_ms > 0) {
+                ss << "    <bound>" << ares.bound << "</bound>\n";
+                ss << "    <rounds>" << ares.rounds << "</rounds>\n";
+            }
+            if (success && distance_only) {
+                ss << "    <total_time>" << pres.total_time << "</total_time>\n";
+            }
+            else if (success) {
                 ss << "    <total_time>" << pres.total_time << "</total_time>\n";
                 ss << "    <total_node>" << pres.total_node << "</total_node>\n";
                 ss << "    <itinary>";
@@ -410,9 +1631,19 @@ int launchApiGateway(const graph& gdata, search_buffers& buffers, const config&
                 << R"(,"req":{"start":)" << start_val
                 << R"(,"end":)" << end_val
                 << R"(,"weight":)" << used_weight
-                << R"(},"res":{)";
+                << R"(,"distance_only":)" << (distance_only ? "true" : "false");
+            if (deadline_ms > 0) {
+                ss << R"(,"deadline_ms":)" << deadline_ms;
+            }
+            ss << R"(},"res":{)";
+            if (success && deadline_ms > 0) {
+                ss << R"("bound":)" << ares.bound << R"(,"rounds":)" << ares.rounds << ",";
+            }
 
-            if (success) {
+            if (success && distance_only) {
+                ss << R"("total_time":)" << pres.total_time << "}}";
+            }
+            else if (success) {
                 ss << R"("total_time":)" << pres.total_time
                     << R"(,"total_node":)" << pres.total_node
                     << R"(,"itinary":[)";
@@ -428,15 +1659,13 @@ int launchApiGateway(const graph& gdata, search_buffers& buffers, const config&
             response_str = ss.str();
         }
 
-        std::string header =
-            "HTTP/1.1 " + status_line + "\r\n"
-            "Content-Type: " + content_type + "\r\n"
-            "Content-Length: " + std::to_string(response_str.size()) + "\r\n"
-            "Connection: close\r\n\r\n";
-
-        std::string full_response = header + response_str;
-        send(client_socket, full_response.c_str(), static_cast<int>(full_response.size()), 0);
-        closesocket(client_socket);
+        sendHttpResponse(client_socket, status_code, content_type, response_str);
+        buffers.cancel.disarm();
+        metrics.requests++;
+        metrics.routes += (pos_get != std::string::npos);
+        metrics.timeouts += (status_code == 503);
+        metrics.not_found += (status_code == 404);
+        metrics.bad_requests += (status_code == 400);
 
         if (pos_get != std::string::npos && (start_val != -1 || end_val != -1)) {
             std::string color_time = (elapsed_ms > 1000 ? RED : GREEN);
@@ -448,10 +1677,11 @@ int launchApiGateway(const graph& gdata, search_buffers& buffers, const config&
                 + " > elapsed time: "
                 + color_time + std::to_string(elapsed_ms) + RESET
                 + " ms / success: "
-                + color_success + (success ? "true" : "false") + RESET + ".";
+                + color_success + (success ? "true" : "false") + RESET
+                + (cache_hit ? " / cache: hit." : ".");
 
             console("info", log_message);
-            logger(user_ip + " > start node: " + std::to_string(start_val) + ", end node: " + std::to_string(end_val) + ", weight: " + std::to_string(used_weight) + " > elapsed time: " + std::to_string(elapsed_ms) + " ms / success: " + (success ? "true" : "false") + ".");
+            logger(user_ip + " > start node: " + std::to_string(start_val) + ", end node: " + std::to_string(end_val) + ", weight: " + std::to_string(used_weight) + " > elapsed time: " + std::to_string(elapsed_ms) + " ms / success: " + (success ? "true" : "false") + (cache_hit ? " / cache: hit." : "."));
         }
     }
 
@@ -0,0 +1,128 @@
+﻿#include "incl.h"
+#include "decl.h"
+#include "search.h"
+
+/**
+ * @brief Answers a batch of point-to-point queries, grouped by source.
+ *
+ * @detailed
+ * Batch clients often send many queries sharing a start node. Instead of answering
+ * them in arrival order, the queries are grouped by source and each group is answered
+ * by one worker with `findShortestPathUnidirectional(..., reuse_tree = true)`, so the
+ * forward search of the first query of a group is resumed by the next ones.
+ *
+ * Functionality:
+ * - Queries are stably sorted by source; inside a group, targets are ordered by their
+ *   ALT lower bound from the source, so the kept tree grows outwards and later targets
+ *   are often already settled.
+ * - Groups are distributed over the worker pool through an atomic counter; with NUMA
+ *   placement, each worker is pinned to its node and reads the local graph replica.
+ * - Every query first goes through the result cache, and fresh answers are stored in it.
+ * - Each worker honours the deadline armed in its own `search_buffers::cancel`: it is
+ *   polled by the searches and checked before each query. A worker that gives up sets its
+ *   `cancel.cancelled` and leaves its remaining results at "no path" (they are not cached).
+ * - Tree reuse only happens with ALT, `conf.weight = 1.0` and a full-precision landmark
+ *   table (consistent heuristic); otherwise each query simply runs its own search.
+ *
+ * @param gdata Reference to the graph data.
+ * @param pool Worker buffers, one per thread (must be initialized, with their `cancel` armed by the caller).
+ * @param numa Worker placement (see `setupNumaPlacement()`).
+ * @param cache Result cache shared with the point-to-point route.
+ * @param conf Configuration settings (heuristic and weight).
+ * @param queries List of `(start node, end node)` pairs.
+ * @param distance_only If `true`, only `total_time` is computed for each query.
+ * @return One `path_result` per query, in the order of `queries`.
+ *
+ * @complexity
+ * - Time Complexity: O(Q log Q) for the grouping, plus one (shared) A* search per group
+ *   in the best case and one per query in the worst case, divided by the number of workers.
+ * - Space Complexity: O(Q) plus the returned itineraries.
+ */
+std::vector<path_result> computeRouteBatch(const graph& gdata, std::vector<search_buffers>& pool, const numa_layout& numa, route_cache& cache, const config& conf, const std::vector<std::pair<int, int>>& queries, bool distance_only)
+{
+    const int engine = 1;
+    std::vector<path_result> results(queries.size(), path_result{ -1, 0, {} });
+    if (queries.empty() || pool.empty()) {
+        return results;
+    }
+
+    std::vector<int> lower_bound(queries.size(), 0);
+    if (conf.use_alt) {
+        for (size_t q = 0; q < queries.size(); ++q) {
+            auto it_start = gdata.node_to_index.find(queries[q].first);
+            auto it_end = gdata.node_to_index.find(queries[q].second);
+            if (it_start != gdata.node_to_index.end() && it_end != gdata.node_to_index.end()) {
+                lower_bound[q] = altHeuristicFunc(it_start->second, it_end->second, gdata);
+            }
+        }
+    }
+
+    std::vector<size_t> order(queries.size());
+    for (size_t q = 0; q < order.size(); ++q) {
+        order[q] = q;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (queries[a].first != queries[b].first) {
+            return queries[a].first < queries[b].first;
+        }
+        return lower_bound[a] < lower_bound[b];
+    });
+
+    std::vector<size_t> group_begin;
+    for (size_t k = 0; k < order.size(); ++k) {
+        if (k == 0 || queries[order[k]].first != queries[order[k - 1]].first) {
+            group_begin.push_back(k);
+        }
+    }
+    group_begin.push_back(order.size());
+    const size_t nb_groups = group_begin.size() - 1;
+
+    std::atomic<size_t> next_group(0);
+
+    auto workerFunc = [&](const graph& local, search_buffers& buffers) {
+        while (true) {
+            size_t g = next_group.fetch_add(1, std::memory_order_relaxed);
+            if (g >= nb_groups) {
+                break;
+            }
+            for (size_t k = group_begin[g]; k < group_begin[g + 1]; ++k) {
+                if (buffers.cancel.expired()) {
+                    buffers.cancel.cancelled = true;
+                }
+                if (buffers.cancel.cancelled) {
+                    return;
+                }
+                size_t q = order[k];
+                const auto& [start_node, end_node] = queries[q];
+                if (lookupRouteCache(cache, start_node, end_node, conf.weight, engine, distance_only, results[q])) {
+                    continue;
+                }
+                results[q] = routeThroughTrees(local, start_node, end_node, distance_only, [&](int s, int t) {
+                    return findShortestPathUnidirectional(local, buffers, conf, s, t, conf.weight, distance_only, true);
+                });
+                if (!buffers.cancel.cancelled) {
+                    storeRouteCache(cache, start_node, end_node, conf.weight, engine, results[q]);
+                }
+            }
+        }
+    };
+
+    size_t nb_workers = std::min(pool.size(), nb_groups);
+    if (nb_workers == 1) {
+        workerFunc(gdata, pool[0]);
+        return results;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(nb_workers);
+    for (size_t w = 0; w < nb_workers; ++w) {
+        workers.emplace_back([&, w]() {
+            workerFunc(enterNumaWorker(gdata, numa, w), pool[w]);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    return results;
+}
@@ -2,25 +2,166 @@
 #include "incl.h"
 #include "decl.h"
 
+/**
+ * @brief Marker written at the start of a versioned ALT data file.
+ *
+ * Files without it, or with another version, are stale: the landmarks are computed again.
+ */
+static const uint64_t alt_file_magic = 0x314C54414C504853ULL;   // "SHPLATL1"
+static const uint32_t alt_file_version = 3;
+static const size_t alt_file_alignment = 64;
+
+/**
+ * @brief Fixed header of a version 3 ALT data file.
+ *
+ * It is followed by `stride` scales (int32), `landmark_count` landmark node IDs (int32),
+ * zero padding up to `data_offset`, and the padded `node_count × stride` matrix exactly
+ * as `landmark_table` lays it out in memory.
+ */
+struct alt_file_header
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t element_width;     // 4 = int32 rows, 2 = compact uint16 rows
+    uint64_t fingerprint;       // graphFingerprint() of the graph the file was built for
+    uint64_t node_count;
+    uint64_t landmark_count;
+    uint64_t stride;
+    uint64_t data_offset;       // matrix start, a multiple of alt_file_alignment
+    uint64_t checksum;          // hashBytes() over scales, landmark IDs and matrix
+};
+static_assert(sizeof(alt_file_header) == 64, "alt_file_header must stay 64 bytes");
+
+/**
+ * @brief Hashes a byte range (64-bit, multiply-xorshift over four interleaved word lanes).
+ *
+ * @detailed
+ * Not cryptographic: it only has to catch truncated, corrupted or mismatched files.
+ * Four independent lanes keep the multiplier busy, so hashing runs at memory speed.
+ *
+ * @param data Start of the range.
+ * @param size Number of bytes.
+ * @param seed Previous hash, to chain several ranges.
+ * @return The 64-bit hash.
+ *
+ * @complexity
+ * - Time Complexity: O(size).
+ * - Space Complexity: O(1).
+ */
+static uint64_t hashBytes(const void* data, size_t size, uint64_t seed)
+{
+    const uint64_t prime = 0x9E3779B97F4A7C15ULL;
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t lane[4] = { seed, seed ^ 0x632BE59BD9B4E019ULL, seed + prime, seed - prime };
+
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int k = 0; k < 4; ++k) {
+            uint64_t word;
+            std::memcpy(&word, bytes + i + 8 * k, sizeof(word));
+            lane[k] = (lane[k] ^ word) * prime;
+            lane[k] ^= lane[k] >> 29;
+        }
+    }
+    uint64_t h = lane[0] ^ (lane[1] << 1) ^ (lane[2] << 2) ^ (lane[3] << 3) ^ (uint64_t)size;
+    for (; i < size; ++i) {
+        h = (h ^ bytes[i]) * prime;
+    }
+    h ^= h >> 32;
+    return h * prime;
+}
+
+/**
+ * @brief Identifies a graph by its node order and its CSR arrays.
+ *
+ * @detailed
+ * Landmark rows are indexed by node index, so an ALT file is only valid for the exact same
+ * node order, edges and weights. Any change to the map changes the fingerprint and the
+ * stale file is rejected on load.
+ *
+ * @complexity
+ * - Time Complexity: O(V + E).
+ * - Space Complexity: O(1).
+ */
+static uint64_t graphFingerprint(const graph& gdata)
+{
+    uint64_t h = hashBytes(gdata.index_to_node.data(), gdata.index_to_node.size() * sizeof(int), 0);
+    h = hashBytes(gdata.offsets.data(), gdata.index_to_node.size() * sizeof(size_t), h);   // sentinel excluded (= edges.size())
+    return hashBytes(gdata.edges.data(), gdata.edges.size() * sizeof(graph::edge_repr), h);
+}
+
+/**
+ * @brief Maps a whole file in memory (private, copy-on-write).
+ *
+ * @param path File to map.
+ * @param size Output file size in bytes.
+ * @return The mapping (unmapped when the last owner releases it), or `nullptr` on failure.
+ *
+ * @complexity
+ * - Time Complexity: O(1) (pages are loaded on first access).
+ * - Space Complexity: O(1) besides the address space.
+ */
+static std::shared_ptr<void> mapFile(const std::string& path, size_t& size)
+{
+    size = 0;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    LARGE_INTEGER file_size;
+    HANDLE mapping = GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0
+        ? CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL) : NULL;
+    CloseHandle(file);
+    if (mapping == NULL) {
+        return nullptr;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == NULL) {
+        return nullptr;
+    }
+    size = (size_t)file_size.QuadPart;
+    return std::shared_ptr<void>(view, [](void* p) { UnmapViewOfFile(p); });
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st;
+    void* view = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        view = mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (view == MAP_FAILED) {
+        return nullptr;
+    }
+    size = (size_t)st.st_size;
+    return std::shared_ptr<void>(view, [size](void* p) { munmap(p, size); });
+#endif
+}
+
 // ✅ function + comment verified.
 /**
  * @brief Saves precomputed ALT heuristic data to a binary file.
  *
  * @detailed
  * This function writes the ALT (A* Landmarks and Triangle Inequality) heuristic
- * data to a binary file for fast I/O.
+ * data as a single blob that `loadAltData` can map and use without copying.
  *
- * Data Stored:
- * - dist_landmark_to:
- *   - First writes the size of the outer vector (number of nodes).
- *   - For each element (node), writes the number of landmarks, then the array of `int` distances.
- *
- * - dist_landmark_from:
- *   - Same pattern as dist_landmark_to.
+ * Data Stored (version 3):
+ * - `alt_file_header` (64 bytes): magic, version, element width, graph fingerprint, node count,
+ *   landmark count, row stride, matrix offset and checksum.
+ * - Per-landmark scales (`stride` × int32, all `1` for the int32 layout).
+ * - Landmark node IDs (`landmarks` × int32), so more landmarks can be added later.
+ * - Zero padding up to the 64-byte aligned matrix offset.
+ * - The padded distance matrix (`nodes × stride`, int32 or uint16), written in one block.
  *
  * Steps of Execution:
- * 1. Open the output file in binary mode, truncating it if it exists.
- * 2. Write the data sizes and then the distance values in binary.
+ * 1. Compute the fingerprint of the graph and the checksum of the payload.
+ * 2. Write everything to `<file>.tmp`, then rename it over the target, so a crash never
+ *    leaves a half-written file and a mapped older file stays valid.
  * 3. Handle exceptions for file I/O operations.
  *
  * Edge Cases Handled:
@@ -28,8 +169,8 @@
  * - If an exception occurs during writing, log an error and return.
  *
  * Complexity:
- * - Time Complexity: O(V × nb_alt), where `V` is the number of nodes and `nb_alt` is the
- *   number of landmarks. Each distance is written once.
+ * - Time Complexity: O(V × nb_alt + E), where `V` is the number of nodes and `nb_alt` is the
+ *   number of landmarks (plus the graph fingerprint).
  * - Space Complexity: O(1). No additional memory besides small local variables is used.
  *
  * @param gdata Reference to the graph data structure containing precomputed ALT data.
@@ -41,8 +182,9 @@ void saveAltData(const graph& gdata, const config& conf)
     console("warning", "DO NOT CLOSE THE PROGRAM UNTIL THIS PROCESS IS FINISHED!");
     logger("starting to save ALT data to file " + conf.alt_prep_file);
 
+    const std::string tmp_file = conf.alt_prep_file + ".tmp";
     try {
-        std::ofstream ofs(conf.alt_prep_file, std::ios::binary | std::ios::out | std::ios::trunc);
+        std::ofstream ofs(tmp_file, std::ios::binary | std::ios::out | std::ios::trunc);
         if (!ofs.is_open()) {
             console("error", "unable to open file for writing ALT data:" + conf.alt_prep_file + ". skipping saving part.");
             logger("error: unable to open file for writing ALT data:" + conf.alt_prep_file + ". skipping saving part.");
@@ -50,21 +192,47 @@ void saveAltData(const graph& gdata, const config& conf)
         }
 
         {
-            uint64_t outer_size = static_cast<uint64_t>(gdata.dist_landmark.size());
-            ofs.write(reinterpret_cast<const char*>(&outer_size), sizeof(outer_size));
+            const auto& table = gdata.dist_landmark;
+            alt_file_header header{};
+            header.magic = alt_file_magic;
+            header.version = alt_file_version;
+            header.element_width = table.compact ? sizeof(uint16_t) : sizeof(int);
+            header.fingerprint = graphFingerprint(gdata);
+            header.node_count = table.nodeCount();
+            header.landmark_count = table.landmark_count;
+            header.stride = table.stride;
+
+            size_t meta_end = sizeof(header) + (table.stride + table.landmark_count) * sizeof(int);
+            header.data_offset = (meta_end + alt_file_alignment - 1) / alt_file_alignment * alt_file_alignment;
 
-            for (const auto& row : gdata.dist_landmark) {
-                uint64_t inner_size = static_cast<uint64_t>(row.size());
-                ofs.write(reinterpret_cast<const char*>(&inner_size), sizeof(inner_size));
-                ofs.write(reinterpret_cast<const char*>(row.data()), inner_size * sizeof(int));
+            const char* matrix = nullptr;
+            size_t matrix_bytes = header.node_count * header.stride * header.element_width;
+            if (matrix_bytes > 0) {
+                matrix = table.compact ? reinterpret_cast<const char*>(table.row16(0)) : reinterpret_cast<const char*>(table.row(0));
             }
+            header.checksum = hashBytes(table.scale.data(), table.stride * sizeof(int), 0);
+            header.checksum = hashBytes(table.landmark_nodes.data(), table.landmark_count * sizeof(int), header.checksum);
+            header.checksum = hashBytes(matrix, matrix_bytes, header.checksum);
+
+            std::vector<char> padding(header.data_offset - meta_end, 0);
+            ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            ofs.write(reinterpret_cast<const char*>(table.scale.data()), table.stride * sizeof(int));
+            ofs.write(reinterpret_cast<const char*>(table.landmark_nodes.data()), table.landmark_count * sizeof(int));
+            ofs.write(padding.data(), padding.size());
+            ofs.write(matrix, matrix_bytes);
         }
 
         ofs.close();
+        if (!ofs) {
+            throw std::runtime_error("write failed");
+        }
+        std::filesystem::rename(tmp_file, conf.alt_prep_file);
     }
     catch (const std::exception& e) {
         console("warning", "error while saving ALT data: " + std::string(e.what()));
         logger("error: cannot save ALT data: " + std::string(e.what()));
+        std::error_code ec;
+        std::filesystem::remove(tmp_file, ec);
         return;
     }
 
@@ -72,6 +240,73 @@ void saveAltData(const graph& gdata, const config& conf)
     logger("finished saving ALT data to file " + conf.alt_prep_file);
 }
 
+/**
+ * @brief Maps a version 3 ALT data file and points the landmark table at its matrix.
+ *
+ * @detailed
+ * The header is checked against the file size and the graph (fingerprint), then the
+ * checksum is verified; only the scales and landmark IDs are copied, the rows are used in
+ * place by the heuristic. Header sizes are bounded by the file size before they are
+ * multiplied, so a corrupted header cannot overflow the size check.
+ *
+ * @return `true` if the file is valid for this graph.
+ *
+ * @complexity
+ * - Time Complexity: O(V × nb_alt / B + E) for the checksum and fingerprint (`B` bytes per word).
+ * - Space Complexity: O(nb_alt) (the matrix stays in the page cache).
+ */
+static bool loadMappedAltFile(graph& gdata, const config& conf)
+{
+    size_t file_size = 0;
+    std::shared_ptr<void> mapping = mapFile(conf.alt_prep_file, file_size);
+    if (!mapping || file_size < sizeof(alt_file_header)) {
+        console("error", "unable to map ALT data file, processing landmarks again");
+        logger("error: unable to map ALT data file, processing landmarks again.");
+        return false;
+    }
+
+    const char* base = static_cast<const char*>(mapping.get());
+    alt_file_header header;
+    std::memcpy(&header, base, sizeof(header));
+
+    const uint64_t max_words = file_size / sizeof(int);
+    const bool sizes_fit = (header.element_width == sizeof(int) || header.element_width == sizeof(uint16_t))
+        && header.landmark_count <= max_words && header.stride <= max_words
+        && (header.stride == 0 || header.node_count <= file_size / (header.stride * header.element_width));
+    const uint64_t meta_end = sizes_fit ? sizeof(header) + (header.stride + header.landmark_count) * sizeof(int) : 0;
+    const bool valid = sizes_fit && header.version == alt_file_version
+        && header.stride == landmark_table::paddedStride(header.landmark_count)
+        && header.data_offset % alt_file_alignment == 0 && header.data_offset >= meta_end && header.data_offset <= file_size
+        && header.node_count * header.stride * header.element_width == file_size - header.data_offset;
+    if (!valid) {
+        console("error", "unsupported or truncated ALT data file, processing landmarks again");
+        logger("error: unsupported or truncated ALT data file, processing landmarks again.");
+        return false;
+    }
+    if (header.fingerprint != graphFingerprint(gdata)) {
+        console("error", "ALT data was built for a different graph, processing landmarks again");
+        logger("error: ALT data was built for a different graph, processing landmarks again.");
+        return false;
+    }
+
+    const char* scales = base + sizeof(header);
+    const char* ids = scales + header.stride * sizeof(int);
+    char* matrix = static_cast<char*>(mapping.get()) + header.data_offset;
+    uint64_t checksum = hashBytes(scales, header.stride * sizeof(int), 0);
+    checksum = hashBytes(ids, header.landmark_count * sizeof(int), checksum);
+    checksum = hashBytes(matrix, file_size - header.data_offset, checksum);
+    if (checksum != header.checksum) {
+        console("error", "ALT data checksum mismatch, processing landmarks again");
+        logger("error: ALT data checksum mismatch, processing landmarks again.");
+        return false;
+    }
+
+    auto& table = gdata.dist_landmark;
+    table.attachMapped(std::move(mapping), matrix, header.node_count, header.landmark_count, header.element_width == sizeof(uint16_t));
+    std::memcpy(table.scale.data(), scales, header.stride * sizeof(int));
+    std::memcpy(table.landmark_nodes.data(), ids, header.landmark_count * sizeof(int));
+    return true;
+}
 
 // ✅ function + comment verified.
 /**
@@ -79,27 +314,34 @@ void saveAltData(const graph& gdata, const config& conf)
  *
  * @detailed
  * This function reads the ALT (A* Landmarks and Triangle Inequality) heuristic
- * data from a binary file. The format must match the one used by `saveAltData`.
+ * data from a binary file.
+ *
+ * - Version 3 files (written by `saveAltData`) are memory-mapped: the table points at the
+ *   matrix inside the file, so loading costs no copy and no per-row read.
+ * - Any other file (older versions, unversioned layout) is stale and returns `false`, so
+ *   the landmarks are computed again and the file is rewritten in the current format.
  *
  * Data Loaded:
  * - dist_landmark:
- *   - Reads the number of nodes (outer size).
- *   - For each node, reads the number of landmarks, then reads `int` distances.
+ *   - The flat, padded `landmark_table` (int32 or compact uint16, as stored in the file).
  *
  * Steps of Execution:
  * 1. Open the input file in binary mode.
  * 2. Check if the file is empty (size == 0); if empty, return `false` to force preprocessing.
- * 3. Read the data in the same order it was written.
- * 4. Populate the graph structure’s ALT distance vectors.
+ * 3. Read the version marker and the version.
+ * 4. Map the graph structure’s ALT distance table.
  * 5. Handle exceptions for file I/O operations.
  *
  * Edge Cases Handled:
- * - If the file does not exist or is empty, returns `false` (indicating we need to recompute ALT data).
+ * - If the file does not exist, is empty or is not a version 3 file, returns `false` (indicating we need to recompute ALT data).
  * - If an exception occurs (e.g., incomplete or corrupted file), returns `false`.
+ * - If the file was built for a different graph (fingerprint or node count), or fails its
+ *   checksum, returns `false`.
+ *   Landmark count mismatches are resolved by `preprocessAlt`.
  *
  * Complexity:
- * - Time Complexity: O(V × nb_alt), reading each node’s landmark distances.
- * - Space Complexity: O(V × nb_alt), storing all loaded distances.
+ * - Time Complexity: O(V × nb_alt), checksumming each node’s landmark distances.
+ * - Space Complexity: O(nb_alt), the distances stay shared with the page cache.
  *
  * @param gdata Reference to the graph data structure to be populated.
  * @param conf Reference to configuration settings containing the input file path.
@@ -125,44 +367,40 @@ bool loadAltData(graph& gdata, config& conf)
     ifs.seekg(0, std::ios::beg);
 
     try {
-        {
-            uint64_t outer_size = 0;
-            ifs.read(reinterpret_cast<char*>(&outer_size), sizeof(outer_size));
-            if (!ifs.good()) {
-                console("error", "failed to read the size of dist_landmark, processing landmarks again");
-                logger("error: failed to read the size of dist_landmark, processing landmarks again.");
-                return false;
-            }
+        auto& table = gdata.dist_landmark;
+        table.clear();
 
-            gdata.dist_landmark.resize(static_cast<size_t>(outer_size));
-            for (size_t i = 0; i < outer_size; ++i) {
-                uint64_t inner_size = 0;
-                ifs.read(reinterpret_cast<char*>(&inner_size), sizeof(inner_size));
-                if (!ifs.good()) {
-                    console("error", "failed to read the size of a dist_landmark row, processing landmarks again");
-                    logger("error: failed to read the size of a dist_landmark row, processing landmarks again.");
-                    return false;
-                }
-
-                gdata.dist_landmark[i].resize(static_cast<size_t>(inner_size));
-                ifs.read(reinterpret_cast<char*>(gdata.dist_landmark[i].data()),
-                         static_cast<std::streamsize>(inner_size * sizeof(int)));
-                if (!ifs.good()) {
-                    console("error", "failed to read dist_landmark row data, processing landmarks again");
-                    logger("error: failed to read dist_landmark row data, processing landmarks again.");
-                    return false;
-                }
-            }
+        uint64_t magic = 0;
+        uint32_t version = 0;
+        ifs.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+        ifs.read(reinterpret_cast<char*>(&version), sizeof(version));
+        if (!ifs.good() || magic != alt_file_magic || version != alt_file_version) {
+            console("info", "ALT data file uses an older format, processing landmarks again");
+            logger("ALT data file uses an older format, processing landmarks again.");
+            return false;
         }
-
         ifs.close();
-        console("success", "ALT data loaded successfully from " + conf.alt_prep_file);
-        logger("ALT data loaded successfully from " + conf.alt_prep_file);
+
+        if (!loadMappedAltFile(gdata, conf)) {
+            table.clear();
+            return false;
+        }
+        if (table.nodeCount() != gdata.index_to_node.size()) {
+            console("error", "ALT data was built for " + std::to_string(table.nodeCount()) + " nodes but the graph has " + std::to_string(gdata.index_to_node.size()) + ", processing landmarks again");
+            logger("error: ALT data was built for " + std::to_string(table.nodeCount()) + " nodes but the graph has " + std::to_string(gdata.index_to_node.size()) + ", processing landmarks again.");
+            table.clear();
+            return false;
+        }
+
+        std::string details = std::string(table.compact ? " (compact 16-bit" : " (int32") + ", mapped)";
+        console("success", "ALT data loaded successfully from " + conf.alt_prep_file + details);
+        logger("ALT data loaded successfully from " + conf.alt_prep_file + details);
         return true;
     }
     catch (const std::exception& e) {
         console("warning", "failed to parse ALT data: " + std::string(e.what()));
         logger("error: failed to parse ALT data: " + std::string(e.what()));
+        gdata.dist_landmark.clear();
         return false;
     }
 }
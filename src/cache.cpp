@@ -0,0 +1,227 @@
+﻿#include "incl.h"
+#include "decl.h"
+
+/**
+ * @brief Builds the normalised cache key of a query.
+ *
+ * @detailed
+ * The graph is undirected, so `(start, end)` and `(end, start)` share the same entry:
+ * the smallest node ID always comes first and `reversed` tells whether the stored
+ * itinerary must be flipped for this query. The weight is stored with 2 decimals,
+ * which is the precision accepted by the API.
+ *
+ * @complexity
+ * - Time Complexity: O(1).
+ * - Space Complexity: O(1).
+ */
+static route_cache::key makeCacheKey(int start_node, int end_node, double weight, int engine, bool& reversed)
+{
+    reversed = start_node > end_node;
+    return { std::min(start_node, end_node), std::max(start_node, end_node), (int)std::lround(weight * 100.0), engine };
+}
+
+/**
+ * @brief Estimates the memory used by one cache entry (list node, index slot and itinerary).
+ *
+ * @complexity
+ * - Time Complexity: O(1).
+ * - Space Complexity: O(1).
+ */
+static size_t cacheEntryBytes(const route_cache::entry& e)
+{
+    return sizeof(route_cache::entry) + e.steps.capacity() * sizeof(int) + 64;
+}
+
+/**
+ * @brief Writes the hit/miss counters of the cache to the log every 1000 lookups.
+ *
+ * @complexity
+ * - Time Complexity: O(1).
+ * - Space Complexity: O(1).
+ */
+static void logCacheStats(const route_cache& cache)
+{
+    unsigned long long hits = cache.hits.load(std::memory_order_relaxed);
+    unsigned long long misses = cache.misses.load(std::memory_order_relaxed);
+    unsigned long long total = hits + misses;
+    if (total == 0 || total % 1000 != 0) {
+        return;
+    }
+    logger("result cache: " + std::to_string(hits) + " hits / " + std::to_string(misses) + " misses (" + std::to_string(hits * 100 / total) + "% hit rate).");
+}
+
+/**
+ * @brief Initializes (or resets) the result cache with a memory budget.
+ *
+ * @detailed
+ * The budget is split evenly between the shards; each shard evicts its least recently
+ * used entries when it goes over its share. A size of `0` disables the cache (lookups
+ * always miss and nothing is stored).
+ *
+ * @param cache Reference to the cache.
+ * @param size_mb Memory budget in megabytes.
+ *
+ * @complexity
+ * - Time Complexity: O(C) to drop the `C` previous entries.
+ * - Space Complexity: O(1).
+ */
+void initializeRouteCache(route_cache& cache, int size_mb)
+{
+    for (auto& s : cache.shards) {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.lru.clear();
+        s.index.clear();
+        s.bytes = 0;
+    }
+    cache.shard_budget = (size_mb > 0) ? ((size_t)size_mb << 20) / route_cache::shard_count : 0;
+    cache.hits = 0;
+    cache.misses = 0;
+
+    if (cache.shard_budget == 0) {
+        console("info", "result cache disabled.");
+        logger("result cache disabled.");
+    }
+    else {
+        console("success", "result cache initialized (" + std::to_string(size_mb) + " MB, " + std::to_string(route_cache::shard_count) + " shards).");
+        logger("result cache initialized: " + std::to_string(size_mb) + " MB, " + std::to_string(route_cache::shard_count) + " shards.");
+    }
+}
+
+/**
+ * @brief Looks up a previously computed answer.
+ *
+ * @detailed
+ * Functionality:
+ * - Only the shard owning the key is locked, so concurrent lookups rarely contend.
+ * - On a hit, the entry becomes the most recently used one of its shard.
+ * - Entries stored by distance-only queries only answer distance-only queries.
+ * - Itineraries are returned in the direction of the query (reversed if needed).
+ *
+ * @param cache Reference to the cache.
+ * @param start_node The starting node.
+ * @param end_node The target node.
+ * @param weight Heuristic weight of the query.
+ * @param engine Search engine used to answer the query.
+ * @param distance_only Whether the caller only needs `total_time`.
+ * @param result Output result (only written on a hit).
+ * @return `true` on a hit.
+ *
+ * @complexity
+ * - Time Complexity: O(1) on average, plus O(P) to copy an itinerary of `P` nodes.
+ * - Space Complexity: O(P).
+ */
+bool lookupRouteCache(route_cache& cache, int start_node, int end_node, double weight, int engine, bool distance_only, path_result& result)
+{
+    if (cache.shard_budget == 0) {
+        return false;
+    }
+
+    bool reversed = false;
+    route_cache::key k = makeCacheKey(start_node, end_node, weight, engine, reversed);
+    auto& s = cache.shards[route_cache::key_hash{}(k) % route_cache::shard_count];
+
+    bool hit = false;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto it = s.index.find(k);
+        if (it != s.index.end() && (it->second->has_path || distance_only)) {
+            s.lru.splice(s.lru.begin(), s.lru, it->second);
+            const auto& e = *it->second;
+            result.total_time = e.total_time;
+            if (distance_only) {
+                result.total_node = 0;
+                result.steps.clear();
+            }
+            else {
+                result.steps = e.steps;
+                if (reversed) {
+                    std::reverse(result.steps.begin(), result.steps.end());
+                }
+                result.total_node = (int)result.steps.size();
+            }
+            hit = true;
+        }
+    }
+
+    (hit ? cache.hits : cache.misses).fetch_add(1, std::memory_order_relaxed);
+    logCacheStats(cache);
+    return hit;
+}
+
+/**
+ * @brief Stores a freshly computed answer.
+ *
+ * @detailed
+ * Functionality:
+ * - Failed queries (`total_time < 0`) are not stored.
+ * - An existing entry is only replaced if it lacks the itinerary that the new result has.
+ * - Least recently used entries are evicted until the shard fits its budget again;
+ *   an answer larger than a whole shard is not stored.
+ *
+ * @param cache Reference to the cache.
+ * @param start_node The starting node.
+ * @param end_node The target node.
+ * @param weight Heuristic weight of the query.
+ * @param engine Search engine used to answer the query.
+ * @param result Result returned by the engine (empty `steps` for distance-only queries).
+ *
+ * @complexity
+ * - Time Complexity: O(P) to copy the itinerary, plus O(1) amortized per evicted entry.
+ * - Space Complexity: O(P).
+ */
+void storeRouteCache(route_cache& cache, int start_node, int end_node, double weight, int engine, const path_result& result)
+{
+    if (cache.shard_budget == 0 || result.total_time < 0) {
+        return;
+    }
+
+    bool reversed = false;
+    route_cache::key k = makeCacheKey(start_node, end_node, weight, engine, reversed);
+    auto& s = cache.shards[route_cache::key_hash{}(k) % route_cache::shard_count];
+
+    route_cache::entry e{ k, result.total_time, !result.steps.empty() || start_node == end_node, result.steps };
+    if (reversed) {
+        std::reverse(e.steps.begin(), e.steps.end());
+    }
+    size_t bytes = cacheEntryBytes(e);
+    if (bytes > cache.shard_budget) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto it = s.index.find(k);
+    if (it != s.index.end()) {
+        if (it->second->has_path || !e.has_path) {
+            s.lru.splice(s.lru.begin(), s.lru, it->second);
+            return;
+        }
+        s.bytes -= cacheEntryBytes(*it->second);
+        s.lru.erase(it->second);
+        s.index.erase(it);
+    }
+
+    s.lru.push_front(std::move(e));
+    s.index[k] = s.lru.begin();
+    s.bytes += bytes;
+
+    while (s.bytes > cache.shard_budget && !s.lru.empty()) {
+        auto& last = s.lru.back();
+        s.bytes -= cacheEntryBytes(last);
+        s.index.erase(last.k);
+        s.lru.pop_back();
+    }
+}
+
+/**
+ * @brief Drops every cached answer (e.g. after the travel times changed), keeping the budget.
+ */
+void clearRouteCache(route_cache& cache)
+{
+    for (auto& s : cache.shards) {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.lru.clear();
+        s.index.clear();
+        s.bytes = 0;
+    }
+    logger("result cache cleared.");
+}
@@ -0,0 +1,571 @@
+﻿#include "incl.h"
+#include "decl.h"
+#include "search.h"
+
+namespace {
+    const int cch_inf = std::numeric_limits<int>::max() / 2;
+    const size_t cch_leaf_size = 32;            // cells at most this large are not split again
+    const size_t cch_parallel_level = 256;      // smaller levels are customized on one thread
+
+    /**
+     * @brief Computes a metric-independent elimination order by nested dissection.
+     *
+     * @detailed
+     * The graph has no coordinates, so each cell is split with BFS levels: a BFS from a
+     * peripheral node (the last node of a first BFS) orders the cell, the level holding
+     * the median node is the cut, and its nodes adjacent to the next level form the
+     * separator. Separators are eliminated after both halves; disconnected cells are split
+     * into components without a separator.
+     *
+     * @return The elimination order (first = least important node).
+     */
+    std::vector<int> nestedDissectionOrder(const graph& gdata)
+    {
+        const size_t n = gdata.index_to_node.size();
+        std::vector<int> cell_of(n, 0);
+        std::vector<int> level(n, -1);
+        std::vector<int> queue;
+        std::vector<int> reversed;
+        reversed.reserve(n);
+
+        auto edgeEnd = [&](size_t v) {
+            return gdata.offsets[v + 1];
+        };
+        auto bfs = [&](int source, int cell) {
+            queue.clear();
+            queue.push_back(source);
+            level[source] = 0;
+            for (size_t head = 0; head < queue.size(); ++head) {
+                int v = queue[head];
+                for (size_t i = gdata.offsets[v]; i < edgeEnd(v); ++i) {
+                    int w = gdata.edges[i].target;
+                    if (cell_of[w] == cell && level[w] < 0) {
+                        level[w] = level[v] + 1;
+                        queue.push_back(w);
+                    }
+                }
+            }
+            return queue.back();
+        };
+
+        std::vector<std::vector<int>> cells(1, std::vector<int>(n));
+        std::iota(cells[0].begin(), cells[0].end(), 0);
+        int next_cell = 1;
+
+        while (!cells.empty()) {
+            std::vector<int> cell = std::move(cells.back());
+            cells.pop_back();
+            if (cell.size() <= cch_leaf_size) {
+                reversed.insert(reversed.end(), cell.begin(), cell.end());
+                continue;
+            }
+
+            const int id = next_cell++;
+            for (int v : cell) {
+                cell_of[v] = id;
+                level[v] = -1;
+            }
+            int far_node = bfs(cell[0], id);
+            if (queue.size() < cell.size()) {
+                std::vector<int> rest;
+                for (int v : cell) {
+                    if (level[v] < 0) {
+                        rest.push_back(v);
+                    }
+                }
+                cells.push_back(std::move(rest));
+                cells.emplace_back(queue.begin(), queue.end());
+                continue;
+            }
+
+            for (int v : cell) {
+                level[v] = -1;
+            }
+            bfs(far_node, id);
+            const int max_level = level[queue.back()];
+            std::vector<size_t> per_level((size_t)max_level + 1, 0);
+            for (int v : cell) {
+                per_level[level[v]]++;
+            }
+            int cut = -1;
+            size_t acc = 0;
+            for (int l = 0; l < max_level; ++l) {
+                acc += per_level[l];
+                if (acc * 3 >= cell.size() && acc * 3 <= 2 * cell.size()
+                    && (cut < 0 || per_level[l] < per_level[cut])) {
+                    cut = l;
+                }
+            }
+            if (cut < 0) {
+                for (acc = 0, cut = 0; cut < max_level - 1 && (acc += per_level[cut]) * 2 < cell.size(); ++cut) {}
+            }
+
+            std::vector<int> side_a, side_b;
+            for (int v : cell) {
+                if (level[v] > cut) {
+                    side_b.push_back(v);
+                    continue;
+                }
+                bool on_separator = false;
+                if (level[v] == cut) {
+                    for (size_t i = gdata.offsets[v]; i < edgeEnd(v) && !on_separator; ++i) {
+                        int w = gdata.edges[i].target;
+                        on_separator = (cell_of[w] == id && level[w] == cut + 1);
+                    }
+                }
+                if (on_separator) {
+                    reversed.push_back(v);
+                }
+                else {
+                    side_a.push_back(v);
+                }
+            }
+            if (!side_a.empty()) {
+                cells.push_back(std::move(side_a));
+            }
+            cells.push_back(std::move(side_b));
+        }
+
+        std::reverse(reversed.begin(), reversed.end());
+        return reversed;
+    }
+
+    /**
+     * @brief Returns the id of the arc `u -> v` (`v` ranked above `u`), or `npos` if absent.
+     */
+    size_t findArc(const customizable_hierarchy& cch, int u, int v)
+    {
+        auto first = cch.up_targets.begin() + cch.up_offsets[u];
+        auto last = cch.up_targets.begin() + cch.up_offsets[u + 1];
+        auto it = std::lower_bound(first, last, v, [&](int a, int b) {
+            return cch.rank[a] < cch.rank[b];
+        });
+        return (it != last && *it == v) ? (size_t)(it - cch.up_targets.begin()) : std::string::npos;
+    }
+
+    /**
+     * @brief Appends the original nodes of the arc `from -> to` (without `from`) to `out`.
+     *
+     * @detailed
+     * An arc whose weight differs from its input weight was improved through a lower triangle
+     * `{u, from, to}`; that triangle is found again among the lower neighbours of the lower
+     * endpoint and both halves are unpacked (explicit stack).
+     */
+    void appendUnpackedArc(const customizable_hierarchy& cch, const cch_metric& metric, int from, int to, size_t arc, std::vector<int>& out)
+    {
+        struct pending { int from, to; size_t arc; };
+        std::vector<pending> stack{ { from, to, arc } };
+
+        while (!stack.empty()) {
+            pending cur = stack.back();
+            stack.pop_back();
+            const int w = metric.weight[cur.arc];
+            if (w == metric.input[cur.arc]) {
+                out.push_back(cur.to);
+                continue;
+            }
+
+            const bool from_lower = cch.rank[cur.from] < cch.rank[cur.to];
+            const int lower = from_lower ? cur.from : cur.to;
+            const int higher = from_lower ? cur.to : cur.from;
+            bool found = false;
+            for (size_t k = cch.down_offsets[lower]; k < cch.down_offsets[lower + 1] && !found; ++k) {
+                auto [u, arc_lower] = cch.down_arcs[k];
+                size_t arc_higher = findArc(cch, u, higher);
+                if (arc_higher == std::string::npos || metric.weight[arc_lower] >= cch_inf || metric.weight[arc_higher] >= cch_inf
+                    || metric.weight[arc_lower] + metric.weight[arc_higher] != w) {
+                    continue;
+                }
+                stack.push_back({ u, cur.to, from_lower ? arc_higher : arc_lower });
+                stack.push_back({ cur.from, u, from_lower ? arc_lower : arc_higher });
+                found = true;
+            }
+            if (!found) {
+                out.push_back(cur.to);      // cannot happen on a consistent metric
+            }
+        }
+    }
+}
+
+/**
+ * @brief Builds the metric-independent part of the customizable contraction hierarchy (CCH).
+ *
+ * @detailed
+ * Steps:
+ * 1. Elimination order by nested dissection (`nestedDissectionOrder`), so separators get
+ *    the highest ranks whatever the travel times are.
+ * 2. Chordal completion: nodes are eliminated in that order and their higher neighbours
+ *    become a clique. With the elimination tree this only needs to merge a node's upward
+ *    list into the list of its lowest higher neighbour (its elimination tree parent).
+ * 3. Upward arcs are stored in a CSR by node index (sorted by rank), together with the
+ *    reversed (downward) arcs and the customization levels: a node's level is one more
+ *    than the level of its lower neighbours, so every level can be customized in parallel.
+ *
+ * This runs once per topology; new travel times only need `customizeCch()`.
+ *
+ * @param gdata Reference to the graph data; `gdata.cch` is filled.
+ *
+ * @complexity
+ * - Time Complexity: O(V log V + E) for the order, O(A log A) for the completion (A = arcs).
+ * - Space Complexity: O(V + A).
+ */
+void buildCustomizableHierarchy(graph& gdata)
+{
+    auto& cch = gdata.cch;
+    const size_t n = gdata.index_to_node.size();
+    console("info", "computing the nested dissection order of the CCH.");
+    logger("computing the nested dissection order of the CCH.");
+
+    std::vector<int> order = nestedDissectionOrder(gdata);
+    cch.rank.assign(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        cch.rank[order[i]] = (int)i;
+    }
+    auto byRank = [&](int a, int b) {
+        return cch.rank[a] < cch.rank[b];
+    };
+
+    std::vector<std::vector<int>> up(n);
+    size_t input_arcs = 0;
+    for (size_t u = 0; u < n; ++u) {
+        size_t end_edge = gdata.offsets[u + 1];
+        for (size_t i = gdata.offsets[u]; i < end_edge; ++i) {
+            if (cch.rank[gdata.edges[i].target] > cch.rank[u]) {
+                up[u].push_back(gdata.edges[i].target);
+            }
+        }
+    }
+    cch.etree_parent.assign(n, -1);
+    for (int u : order) {
+        auto& list = up[u];
+        std::sort(list.begin(), list.end(), byRank);
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+        if (list.empty()) {
+            continue;
+        }
+        cch.etree_parent[u] = list[0];
+        auto& parent_list = up[list[0]];
+        parent_list.insert(parent_list.end(), list.begin() + 1, list.end());
+    }
+    for (size_t u = 0; u < n; ++u) {
+        size_t end_edge = gdata.offsets[u + 1];
+        for (size_t i = gdata.offsets[u]; i < end_edge; ++i) {
+            input_arcs += (cch.rank[gdata.edges[i].target] > cch.rank[u]);
+        }
+    }
+
+    cch.up_offsets.assign(n + 1, 0);
+    for (size_t u = 0; u < n; ++u) {
+        cch.up_offsets[u + 1] = cch.up_offsets[u] + up[u].size();
+    }
+    cch.up_targets.resize(cch.up_offsets[n]);
+    std::vector<size_t> down_count(n + 1, 0);
+    for (size_t u = 0; u < n; ++u) {
+        std::copy(up[u].begin(), up[u].end(), cch.up_targets.begin() + cch.up_offsets[u]);
+        for (int v : up[u]) {
+            down_count[v + 1]++;
+        }
+        std::vector<int>().swap(up[u]);
+    }
+
+    cch.down_offsets.assign(n + 1, 0);
+    for (size_t v = 0; v < n; ++v) {
+        cch.down_offsets[v + 1] = cch.down_offsets[v] + down_count[v + 1];
+    }
+    cch.down_arcs.resize(cch.up_targets.size());
+    std::vector<size_t> fill(cch.down_offsets.begin(), cch.down_offsets.end() - 1);
+    for (size_t u = 0; u < n; ++u) {
+        for (size_t a = cch.up_offsets[u]; a < cch.up_offsets[u + 1]; ++a) {
+            cch.down_arcs[fill[cch.up_targets[a]]++] = { (int)u, a };
+        }
+    }
+
+    std::vector<int> level(n, 0);
+    int max_level = 0;
+    for (int v : order) {
+        for (size_t k = cch.down_offsets[v]; k < cch.down_offsets[v + 1]; ++k) {
+            level[v] = std::max(level[v], level[cch.down_arcs[k].first] + 1);
+        }
+        max_level = std::max(max_level, level[v]);
+    }
+    cch.levels.assign((size_t)max_level + 1, {});
+    for (int v : order) {
+        cch.levels[level[v]].push_back(v);
+    }
+    cch.built = true;
+
+    std::ostringstream output_stream;
+    output_stream << "CCH built (" << cch.up_targets.size() << " arcs, " << (cch.up_targets.size() - input_arcs)
+        << " fill-in arcs, " << cch.levels.size() << " customization levels).";
+    console("success", output_stream.str());
+    logger(output_stream.str());
+}
+
+/**
+ * @brief Customizes the CCH for a set of travel times (one weight per CSR edge of `gdata`).
+ *
+ * @detailed
+ * Functionality:
+ * - Input weights: each arc gets the smallest weight of the graph edges it represents
+ *   (fill-in arcs start at "infinity").
+ * - Basic customization: every arc `(v, w)` is lowered to `min over u of (u, v) + (u, w)`
+ *   for the lower triangles `{u, v, w}`. Levels are processed in increasing order and the
+ *   nodes of a level in parallel; each node only writes its own upward arcs and reads arcs
+ *   of lower levels, so no locking is needed. The arcs of `u` above `v` and the arcs of `v`
+ *   are both sorted by rank, so `(v, w)` is found by a merge walk instead of a lookup table.
+ * - The result is a new immutable metric: the caller publishes it with `std::atomic_store`
+ *   while queries keep using the previous one.
+ *
+ * @param gdata Reference to the graph data (with `gdata.cch` built).
+ * @param edge_weights Travel time of every entry of `gdata.edges`.
+ * @param nb_threads Number of workers (`0` or less = number of hardware threads).
+ * @return The customized metric.
+ *
+ * @complexity
+ * - Time Complexity: O(T / P) with T the number of lower triangles and P the workers.
+ * - Space Complexity: O(A).
+ */
+std::shared_ptr<const cch_metric> customizeCch(const graph& gdata, const std::vector<int>& edge_weights, int nb_threads)
+{
+    const auto& cch = gdata.cch;
+    const size_t n = gdata.index_to_node.size();
+    auto metric = std::make_shared<cch_metric>();
+    metric->input.assign(cch.up_targets.size(), cch_inf);
+
+    for (size_t u = 0; u < n; ++u) {
+        size_t end_edge = gdata.offsets[u + 1];
+        for (size_t i = gdata.offsets[u]; i < end_edge; ++i) {
+            int v = gdata.edges[i].target;
+            if (cch.rank[v] > cch.rank[u]) {
+                size_t arc = findArc(cch, (int)u, v);
+                metric->input[arc] = std::min(metric->input[arc], edge_weights[i]);
+            }
+        }
+    }
+    metric->weight = metric->input;
+    auto& weight = metric->weight;
+
+    size_t nb_workers = (nb_threads > 0) ? (size_t)nb_threads : (size_t)std::thread::hardware_concurrency();
+    nb_workers = std::max<size_t>(1, nb_workers);
+
+    auto customizeNode = [&](int v) {
+        for (size_t k = cch.down_offsets[v]; k < cch.down_offsets[v + 1]; ++k) {
+            auto [u, arc_uv] = cch.down_arcs[k];
+            const int w_uv = weight[arc_uv];
+            if (w_uv >= cch_inf) {
+                continue;
+            }
+            // arcs of `u` after `v` lead to nodes ranked above `v`, all neighbours of `v` (chordal graph),
+            // in the same rank order as the arcs of `v`: skip to the first one, then walk both lists.
+            const size_t end_u = cch.up_offsets[u + 1];
+            if (arc_uv + 1 == end_u) {
+                continue;
+            }
+            const int first_rank = cch.rank[cch.up_targets[arc_uv + 1]];
+            size_t arc_vw = std::partition_point(cch.up_targets.begin() + cch.up_offsets[v], cch.up_targets.begin() + cch.up_offsets[v + 1],
+                [&](int w) { return cch.rank[w] < first_rank; }) - cch.up_targets.begin();
+            for (size_t b = arc_uv + 1; b < end_u; ++b) {
+                const int w = cch.up_targets[b];
+                while (cch.up_targets[arc_vw] != w) {
+                    ++arc_vw;
+                }
+                if (weight[b] < cch_inf) {
+                    weight[arc_vw] = std::min(weight[arc_vw], w_uv + weight[b]);
+                }
+            }
+        }
+    };
+
+    for (size_t l = 1; l < cch.levels.size(); ++l) {
+        const auto& nodes = cch.levels[l];
+        if (nb_workers == 1 || nodes.size() < cch_parallel_level) {
+            for (int v : nodes) {
+                customizeNode(v);
+            }
+            continue;
+        }
+        std::atomic<size_t> next(0);
+        std::vector<std::thread> workers;
+        for (size_t w = 0; w < nb_workers; ++w) {
+            workers.emplace_back([&]() {
+                for (size_t k = next++; k < nodes.size(); k = next++) {
+                    customizeNode(nodes[k]);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    return metric;
+}
+
+/**
+ * @brief Reads new travel times from a CSV with the same topology as the loaded graph.
+ *
+ * @detailed
+ * The CSR is rebuilt line by line exactly like `loadGraphData()`, so line `k` maps to the
+ * same two CSR entries; every line must join the same two nodes as when the graph was
+ * loaded (only the third column may change).
+ *
+ * @param gdata Reference to the loaded graph data.
+ * @param map_path Path of the CSV file.
+ * @param edge_weights Output: one travel time per entry of `gdata.edges`.
+ * @return `false` if the file is unreadable or its topology differs.
+ */
+bool readEdgeWeights(const graph& gdata, const std::string& map_path, std::vector<int>& edge_weights)
+{
+    std::vector<edge> edges;
+    if (!readCSV(map_path, edges) || edges.size() != gdata.line_count) {
+        return false;
+    }
+
+    const size_t n = gdata.index_to_node.size();
+    std::vector<size_t> current(n, 0);
+    edge_weights.assign(gdata.edges.size(), 0);
+    for (const auto& e : edges) {
+        auto it_a = gdata.node_to_index.find(e.a);
+        auto it_b = gdata.node_to_index.find(e.b);
+        if (it_a == gdata.node_to_index.end() || it_b == gdata.node_to_index.end()) {
+            return false;
+        }
+        size_t ia = it_a->second;
+        size_t ib = it_b->second;
+        size_t pos_a = gdata.offsets[ia] + current[ia]++;
+        size_t pos_b = gdata.offsets[ib] + current[ib]++;
+        if (gdata.edges[pos_a].target != (int)ib || gdata.edges[pos_b].target != (int)ia) {
+            return false;
+        }
+        edge_weights[pos_a] = e.t;
+        edge_weights[pos_b] = e.t;
+    }
+    return true;
+}
+
+/**
+ * @brief Finds the shortest path with the CCH (elimination tree query).
+ *
+ * @detailed
+ * Functionality:
+ * - In a chordal upward graph, the nodes reachable upwards from `s` are exactly its
+ *   ancestors in the elimination tree. Both searches therefore walk the tree from `s`
+ *   (resp. `t`) to the root and relax the arcs of every reached ancestor, without any
+ *   priority queue.
+ * - The distance is the minimum of `d_s(v) + d_t(v)` over the common ancestors.
+ * - The metric is read once with `std::atomic_load`, so a customization published during
+ *   the query does not affect it (the old metric stays alive until the query ends).
+ * - Arcs are unpacked through their lower triangles to rebuild the itinerary.
+ * - Both nodes are looked up before the trivial `start_node == end_node` case, so an
+ *   unknown ID gives `-1` (a `404` at the gateway) even when it is both endpoints.
+ *
+ * @param gdata Reference to the graph data (with `gdata.cch` built and customized).
+ * @param buffers Reference to `search_buffers` for optimized memory management.
+ * @param start_node The starting node.
+ * @param end_node The target node.
+ * @param distance_only If `true`, only `total_time` is computed (`total_node = 0`, no `steps`).
+ * @return A `path_result` structure containing the shortest path details (`-1` if a node is
+ *         unknown, no metric is published or no path exists).
+ *
+ * @complexity
+ * - Time Complexity: O(sum of the upward degrees of the ancestors of `s` and `t`).
+ * - Space Complexity: O(V) for the search buffers.
+ */
+path_result findShortestPathCch(const graph& gdata, search_buffers& buffers, int start_node, int end_node, bool distance_only)
+{
+    const auto& cch = gdata.cch;
+    auto it_start = gdata.node_to_index.find(start_node);
+    auto it_end = gdata.node_to_index.find(end_node);
+    std::shared_ptr<const cch_metric> metric = std::atomic_load(&cch.metric);
+    if (!metric || it_start == gdata.node_to_index.end() || it_end == gdata.node_to_index.end()) {
+        return { -1, 0, {} };
+    }
+    if (start_node == end_node) {
+        return { 0, 0, {} };
+    }
+    const int start_idx = (int)it_start->second;
+    const int end_idx = (int)it_end->second;
+    const auto& weight = metric->weight;
+
+    buffers.current_search_id++;
+    setDistFromStart(buffers, start_idx, 0);
+    setDistFromEnd(buffers, end_idx, 0);
+
+    for (int v = start_idx; v >= 0; v = cch.etree_parent[v]) {
+        int dist = getDistFromStart(buffers, v);
+        if (dist < 0) {
+            continue;
+        }
+        for (size_t a = cch.up_offsets[v]; a < cch.up_offsets[v + 1]; ++a) {
+            if (weight[a] >= cch_inf) {
+                continue;
+            }
+            int target = cch.up_targets[a];
+            int old = getDistFromStart(buffers, target);
+            if (old < 0 || dist + weight[a] < old) {
+                setDistFromStart(buffers, target, dist + weight[a]);
+                setParentForward(buffers, target, { v, (int)a });
+            }
+        }
+    }
+    for (int v = end_idx; v >= 0; v = cch.etree_parent[v]) {
+        int dist = getDistFromEnd(buffers, v);
+        if (dist < 0) {
+            continue;
+        }
+        for (size_t a = cch.up_offsets[v]; a < cch.up_offsets[v + 1]; ++a) {
+            if (weight[a] >= cch_inf) {
+                continue;
+            }
+            int target = cch.up_targets[a];
+            int old = getDistFromEnd(buffers, target);
+            if (old < 0 || dist + weight[a] < old) {
+                setDistFromEnd(buffers, target, dist + weight[a]);
+                setParentBackward(buffers, target, { v, (int)a });
+            }
+        }
+    }
+
+    int best = -1;
+    int meet_idx = -1;
+    for (int v = start_idx; v >= 0; v = cch.etree_parent[v]) {
+        int df = getDistFromStart(buffers, v);
+        int db = getDistFromEnd(buffers, v);
+        if (df >= 0 && db >= 0 && (best < 0 || df + db < best)) {
+            best = df + db;
+            meet_idx = v;
+        }
+    }
+    if (best < 0) {
+        return { -1, 0, {} };
+    }
+    if (distance_only) {
+        return { best, 0, {} };
+    }
+
+    std::vector<std::pair<int, int>> forward_arcs;      // (parent, arc), meet -> start
+    for (int cur = meet_idx; cur != start_idx;) {
+        auto par = getParentForward(buffers, cur);
+        forward_arcs.push_back(par);
+        cur = par.first;
+    }
+    std::reverse(forward_arcs.begin(), forward_arcs.end());
+
+    std::vector<int> steps{ start_idx };
+    for (const auto& [from, arc] : forward_arcs) {
+        appendUnpackedArc(cch, *metric, from, cch.up_targets[arc], (size_t)arc, steps);
+    }
+    for (int cur = meet_idx; cur != end_idx;) {
+        auto par = getParentBackward(buffers, cur);
+        appendUnpackedArc(cch, *metric, cur, par.first, (size_t)par.second, steps);
+        cur = par.first;
+    }
+    for (auto& idx : steps) {
+        idx = gdata.index_to_node[idx];
+    }
+
+    path_result result{};
+    result.total_time = best;
+    result.total_node = (int)steps.size();
+    result.steps = std::move(steps);
+    return result;
+}
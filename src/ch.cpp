@@ -0,0 +1,346 @@
+﻿#include "incl.h"
+#include "decl.h"
+
+namespace {
+    struct dyn_edge {
+        int target;
+        int weight;
+        int middle;
+    };
+
+    /**
+     * @brief Bounded local Dijkstra used to look for witness paths during contraction.
+     *
+     * Distances are versioned with a stamp, like `search_buffers`, so each witness
+     * search only touches the few nodes it settles. The search stops as soon as all
+     * marked targets are settled.
+     */
+    struct witness_search {
+        std::vector<int> dist;
+        std::vector<int> stamp;
+        std::vector<int> target_stamp;
+        std::vector<std::pair<int, int>> heap;
+        int current_stamp = 0;
+
+        explicit witness_search(size_t n) : dist(n, 0), stamp(n, 0), target_stamp(n, 0) {}
+
+        int get(size_t idx) const {
+            return (stamp[idx] == current_stamp) ? dist[idx] : -1;
+        }
+
+        void markTarget(size_t idx) {
+            target_stamp[idx] = current_stamp + 1;
+        }
+
+        void run(const std::vector<std::vector<dyn_edge>>& adj, int source, int avoid, int max_dist, int max_settled, int nb_targets) {
+            current_stamp++;
+            heap.clear();
+
+            dist[source] = 0;
+            stamp[source] = current_stamp;
+            heap.push_back({ 0, source });
+
+            int settled = 0;
+            while (!heap.empty()) {
+                std::pop_heap(heap.begin(), heap.end(), std::greater<std::pair<int, int>>());
+                auto [cur_dist, cur] = heap.back();
+                heap.pop_back();
+                if (get(cur) != cur_dist) {
+                    continue;
+                }
+                if (cur_dist > max_dist || ++settled > max_settled) {
+                    break;
+                }
+                if (target_stamp[cur] == current_stamp && --nb_targets == 0) {
+                    break;
+                }
+                for (const auto& e : adj[cur]) {
+                    if (e.target == avoid) {
+                        continue;
+                    }
+                    int nd = cur_dist + e.weight;
+                    int old = get(e.target);
+                    if (old < 0 || nd < old) {
+                        dist[e.target] = nd;
+                        stamp[e.target] = current_stamp;
+                        heap.push_back({ nd, e.target });
+                        std::push_heap(heap.begin(), heap.end(), std::greater<std::pair<int, int>>());
+                    }
+                }
+            }
+        }
+    };
+
+    /**
+     * @brief Contracts nodes by increasing importance until `core_size` nodes remain.
+     *
+     * @param gdata Reference to the graph data.
+     * @param core_size Number of nodes left uncontracted (`0` = contract everything).
+     * @param order Output contraction order.
+     * @param up_lists Output edges of each contracted node towards the nodes still present
+     *                 when it was contracted (original edges and shortcuts).
+     * @param adj Output remaining graph: the core nodes and the edges between them.
+     * @param shortcut_count Output number of shortcuts added.
+     */
+    void contractNodes(const graph& gdata, size_t core_size, std::vector<int>& order, std::vector<std::vector<dyn_edge>>& up_lists, std::vector<std::vector<dyn_edge>>& adj, size_t& shortcut_count)
+    {
+        const size_t n = gdata.index_to_node.size();
+        const int max_settled_simulation = 50;
+        const int max_settled_contraction = 500;
+
+        adj.assign(n, {});
+        for (size_t v = 0; v < n; ++v) {
+            size_t start_edge = gdata.offsets[v];
+            size_t end_edge = gdata.offsets[v + 1];
+            adj[v].reserve(end_edge - start_edge);
+            for (size_t i = start_edge; i < end_edge; ++i) {
+                adj[v].push_back({ gdata.edges[i].target, gdata.edges[i].weight, -1 });
+            }
+        }
+
+        witness_search witness(n);
+        std::vector<int> deleted_neighbours(n, 0);
+        std::vector<bool> contracted(n, false);
+        up_lists.assign(n, {});
+        order.clear();
+        order.reserve(n);
+        shortcut_count = 0;
+
+        auto addShortcut = [&](int u, int w, int weight, int middle) {
+            for (auto& e : adj[u]) {
+                if (e.target == w) {
+                    if (weight < e.weight) {
+                        e.weight = weight;
+                        e.middle = middle;
+                        for (auto& back : adj[w]) {
+                            if (back.target == u) {
+                                back.weight = weight;
+                                back.middle = middle;
+                                break;
+                            }
+                        }
+                    }
+                    return;
+                }
+            }
+            adj[u].push_back({ w, weight, middle });
+            adj[w].push_back({ u, weight, middle });
+            shortcut_count++;
+        };
+
+        auto processNeighbours = [&](int v, bool apply) -> int {
+            const auto nbrs = adj[v];
+            int shortcuts = 0;
+            for (size_t i = 0; i < nbrs.size(); ++i) {
+                int max_need = 0;
+                for (size_t j = i + 1; j < nbrs.size(); ++j) {
+                    max_need = std::max(max_need, nbrs[i].weight + nbrs[j].weight);
+                }
+                if (max_need == 0) {
+                    continue;
+                }
+                for (size_t j = i + 1; j < nbrs.size(); ++j) {
+                    witness.markTarget(nbrs[j].target);
+                }
+                witness.run(adj, nbrs[i].target, v, max_need, apply ? max_settled_contraction : max_settled_simulation, (int)(nbrs.size() - i - 1));
+                for (size_t j = i + 1; j < nbrs.size(); ++j) {
+                    int need = nbrs[i].weight + nbrs[j].weight;
+                    int found = witness.get(nbrs[j].target);
+                    if (found < 0 || found > need) {
+                        shortcuts++;
+                        if (apply) {
+                            addShortcut(nbrs[i].target, nbrs[j].target, need, v);
+                        }
+                    }
+                }
+            }
+            return shortcuts;
+        };
+
+        auto computePriority = [&](int v) -> int {
+            int shortcuts = processNeighbours(v, false);
+            return shortcuts - (int)adj[v].size() + deleted_neighbours[v];
+        };
+
+        using pq_item = std::pair<int, int>;
+        std::priority_queue<pq_item, std::vector<pq_item>, std::greater<pq_item>> queue;
+        for (size_t v = 0; v < n; ++v) {
+            queue.push({ computePriority((int)v), (int)v });
+        }
+
+        size_t log_step = std::max<size_t>(n / 10, 1);
+        while (!queue.empty() && n - order.size() > core_size) {
+            int v = queue.top().second;
+            queue.pop();
+            if (contracted[v]) {
+                continue;
+            }
+
+            int priority = computePriority(v);
+            if (!queue.empty() && priority > queue.top().first) {
+                queue.push({ priority, v });
+                continue;
+            }
+
+            up_lists[v] = adj[v];
+            processNeighbours(v, true);
+
+            for (const auto& e : adj[v]) {
+                auto& nbr_adj = adj[e.target];
+                for (size_t k = 0; k < nbr_adj.size(); ++k) {
+                    if (nbr_adj[k].target == v) {
+                        nbr_adj[k] = nbr_adj.back();
+                        nbr_adj.pop_back();
+                        break;
+                    }
+                }
+                deleted_neighbours[e.target]++;
+            }
+            std::vector<dyn_edge>().swap(adj[v]);
+
+            contracted[v] = true;
+            order.push_back(v);
+
+            if (order.size() % log_step == 0) {
+                console("info", "contracted " + std::to_string(order.size()) + "/" + std::to_string(n) + " nodes.");
+            }
+        }
+    }
+}
+
+/**
+ * @brief Builds a contraction hierarchy (CH) over the loaded graph.
+ *
+ * @detailed
+ * Nodes are contracted one by one in increasing order of importance. Contracting
+ * a node `v` removes it from the remaining graph and, for every pair of remaining
+ * neighbours `(u, w)`, inserts a shortcut `u - w` of weight `w(u,v) + w(v,w)` unless
+ * a witness path that is not longer exists without `v`.
+ *
+ * Node Ordering (lazy updates):
+ * - priority(v) = (shortcuts needed - degree) + number of already contracted neighbours.
+ * - The node with the smallest priority is popped; its priority is recomputed and,
+ *   if it is no longer the minimum, it is pushed back instead of being contracted.
+ *
+ * Result (stored in `gdata.ch`):
+ * - Nodes are renumbered by sweep position (`0` = last contracted = most important).
+ * - Each node keeps its "upward" edges (edges and shortcuts to more important nodes),
+ *   stored as a CSR indexed by sweep position. Since the graph is undirected, the same
+ *   arrays give the incoming downward edges used by the PHAST sweep.
+ * - Shortcuts store the bypassed node (`middle`) so paths can be unpacked.
+ *
+ * Edge Cases Handled:
+ * - Witness searches are bounded (distance and settled nodes, with a tighter bound when
+ *   only estimating priorities); when the bound is hit, the shortcut is added anyway,
+ *   which keeps the hierarchy correct (only larger).
+ *
+ * @param gdata Reference to the graph data structure.
+ *
+ * @complexity
+ * - Time Complexity: roughly O(V × d² × W), with `d` the degree at contraction time and
+ *   `W` the bounded witness search cost (fast on road-like graphs).
+ * - Space Complexity: O(V + E + S), with `S` the number of shortcuts.
+ */
+void buildContractionHierarchy(graph& gdata)
+{
+    console("info", "starting contraction hierarchy construction.");
+    logger("starting contraction hierarchy construction.");
+
+    const size_t n = gdata.index_to_node.size();
+    std::vector<int> order;
+    std::vector<std::vector<dyn_edge>> up_lists;
+    std::vector<std::vector<dyn_edge>> adj;
+    size_t shortcut_count = 0;
+    contractNodes(gdata, 0, order, up_lists, adj, shortcut_count);
+
+    auto& ch = gdata.ch;
+    ch.node_at_pos.resize(n);
+    ch.pos_of.resize(n);
+    for (size_t k = 0; k < n; ++k) {
+        size_t pos = n - 1 - k;
+        ch.node_at_pos[pos] = order[k];
+        ch.pos_of[order[k]] = (int)pos;
+    }
+
+    ch.up_offsets.assign(n + 1, 0);
+    for (size_t pos = 0; pos < n; ++pos) {
+        ch.up_offsets[pos + 1] = ch.up_offsets[pos] + up_lists[ch.node_at_pos[pos]].size();
+    }
+    ch.up_edges.resize(ch.up_offsets[n]);
+    for (size_t pos = 0; pos < n; ++pos) {
+        size_t k = ch.up_offsets[pos];
+        for (const auto& e : up_lists[ch.node_at_pos[pos]]) {
+            ch.up_edges[k++] = { ch.pos_of[e.target], e.weight, e.middle };
+        }
+    }
+    ch.shortcut_count = shortcut_count;
+    ch.built = true;
+
+    console("success", "contraction hierarchy built (" + std::to_string(shortcut_count) + " shortcuts).");
+    logger("contraction hierarchy built: " + std::to_string(n) + " nodes, " + std::to_string(ch.up_edges.size()) + " upward edges, " + std::to_string(shortcut_count) + " shortcuts.");
+}
+
+/**
+ * @brief Contracts all but the `core_size` most important nodes and keeps the rest as a core.
+ *
+ * @detailed
+ * Same contraction as `buildContractionHierarchy()`, stopped early. The result is stored in
+ * `gdata.core` as one CSR indexed by node index:
+ * - a contracted node keeps its upward edges (towards nodes contracted later, or core nodes);
+ * - a core node keeps its edges inside the core (original edges and shortcuts), so distances
+ *   between core nodes are the same as in the full graph.
+ *
+ * Any shortest path can then be written as upward edges from the source, a path inside the
+ * core, and downward edges to the target (or just upward edges meeting outside the core).
+ *
+ * @param gdata Reference to the graph data structure.
+ * @param core_size Number of nodes left uncontracted.
+ *
+ * @complexity
+ * - Time Complexity: as `buildContractionHierarchy()`, for the contracted nodes only.
+ * - Space Complexity: O(V + E + S).
+ */
+void buildContractedCore(graph& gdata, size_t core_size)
+{
+    console("info", "contracting the graph down to a core of " + std::to_string(core_size) + " nodes.");
+    logger("contracting the graph down to a core of " + std::to_string(core_size) + " nodes.");
+
+    const size_t n = gdata.index_to_node.size();
+    std::vector<int> order;
+    std::vector<std::vector<dyn_edge>> up_lists;
+    std::vector<std::vector<dyn_edge>> adj;
+    size_t shortcut_count = 0;
+    contractNodes(gdata, core_size, order, up_lists, adj, shortcut_count);
+
+    auto& core = gdata.core;
+    core.core_id.assign(n, -1);
+    core.core_nodes.clear();
+    std::vector<bool> contracted(n, false);
+    for (int v : order) {
+        contracted[v] = true;
+    }
+    for (size_t v = 0; v < n; ++v) {
+        if (!contracted[v]) {
+            core.core_id[v] = (int)core.core_nodes.size();
+            core.core_nodes.push_back((int)v);
+        }
+    }
+
+    core.offsets.assign(n + 1, 0);
+    for (size_t v = 0; v < n; ++v) {
+        const auto& list = contracted[v] ? up_lists[v] : adj[v];
+        core.offsets[v + 1] = core.offsets[v] + list.size();
+    }
+    core.edges.resize(core.offsets[n]);
+    for (size_t v = 0; v < n; ++v) {
+        const auto& list = contracted[v] ? up_lists[v] : adj[v];
+        size_t k = core.offsets[v];
+        for (const auto& e : list) {
+            core.edges[k++] = { e.target, e.weight, e.middle };
+        }
+    }
+    core.shortcut_count = shortcut_count;
+
+    console("success", "core built (" + std::to_string(core.core_nodes.size()) + " core nodes, " + std::to_string(shortcut_count) + " shortcuts).");
+    logger("core built: " + std::to_string(core.core_nodes.size()) + " core nodes out of " + std::to_string(n) + ", " + std::to_string(shortcut_count) + " shortcuts.");
+}
@@ -0,0 +1,424 @@
+﻿#include "incl.h"
+#include "decl.h"
+
+namespace {
+    /**
+     * @brief Returns the CSR range `[begin, end)` of the edges of a node index.
+     */
+    inline std::pair<size_t, size_t> edgeRange(const graph& gdata, size_t idx)
+    {
+        size_t end = gdata.offsets[idx + 1];
+        return { gdata.offsets[idx], end };
+    }
+
+    /**
+     * @brief A kept node through which a query endpoint enters the compressed graph.
+     */
+    struct chain_exit
+    {
+        int node;       // kept node ID
+        int cost;       // distance along the chain from the endpoint
+    };
+
+    /**
+     * @brief Lists the kept nodes a query endpoint can leave through.
+     *
+     * A kept node leaves through itself; a removed node through both ends of its chain
+     * (once if the chain is a loop). Returns an empty list for unknown nodes.
+     *
+     * @complexity
+     * - Time Complexity: O(log C) (chain lookup).
+     * - Space Complexity: O(1).
+     */
+    std::vector<chain_exit> chainExits(const graph& gdata, int node, int& chain, size_t& slot)
+    {
+        const auto& cc = gdata.chains;
+        chain = -1;
+        if (gdata.node_to_index.count(node)) {
+            return { { node, 0 } };
+        }
+        auto it = cc.position.find(node);
+        if (it == cc.position.end()) {
+            return {};
+        }
+        slot = it->second;
+        chain = (int)(std::upper_bound(cc.first.begin(), cc.first.end(), slot) - cc.first.begin()) - 1;
+        int to_from = cc.offset[slot];
+        int to_to = cc.length[chain] - to_from;
+        if (cc.from[chain] == cc.to[chain]) {
+            return { { cc.from[chain], std::min(to_from, to_to) } };
+        }
+        return { { cc.from[chain], to_from }, { cc.to[chain], to_to } };
+    }
+
+    /**
+     * @brief Appends the removed nodes met when walking a chain from `slot` towards one of its ends.
+     *
+     * @param towards_from `true` to walk towards `from[chain]`, `false` towards `to[chain]`.
+     * @param include_slot `true` to also append the node at `slot` itself.
+     */
+    void appendChainWalk(const chain_compression& cc, int chain, size_t slot, bool towards_from, bool include_slot, std::vector<int>& out)
+    {
+        if (towards_from) {
+            for (size_t k = slot + (include_slot ? 1 : 0); k > cc.first[chain]; --k) {
+                out.push_back(cc.interior[k - 1]);
+            }
+        }
+        else {
+            for (size_t k = slot + (include_slot ? 0 : 1); k < cc.first[chain + 1]; ++k) {
+                out.push_back(cc.interior[k]);
+            }
+        }
+    }
+
+    /**
+     * @brief Expands the collapsed edges of an itinerary of the compressed graph.
+     *
+     * Between two consecutive nodes, the cheapest parallel edge is the one a shortest path
+     * uses; if it is a chain, its removed nodes are inserted in travel order.
+     *
+     * @complexity
+     * - Time Complexity: O(P × D + R) for `P` steps of degree `D` and `R` restored nodes.
+     * - Space Complexity: O(P + R).
+     */
+    std::vector<int> expandChainSteps(const graph& gdata, const std::vector<int>& steps)
+    {
+        const auto& cc = gdata.chains;
+        std::vector<int> out;
+        out.reserve(steps.size());
+        for (size_t i = 0; i < steps.size(); ++i) {
+            if (i > 0) {
+                size_t u = gdata.node_to_index.at(steps[i - 1]);
+                size_t v = gdata.node_to_index.at(steps[i]);
+                auto [begin, end] = edgeRange(gdata, u);
+                int best_weight = std::numeric_limits<int>::max();
+                int chain = -1;
+                for (size_t pos = begin; pos < end; ++pos) {
+                    if ((size_t)gdata.edges[pos].target == v && gdata.edges[pos].weight < best_weight) {
+                        best_weight = gdata.edges[pos].weight;
+                        chain = cc.edge_chain[pos];
+                    }
+                }
+                if (chain >= 0) {
+                    if (cc.from[chain] == steps[i - 1]) {
+                        out.insert(out.end(), cc.interior.begin() + cc.first[chain], cc.interior.begin() + cc.first[chain + 1]);
+                    }
+                    else {
+                        out.insert(out.end(), cc.interior.rbegin() + (cc.interior.size() - cc.first[chain + 1]),
+                                   cc.interior.rbegin() + (cc.interior.size() - cc.first[chain]));
+                    }
+                }
+            }
+            out.push_back(steps[i]);
+        }
+        return out;
+    }
+}
+
+/**
+ * @brief Collapses the maximal chains of degree-2 nodes into single edges.
+ *
+ * @detailed
+ * Road CSVs describe curves with many intermediate nodes of degree 2. Each of them costs a
+ * heap operation and a heuristic evaluation in every search, without ever being a choice.
+ *
+ * - A node is removable when it has exactly two edges, to two distinct other nodes.
+ * - From every kept node, each edge leading to a removable node is walked until the next
+ *   kept node; the removed nodes and their distance from the first end are stored in
+ *   `gdata.chains`, and the chain becomes one edge whose weight is the sum of the chain.
+ * - Chains that come back to their first end (loops) are never on a shortest path: their
+ *   edge is dropped, but their nodes stay reachable as query endpoints.
+ * - Components made only of degree-2 nodes (plain cycles) are left untouched.
+ * - The CSR, `node_to_index` and `index_to_node` are rebuilt over the kept nodes (same
+ *   relative order), `edge_chain` records which new edges are chains and `chains_at` which
+ *   chains end at each kept node.
+ *
+ * Must run right after the CSR is built, before any preprocessing that indexes nodes
+ * (CH, ALT, CCH, POI sets). The node and edge reduction is logged.
+ *
+ * @param gdata Reference to the graph data.
+ *
+ * @complexity
+ * - Time Complexity: O(V + E).
+ * - Space Complexity: O(V + E).
+ */
+void compressChains(graph& gdata)
+{
+    auto& cc = gdata.chains;
+    cc = chain_compression();
+    const size_t n = gdata.index_to_node.size();
+    cc.original_nodes = n;
+    cc.original_edges = gdata.edges.size() / 2;
+
+    std::vector<char> removable(n, 0);
+    for (size_t idx = 0; idx < n; ++idx) {
+        auto [begin, end] = edgeRange(gdata, idx);
+        if (end - begin == 2) {
+            int a = gdata.edges[begin].target;
+            int b = gdata.edges[begin + 1].target;
+            removable[idx] = (a != b && (size_t)a != idx && (size_t)b != idx);
+        }
+    }
+
+    std::vector<char> removed(n, 0);
+    std::vector<int> entry_chain(gdata.edges.size(), -1);   // chain leaving at this CSR entry (-2 = loop)
+    cc.first.push_back(0);
+    for (size_t idx = 0; idx < n; ++idx) {
+        if (removable[idx]) {
+            continue;
+        }
+        auto [begin, end] = edgeRange(gdata, idx);
+        for (size_t pos = begin; pos < end; ++pos) {
+            size_t cur = (size_t)gdata.edges[pos].target;
+            if (!removable[cur] || removed[cur]) {
+                continue;
+            }
+            int chain = (int)cc.from.size();
+            size_t prev = idx;
+            int length = gdata.edges[pos].weight;
+            while (removable[cur]) {
+                removed[cur] = 1;
+                cc.position[gdata.index_to_node[cur]] = cc.interior.size();
+                cc.interior.push_back(gdata.index_to_node[cur]);
+                cc.offset.push_back(length);
+                auto [cbegin, cend] = edgeRange(gdata, cur);
+                (void)cend;
+                size_t next_pos = ((size_t)gdata.edges[cbegin].target == prev) ? cbegin + 1 : cbegin;
+                prev = cur;
+                cur = (size_t)gdata.edges[next_pos].target;
+                length += gdata.edges[next_pos].weight;
+            }
+            bool loop = (cur == idx);
+            entry_chain[pos] = loop ? -2 : chain;
+            if (!loop) {
+                auto [ebegin, eend] = edgeRange(gdata, cur);
+                for (size_t epos = ebegin; epos < eend; ++epos) {
+                    if ((size_t)gdata.edges[epos].target == prev) {
+                        entry_chain[epos] = chain;
+                    }
+                }
+            }
+            cc.from.push_back(gdata.index_to_node[idx]);
+            cc.to.push_back(gdata.index_to_node[cur]);
+            cc.length.push_back(length);
+            cc.first.push_back(cc.interior.size());
+        }
+    }
+    if (cc.from.empty()) {
+        logger("chain compression: no degree-2 chain found.");
+        return;
+    }
+    for (size_t chain = 0; chain < cc.from.size(); ++chain) {
+        cc.chains_at[cc.from[chain]].push_back((int)chain);
+        if (cc.to[chain] != cc.from[chain]) {
+            cc.chains_at[cc.to[chain]].push_back((int)chain);
+        }
+    }
+
+    std::vector<int> new_index(n, -1);
+    std::vector<int> index_to_node;
+    for (size_t idx = 0; idx < n; ++idx) {
+        if (!removed[idx]) {
+            new_index[idx] = (int)index_to_node.size();
+            index_to_node.push_back(gdata.index_to_node[idx]);
+        }
+    }
+
+    huge_vector<size_t> offsets;
+    huge_vector<graph::edge_repr> edges;
+    offsets.reserve(index_to_node.size() + 1);
+    edges.reserve(gdata.edges.size());
+    for (size_t idx = 0; idx < n; ++idx) {
+        if (removed[idx]) {
+            continue;
+        }
+        offsets.push_back(edges.size());
+        auto [begin, end] = edgeRange(gdata, idx);
+        for (size_t pos = begin; pos < end; ++pos) {
+            int target = gdata.edges[pos].target;
+            if (!removed[target]) {
+                edges.push_back({ new_index[target], gdata.edges[pos].weight });
+                cc.edge_chain.push_back(-1);
+            }
+            else if (entry_chain[pos] >= 0) {
+                int chain = entry_chain[pos];
+                int other = (cc.from[chain] == gdata.index_to_node[idx]) ? cc.to[chain] : cc.from[chain];
+                edges.push_back({ new_index[gdata.node_to_index.at(other)], cc.length[chain] });
+                cc.edge_chain.push_back(chain);
+            }
+        }
+    }
+    offsets.push_back(edges.size());
+    gdata.node_to_index.clear();
+    for (size_t idx = 0; idx < index_to_node.size(); ++idx) {
+        gdata.node_to_index[index_to_node[idx]] = idx;
+    }
+    gdata.index_to_node = std::move(index_to_node);
+    gdata.index_count = gdata.index_to_node.size();
+    gdata.offsets = std::move(offsets);
+    gdata.edges = std::move(edges);
+    gdata.edges.shrink_to_fit();
+    cc.built = true;
+
+    size_t kept_nodes = gdata.index_to_node.size();
+    size_t kept_edges = gdata.edges.size() / 2;
+    std::stringstream ss;
+    ss << "chain compression: " << cc.from.size() << " chains, nodes " << cc.original_nodes << " -> " << kept_nodes
+       << " (-" << std::fixed << std::setprecision(1) << 100.0 * (double)(cc.original_nodes - kept_nodes) / (double)std::max<size_t>(cc.original_nodes, 1)
+       << "%), edges " << cc.original_edges << " -> " << kept_edges
+       << " (-" << 100.0 * (double)(cc.original_edges - kept_edges) / (double)std::max<size_t>(cc.original_edges, 1) << "%).";
+    console("success", ss.str());
+    logger(ss.str());
+}
+
+/**
+ * @brief Answers a point-to-point query on the compressed graph, for any original node.
+ *
+ * @detailed
+ * - Kept endpoints are passed to `engine` as is.
+ * - A removed endpoint leaves its chain through either end; every (start exit, end exit)
+ *   pair is tried in increasing order of chain cost, and a pair is skipped once its chain
+ *   cost alone reaches the best total (at most 4 engine queries, usually fewer).
+ * - Both endpoints on the same chain also get the direct walk along the chain.
+ * - The itinerary is rebuilt with the removed nodes: walk to the exit, expanded chains of
+ *   the engine path (`expandChainSteps()`), walk from the entry.
+ *
+ * - A removed node queried against itself is answered like the engines answer a kept one
+ *   (`0`, no steps), without going through its chain exits.
+ *
+ * Without compression, this is exactly `engine(start_node, end_node)`.
+ *
+ * @param gdata Reference to the graph data.
+ * @param start_node The starting node (original ID).
+ * @param end_node The target node (original ID).
+ * @param distance_only If `true`, only `total_time` is computed (`engine` must do the same).
+ * @param engine Point-to-point engine on the compressed graph.
+ * @return A `path_result` on the original graph (`-1` if no path or unknown node).
+ *
+ * @complexity
+ * - Time Complexity: up to 4 engine queries, plus O(P) to restore the itinerary.
+ * - Space Complexity: O(P).
+ */
+path_result routeThroughChains(const graph& gdata, int start_node, int end_node, bool distance_only, const std::function<path_result(int, int)>& engine)
+{
+    const auto& cc = gdata.chains;
+    if (!cc.built) {
+        return engine(start_node, end_node);
+    }
+    if (start_node == end_node) {
+        return cc.position.count(start_node) ? path_result{ 0, 0, {} } : engine(start_node, end_node);
+    }
+
+    int start_chain = -1;
+    int end_chain = -1;
+    size_t start_slot = 0;
+    size_t end_slot = 0;
+    auto start_exits = chainExits(gdata, start_node, start_chain, start_slot);
+    auto end_exits = chainExits(gdata, end_node, end_chain, end_slot);
+    if (start_exits.empty() || end_exits.empty()) {
+        return { -1, 0, {} };
+    }
+
+    const int inf = std::numeric_limits<int>::max();
+    int best = inf;
+    size_t best_start = 0;
+    size_t best_end = 0;
+    bool direct = false;
+    path_result best_core{ -1, 0, {} };
+
+    if (start_chain >= 0 && start_chain == end_chain) {
+        best = std::abs(cc.offset[start_slot] - cc.offset[end_slot]);
+        direct = true;
+    }
+
+    std::vector<std::tuple<int, size_t, size_t>> pairs;
+    for (size_t a = 0; a < start_exits.size(); ++a) {
+        for (size_t b = 0; b < end_exits.size(); ++b) {
+            pairs.push_back({ start_exits[a].cost + end_exits[b].cost, a, b });
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+    for (const auto& [chain_cost, a, b] : pairs) {
+        if (chain_cost >= best) {
+            break;
+        }
+        path_result core = (start_exits[a].node == end_exits[b].node) ? path_result{ 0, 1, { start_exits[a].node } }
+                                                                      : engine(start_exits[a].node, end_exits[b].node);
+        if (core.total_time >= 0 && chain_cost + core.total_time < best) {
+            best = chain_cost + core.total_time;
+            best_start = a;
+            best_end = b;
+            direct = false;
+            best_core = std::move(core);
+        }
+    }
+    if (best == inf) {
+        return { -1, 0, {} };
+    }
+    if (distance_only) {
+        return { best, 0, {} };
+    }
+
+    std::vector<int> steps;
+    if (direct) {
+        steps.push_back(start_node);
+        if (end_slot > start_slot) {
+            steps.insert(steps.end(), cc.interior.begin() + start_slot + 1, cc.interior.begin() + end_slot + 1);
+        }
+        else {
+            for (size_t k = start_slot; k > end_slot; --k) {
+                steps.push_back(cc.interior[k - 1]);
+            }
+        }
+    }
+    else {
+        if (start_chain >= 0) {
+            bool towards_from = (start_exits[best_start].node == cc.from[start_chain]
+                                 && start_exits[best_start].cost == cc.offset[start_slot]);
+            appendChainWalk(cc, start_chain, start_slot, towards_from, true, steps);
+        }
+        std::vector<int> core_steps = expandChainSteps(gdata, best_core.steps);
+        steps.insert(steps.end(), core_steps.begin(), core_steps.end());
+        if (end_chain >= 0) {
+            bool from_side = (end_exits[best_end].node == cc.from[end_chain]
+                              && end_exits[best_end].cost == cc.offset[end_slot]);
+            std::vector<int> tail;
+            appendChainWalk(cc, end_chain, end_slot, from_side, true, tail);
+            steps.insert(steps.end(), tail.rbegin(), tail.rend());
+        }
+    }
+
+    path_result result{};
+    result.total_time = best;
+    result.total_node = (int)steps.size();
+    result.steps = std::move(steps);
+    return result;
+}
+
+/**
+ * @brief Lists the kept nodes through which an original node is reached in the compressed graph.
+ *
+ * @detailed
+ * A kept node is reached through itself (cost `0`); a removed node through both ends of its
+ * chain, at its distance along the chain (once for a loop). Every path from or to the node
+ * enters the compressed graph at one of them, except the walk between two nodes of the
+ * same chain (see `routeThroughChains()`). Without compression, only kept nodes exist.
+ *
+ * @param gdata Reference to the graph data.
+ * @param node Original node ID.
+ * @return `(kept node ID, cost)` pairs (empty for unknown nodes).
+ *
+ * @complexity
+ * - Time Complexity: O(log C) (chain lookup).
+ * - Space Complexity: O(1).
+ */
+std::vector<std::pair<int, int>> chainNodeExits(const graph& gdata, int node)
+{
+    int chain = -1;
+    size_t slot = 0;
+    std::vector<std::pair<int, int>> exits;
+    for (const auto& exit : chainExits(gdata, node, chain, slot)) {
+        exits.push_back({ exit.node, exit.cost });
+    }
+    return exits;
+}
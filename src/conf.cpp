@@ -89,6 +89,15 @@ static bool toBool(const std::string& s)
     return (s == "true");
 }
 
+/**
+ * @brief Checks if a string names a landmark selection strategy
+ *        ("farthest", "avoid", "maxcover" or "partition").
+ */
+static bool isAltStrategyString(const std::string& s)
+{
+    return (s == "farthest" || s == "avoid" || s == "maxcover" || s == "partition");
+}
+
 // ✅ function + comment verified.
 /**
  * @brief Checks if a string can represent an integer (e.g., "-5", "0", "42").
@@ -182,7 +191,22 @@ static void createConfFile(const config& conf)
     ofs << "weight=" << conf.weight << "\n";
     ofs << "personalized_weight=" << (conf.personalized_weight ? "true" : "false") << "\n";
     ofs << "log=" << (conf.log ? "true" : "false") << "\n";
+    ofs << "benchmark=" << (conf.benchmark ? "true" : "false") << "\n";
     ofs << "search_engine=" << conf.search_engine << "\n";
+    ofs << "nb_threads=" << conf.nb_threads << "\n";
+    ofs << "use_ch=" << (conf.use_ch ? "true" : "false") << "\n";
+    ofs << "cache_size=" << conf.cache_size << "\n";
+    ofs << "alt_memory=" << conf.alt_memory << "\n";
+    ofs << "alt_active=" << conf.alt_active << "\n";
+    ofs << "sssp_delta=" << conf.sssp_delta << "\n";
+    ofs << "core_percent=" << conf.core_percent << "\n";
+    ofs << "query_timeout_ms=" << conf.query_timeout_ms << "\n";
+    ofs << "compress_chains=" << (conf.compress_chains ? "true" : "false") << "\n";
+    ofs << "prune_trees=" << (conf.prune_trees ? "true" : "false") << "\n";
+    ofs << "huge_pages=" << conf.huge_pages << "\n";
+    ofs << "lock_memory=" << (conf.lock_memory ? "true" : "false") << "\n";
+    ofs << "numa_aware=" << (conf.numa_aware ? "true" : "false") << "\n";
+    ofs << "alt_strategy=" << conf.alt_strategy << "\n";
     ofs.close();
 }
 
@@ -206,7 +230,22 @@ static config loadConfFile(config conf)
         conf.personalized_weight = toBool(data["personalized_weight"]);
     }
     if (data.find("log") != data.end() && isBoolString(data["log"])) conf.log = toBool(data["log"]);
+    if (data.find("benchmark") != data.end() && isBoolString(data["benchmark"])) conf.benchmark = toBool(data["benchmark"]);
     if (data.find("search_engine") != data.end() && isIntString(data["search_engine"])) conf.search_engine = toInt(data["search_engine"]);
+    if (data.find("nb_threads") != data.end() && isIntString(data["nb_threads"])) conf.nb_threads = toInt(data["nb_threads"]);
+    if (data.find("use_ch") != data.end() && isBoolString(data["use_ch"])) conf.use_ch = toBool(data["use_ch"]);
+    if (data.find("cache_size") != data.end() && isIntString(data["cache_size"])) conf.cache_size = toInt(data["cache_size"]);
+    if (data.find("alt_memory") != data.end() && isIntString(data["alt_memory"])) conf.alt_memory = toInt(data["alt_memory"]);
+    if (data.find("alt_active") != data.end() && isIntString(data["alt_active"])) conf.alt_active = toInt(data["alt_active"]);
+    if (data.find("sssp_delta") != data.end() && isIntString(data["sssp_delta"])) conf.sssp_delta = toInt(data["sssp_delta"]);
+    if (data.find("core_percent") != data.end() && isIntString(data["core_percent"])) conf.core_percent = toInt(data["core_percent"]);
+    if (data.find("query_timeout_ms") != data.end() && isIntString(data["query_timeout_ms"])) conf.query_timeout_ms = toInt(data["query_timeout_ms"]);
+    if (data.find("compress_chains") != data.end() && isBoolString(data["compress_chains"])) conf.compress_chains = toBool(data["compress_chains"]);
+    if (data.find("prune_trees") != data.end() && isBoolString(data["prune_trees"])) conf.prune_trees = toBool(data["prune_trees"]);
+    if (data.find("huge_pages") != data.end() && isIntString(data["huge_pages"])) conf.huge_pages = std::clamp(toInt(data["huge_pages"]), 0, 2);
+    if (data.find("lock_memory") != data.end() && isBoolString(data["lock_memory"])) conf.lock_memory = toBool(data["lock_memory"]);
+    if (data.find("numa_aware") != data.end() && isBoolString(data["numa_aware"])) conf.numa_aware = toBool(data["numa_aware"]);
+    if (data.find("alt_strategy") != data.end() && isAltStrategyString(data["alt_strategy"])) conf.alt_strategy = data["alt_strategy"];
     return conf;
 }
 
@@ -221,13 +260,29 @@ void loggerConf(config& conf)
     logger("  config_file > " + conf.config_file);
     logger("  log_file > " + conf.log_file);
     logger("  alt_prep_file > " + conf.alt_prep_file);
+    logger("  poi_folder > " + conf.poi_folder);
     logger("  use_alt > " + std::to_string(conf.use_alt));
     logger("  save_alt > " + std::to_string(conf.save_alt));
     logger("  nb_alt > " + std::to_string(conf.nb_alt));
     logger("  weight > " + std::to_string(conf.weight));
     logger("  personalized_weight > " + std::to_string(conf.personalized_weight));
     logger("  log > " + std::to_string(conf.log));
+    logger("  benchmark > " + std::to_string(conf.benchmark));
     logger("  search_engine > " + std::to_string(conf.search_engine));
+    logger("  nb_threads > " + std::to_string(conf.nb_threads));
+    logger("  use_ch > " + std::to_string(conf.use_ch));
+    logger("  cache_size > " + std::to_string(conf.cache_size));
+    logger("  alt_memory > " + std::to_string(conf.alt_memory));
+    logger("  alt_active > " + std::to_string(conf.alt_active));
+    logger("  sssp_delta > " + std::to_string(conf.sssp_delta));
+    logger("  core_percent > " + std::to_string(conf.core_percent));
+    logger("  query_timeout_ms > " + std::to_string(conf.query_timeout_ms));
+    logger("  compress_chains > " + std::to_string(conf.compress_chains));
+    logger("  prune_trees > " + std::to_string(conf.prune_trees));
+    logger("  huge_pages > " + std::to_string(conf.huge_pages));
+    logger("  lock_memory > " + std::to_string(conf.lock_memory));
+    logger("  numa_aware > " + std::to_string(conf.numa_aware));
+    logger("  alt_strategy > " + conf.alt_strategy);
 }
 
 // ✅ function + comment verified.
@@ -301,6 +356,7 @@ bool updateMapPath(config& conf, std::string map_path)
  * │   ├── log.txt           # Log file
  * │   ├── prep/
  * │   │   ├── alt.json      # ALT preprocessing data (optional)
+ * │   │   ├── poi/          # Named target sets for nearest queries (<name>.txt, optional)
  *
  * Edge Cases Handled:
  * - If a configuration file already exists and is valid, it is reused.
@@ -343,6 +399,8 @@ config getConfiguration(config conf)
     ensureDirectory(preprocess_folder);
 
     conf.alt_prep_file = preprocess_folder + "/alt.bin";
+    conf.poi_folder = preprocess_folder + "/poi";
+    ensureDirectory(conf.poi_folder);
 
     if (fileExists(conf.config_file)) 
     {
@@ -373,12 +431,22 @@ config getConfiguration(config conf)
 
     std::cout << "\n  ~ process\n" << std::flush;
 
-    conf.search_engine = getOneOrTwo("\n  > what type of search engine do you want to use? ('1' for unidirectional - '2' for bidirectional): ");
+    conf.search_engine = getChoice("\n  > what type of search engine do you want to use? ('1' for unidirectional - '2' for bidirectional - '3' for core-ALT - '4' for CCH, live travel time updates): ", 4);
 
-    bool use_alt = getYesNo("\n  > do you want to use the ALT pre-processing method (1min ~ 10min)? (y/n): ");
-    if (use_alt) {
+    bool use_alt = (conf.search_engine <= 2) && getYesNo("\n  > do you want to use the ALT pre-processing method (1min ~ 10min)? (y/n): ");
+    if (conf.search_engine == 3) {
+        conf.use_alt = false;
+        conf.core_percent = getInteger("\n  > which percentage of the nodes should stay uncontracted in the core? (e.g. 5): ");
+        conf.nb_alt = getInteger("\n  > how many landmarks do you want to select inside the core? (e.g. 16): ");
+    }
+    else if (use_alt) {
         conf.use_alt = true;
         conf.nb_alt = getInteger("\n  > how many landmarks do you want to use? (e.g., 10): ");
+        static const char* strategies[] = { "farthest", "avoid", "maxcover", "partition" };
+        conf.alt_strategy = strategies[getChoice("\n  > how should landmarks be selected? ('1' farthest - '2' avoid - '3' maxcover - '4' partition, parallel): ", 4) - 1];
+        conf.alt_active = getInteger("\n  > how many landmarks should each query evaluate (the best ones for its start/end)? (e.g. 4 - '0' for all): ");
+        conf.alt_memory = getInteger("\n  > how much memory (in MB) can the landmark distances use? (16-bit compression is used above it - '0' for no limit): ");
+        conf.sssp_delta = getInteger("\n  > which bucket width should the parallel landmark searches use (delta-stepping)? ('0' for automatic): ");
         std::cout << "\n" << std::flush;
         bool backup_alt = getYesNo("  > do you want to backup this pre-process for future use? (this will consume time/storage) (y/n): ");
         conf.save_alt = backup_alt;
@@ -387,6 +455,18 @@ config getConfiguration(config conf)
         conf.use_alt = false;
     }
 
+    conf.prune_trees = getYesNo("\n  > do you want to remove the dead-end trees from the search graph (smaller search graph, route queries only for removed nodes)? (y/n): ");
+
+    conf.compress_chains = getYesNo("\n  > do you want to collapse chains of degree-2 nodes into single edges (smaller search graph, route queries only for removed nodes)? (y/n): ");
+
+    conf.use_ch = getYesNo("\n  > do you want to build a contraction hierarchy (faster one-to-all and ALT pre-processing, longer startup)? (y/n): ");
+
+    conf.huge_pages = getChoice("\n  > how should the graph and search buffers be backed? ('1' default pages - '2' transparent huge pages - '3' reserved huge pages, fewer TLB misses): ", 3) - 1;
+
+    conf.lock_memory = getYesNo("\n  > do you want to pre-fault and lock the graph and search buffers in RAM (no page faults during queries, needs RLIMIT_MEMLOCK)? (y/n): ");
+
+    conf.numa_aware = getYesNo("\n  > do you want to replicate the graph on each NUMA node and pin the workers next to it (multi-socket servers)? (y/n): ");
+
     double weight = getPercentage("\n  > what maximum percentage above the shortest path duration are you willing to allow? (e.g. 10 for 10%) (min: 0 / max: 100): ");
     conf.weight = weight;
 
@@ -395,11 +475,19 @@ config getConfiguration(config conf)
     bool personalized_weight = getYesNo("\n  > do you authorize the user to, optionally, set a personalized heuristic percentage when making query (y/n): ");
     conf.personalized_weight = personalized_weight;
 
+    conf.nb_threads = getInteger("\n  > how many worker threads should batch queries (e.g. matrix) use? ('0' for all available threads): ");
+
+    conf.cache_size = getInteger("\n  > how much memory (in MB) should the result cache use for repeated queries? ('0' to disable it): ");
+
+    conf.query_timeout_ms = getInteger("\n  > after how many milliseconds should a route query be cancelled (503)? ('0' for no limit): ");
+
     std::cout << "\n  ~ other\n" << std::flush;
 
     bool log = getYesNo("\n  > do you want to get debugging log (written inside a .txt) (y/n) ? : ");
     conf.log = log;
 
+    conf.benchmark = getYesNo("\n  > do you want to run the performance benchmarks at startup (slower startup, results printed and logged)? (y/n): ");
+
     std::cout << "\n" << std::flush;
 
     console("success", "configuration completed! saving it.");
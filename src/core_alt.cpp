@@ -0,0 +1,347 @@
+﻿#include "incl.h"
+#include "decl.h"
+#include "search.h"
+
+namespace {
+    /**
+     * @brief Runs Dijkstra inside the core from one core row.
+     *
+     * @return Distances indexed by core row (`-1` = unreachable).
+     */
+    std::vector<int> coreSingleSource(const core_hierarchy& core, size_t source_row)
+    {
+        std::vector<int> dist(core.core_nodes.size(), -1);
+        using state = std::pair<int, size_t>;
+        std::priority_queue<state, std::vector<state>, std::greater<state>> pq;
+        dist[source_row] = 0;
+        pq.push({ 0, source_row });
+
+        while (!pq.empty()) {
+            auto [cur_dist, cur_row] = pq.top();
+            pq.pop();
+            if (dist[cur_row] != cur_dist) {
+                continue;
+            }
+            size_t cur_idx = (size_t)core.core_nodes[cur_row];
+            for (size_t i = core.offsets[cur_idx]; i < core.offsets[cur_idx + 1]; ++i) {
+                size_t nbr_row = (size_t)core.core_id[core.edges[i].target];
+                int nd = cur_dist + core.edges[i].weight;
+                if (dist[nbr_row] < 0 || nd < dist[nbr_row]) {
+                    dist[nbr_row] = nd;
+                    pq.push({ nd, nbr_row });
+                }
+            }
+        }
+        return dist;
+    }
+
+    /**
+     * @brief Appends the original nodes of the edge `from -> to` (without `from`) to `out`.
+     *
+     * @detailed
+     * A shortcut bypassing `m` was built from two edges of `m` (towards `from` and `to`) that
+     * are still stored in `m`'s upward list; they are unpacked recursively (explicit stack).
+     */
+    void appendUnpackedEdge(const core_hierarchy& core, int from, int to, int weight, int middle, std::vector<int>& out)
+    {
+        struct pending { int from, to, weight, middle; };
+        std::vector<pending> stack{ { from, to, weight, middle } };
+
+        while (!stack.empty()) {
+            pending cur = stack.back();
+            stack.pop_back();
+            if (cur.middle < 0) {
+                out.push_back(cur.to);
+                continue;
+            }
+
+            const size_t m = (size_t)cur.middle;
+            const core_hierarchy::core_edge* first = nullptr;
+            const core_hierarchy::core_edge* second = nullptr;
+            for (size_t i = core.offsets[m]; i < core.offsets[m + 1] && !second; ++i) {
+                if (core.edges[i].target != cur.from) {
+                    continue;
+                }
+                for (size_t j = core.offsets[m]; j < core.offsets[m + 1]; ++j) {
+                    if (core.edges[j].target == cur.to && core.edges[i].weight + core.edges[j].weight == cur.weight) {
+                        first = &core.edges[i];
+                        second = &core.edges[j];
+                        break;
+                    }
+                }
+            }
+            if (!second) {
+                out.push_back(cur.to);      // cannot happen on a consistent hierarchy
+                continue;
+            }
+            stack.push_back({ cur.middle, cur.to, second->weight, second->middle });
+            stack.push_back({ cur.from, cur.middle, first->weight, first->middle });
+        }
+    }
+}
+
+/**
+ * @brief Prepares the Core-ALT engine: partial contraction, then landmarks on the core only.
+ *
+ * @detailed
+ * Functionality:
+ * - Keeps `conf.core_percent` % of the nodes (the most important ones) uncontracted with
+ *   `buildContractedCore()`.
+ * - Selects `conf.nb_alt` landmarks (16 if unset) inside the core with the farthest-node
+ *   method, running Dijkstra on the core graph (edges and shortcuts between core nodes).
+ * - Stores one landmark row per core node, so the table is `100 / core_percent` times
+ *   smaller than full-graph ALT with the same number of landmarks.
+ *
+ * @param gdata Reference to the graph data structure.
+ * @param conf Reference to the configuration settings (core size, landmark count).
+ *
+ * @complexity
+ * - Time Complexity: contraction cost + O(L × E_c log V_c) on the core.
+ * - Space Complexity: O(V + E + S + V_c × L).
+ */
+void preprocessCoreAlt(graph& gdata, config& conf)
+{
+    const size_t n = gdata.index_to_node.size();
+    if (n == 0) {
+        return;
+    }
+    int percent = std::clamp(conf.core_percent, 1, 100);
+    size_t core_size = std::max<size_t>(1, n * (size_t)percent / 100);
+    buildContractedCore(gdata, core_size);
+
+    auto& core = gdata.core;
+    auto& table = core.landmarks;
+    const size_t rows = core.core_nodes.size();
+    const size_t count = std::min(rows, (size_t)((conf.nb_alt > 0) ? conf.nb_alt : 16));
+    table.assign(rows, count, -1);
+
+    std::vector<int> md(rows, std::numeric_limits<int>::max());
+    size_t next_row = 0;
+    for (size_t r = 1; r < rows; ++r) {
+        if (gdata.index_to_node[core.core_nodes[r]] < gdata.index_to_node[core.core_nodes[next_row]]) {
+            next_row = r;
+        }
+    }
+    for (size_t l = 0; l < count; ++l) {
+        std::vector<int> dist = coreSingleSource(core, next_row);
+        setLandmarkColumn(table, l, dist);
+        table.landmark_nodes[l] = gdata.index_to_node[core.core_nodes[next_row]];
+        md[next_row] = -1;
+
+        int mx = -1;
+        for (size_t r = 0; r < rows; ++r) {
+            if (md[r] >= 0 && dist[r] >= 0 && dist[r] < md[r]) {
+                md[r] = dist[r];
+            }
+            if (md[r] > mx) {
+                mx = md[r];
+                next_row = r;
+            }
+        }
+        if (mx < 0) {
+            table.resizeLandmarks(l + 1);
+            break;
+        }
+    }
+    core.built = true;
+
+    double core_mb = (double)table.byteSize() / 1048576.0;
+    double full_mb = (double)landmark_table::estimateBytes(n, table.landmark_count, false) / 1048576.0;
+    std::ostringstream output_stream;
+    output_stream << std::fixed << std::setprecision(2) << "core-ALT ready: " << table.landmark_count << " landmarks on "
+        << rows << " core nodes, " << core_mb << " MB of landmark distances (full-graph ALT: " << full_mb << " MB).";
+    console("success", output_stream.str());
+    logger(output_stream.str());
+}
+
+/**
+ * @brief Finds the shortest path with Core-ALT: contraction outside the core, ALT inside it.
+ *
+ * @detailed
+ * Steps:
+ * 1. Upward searches: plain Dijkstra from the start and from the end over upward edges only.
+ *    Core nodes reached are recorded as entry (resp. exit) points and are not expanded.
+ *    Nodes reached by both searches give a first candidate `μ` (paths that never enter the core).
+ * 2. Core search: A* over the core graph, seeded with every entry point at its upward
+ *    distance. Reaching an exit point `x` gives the candidate `g(x) + d_back(x)`.
+ *    The search stops once the smallest key reaches `μ`.
+ * 3. The path is rebuilt from both parent chains and every shortcut is unpacked.
+ *
+ * Heuristic:
+ * - Landmark distances only exist for core nodes, so the target is replaced by its closest
+ *   exit point `p` (proxy): `h(v) = max(0, LB(v, p) - d_back(p))`. By the triangle inequality
+ *   `d(v, t) >= d(v, p) - d(p, t)`, so `h` stays admissible and consistent.
+ * - `weight > 1.0` inflates `h` for a faster, possibly suboptimal, search.
+ *
+ * The core search polls `buffers.cancel` and returns "no path" once it expires
+ * (`buffers.cancel.cancelled` is set).
+ *
+ * @param gdata Reference to the graph data (with `gdata.core` built).
+ * @param buffers Reference to `search_buffers` for optimized memory management.
+ * @param start_node The starting node.
+ * @param end_node The target node.
+ * @param weight Heuristic weight (`1.0` = guaranteed shortest path).
+ * @param distance_only If `true`, only `total_time` is computed (`total_node = 0`, no `steps`).
+ * @return A `path_result` structure containing the shortest path details.
+ *
+ * @complexity
+ * - Time Complexity: O(U log U + E'_c log V'_c), with `U` the upward search spaces and
+ *   `V'_c`/`E'_c` the explored part of the core.
+ * - Space Complexity: O(V) for the search buffers.
+ */
+path_result findShortestPathCoreAlt(const graph& gdata, search_buffers& buffers, int start_node, int end_node, double weight, bool distance_only)
+{
+    const auto& core = gdata.core;
+    auto it_start = gdata.node_to_index.find(start_node);
+    auto it_end = gdata.node_to_index.find(end_node);
+    if (!core.built || it_start == gdata.node_to_index.end() || it_end == gdata.node_to_index.end()) {
+        return { -1, 0, {} };
+    }
+    const size_t start_idx = it_start->second;
+    const size_t end_idx = it_end->second;
+    const int inf = std::numeric_limits<int>::max();
+
+    buffers.current_search_id++;
+
+    using pq_item = std::pair<int, size_t>;
+    std::priority_queue<pq_item, std::vector<pq_item>, std::greater<pq_item>> open_list;
+
+    auto upwardSearch = [&](size_t source, bool forward, std::vector<size_t>& settled, std::vector<size_t>& core_points) {
+        auto getDist = [&](size_t idx) { return forward ? getDistFromStart(buffers, idx) : getDistFromEnd(buffers, idx); };
+        forward ? setDistFromStart(buffers, source, 0) : setDistFromEnd(buffers, source, 0);
+        open_list.push({ 0, source });
+        while (!open_list.empty()) {
+            auto [cur_dist, cur_idx] = open_list.top();
+            open_list.pop();
+            if (getDist(cur_idx) != cur_dist) {
+                continue;
+            }
+            settled.push_back(cur_idx);
+            if (core.core_id[cur_idx] >= 0) {
+                core_points.push_back(cur_idx);
+                continue;
+            }
+            for (size_t i = core.offsets[cur_idx]; i < core.offsets[cur_idx + 1]; ++i) {
+                size_t nbr_idx = (size_t)core.edges[i].target;
+                int nd = cur_dist + core.edges[i].weight;
+                int old = getDist(nbr_idx);
+                if (old < 0 || nd < old) {
+                    if (forward) {
+                        setDistFromStart(buffers, nbr_idx, nd);
+                        setParentForward(buffers, nbr_idx, { (int)cur_idx, (int)i });
+                    }
+                    else {
+                        setDistFromEnd(buffers, nbr_idx, nd);
+                        setParentBackward(buffers, nbr_idx, { (int)cur_idx, (int)i });
+                    }
+                    open_list.push({ nd, nbr_idx });
+                }
+            }
+        }
+    };
+
+    std::vector<size_t> settled_forward, settled_backward, entries, exits;
+    upwardSearch(start_idx, true, settled_forward, entries);
+    upwardSearch(end_idx, false, settled_backward, exits);
+
+    int best = inf;
+    size_t meet_idx = 0;
+    for (size_t idx : settled_backward) {
+        int df = getDistFromStart(buffers, idx);
+        if (df >= 0 && df + getDistFromEnd(buffers, idx) < best) {
+            best = df + getDistFromEnd(buffers, idx);
+            meet_idx = idx;
+        }
+    }
+
+    if (!entries.empty() && !exits.empty()) {
+        size_t proxy = exits.front();
+        for (size_t idx : exits) {
+            if (getDistFromEnd(buffers, idx) < getDistFromEnd(buffers, proxy)) {
+                proxy = idx;
+            }
+        }
+        const size_t proxy_row = (size_t)core.core_id[proxy];
+        const int proxy_dist = getDistFromEnd(buffers, proxy);
+        auto heuristic = [&](size_t idx) {
+            int h = getHForward(buffers, idx);
+            if (h < 0) {
+                int bound = landmarkLowerBound(core.landmarks, (size_t)core.core_id[idx], proxy_row) - proxy_dist;
+                h = (int)(weight * std::max(0, bound));
+                setHForward(buffers, idx, h);
+            }
+            return h;
+        };
+
+        for (size_t idx : entries) {
+            open_list.push({ getDistFromStart(buffers, idx) + heuristic(idx), idx });
+        }
+        size_t polls = 0;
+        while (!open_list.empty()) {
+            auto [cur_f, cur_idx] = open_list.top();
+            open_list.pop();
+            int cur_g = getDistFromStart(buffers, cur_idx);
+            if (cur_g + heuristic(cur_idx) != cur_f) {
+                continue;
+            }
+            if (cur_f >= best) {
+                break;
+            }
+            if (buffers.cancel.poll(polls)) {
+                buffers.cancel.cancelled = true;
+                return { -1, 0, {} };
+            }
+            int db = getDistFromEnd(buffers, cur_idx);
+            if (db >= 0 && cur_g + db < best) {
+                best = cur_g + db;
+                meet_idx = cur_idx;
+            }
+            for (size_t i = core.offsets[cur_idx]; i < core.offsets[cur_idx + 1]; ++i) {
+                size_t nbr_idx = (size_t)core.edges[i].target;
+                int nd = cur_g + core.edges[i].weight;
+                int old = getDistFromStart(buffers, nbr_idx);
+                if (old < 0 || nd < old) {
+                    setDistFromStart(buffers, nbr_idx, nd);
+                    setParentForward(buffers, nbr_idx, { (int)cur_idx, (int)i });
+                    open_list.push({ nd + heuristic(nbr_idx), nbr_idx });
+                }
+            }
+        }
+    }
+
+    if (best == inf) {
+        return { -1, 0, {} };
+    }
+    if (distance_only) {
+        return { best, 0, {} };
+    }
+
+    std::vector<std::pair<int, int>> forward_edges;      // (from, edge position), meet -> start
+    for (size_t cur = meet_idx; cur != start_idx;) {
+        auto par = getParentForward(buffers, cur);
+        forward_edges.push_back(par);
+        cur = (size_t)par.first;
+    }
+    std::reverse(forward_edges.begin(), forward_edges.end());
+
+    std::vector<int> steps{ (int)start_idx };
+    for (const auto& [from, pos] : forward_edges) {
+        const auto& e = core.edges[pos];
+        appendUnpackedEdge(core, from, e.target, e.weight, e.middle, steps);
+    }
+    for (size_t cur = meet_idx; cur != end_idx;) {
+        auto par = getParentBackward(buffers, cur);
+        const auto& e = core.edges[par.second];
+        appendUnpackedEdge(core, (int)cur, par.first, e.weight, e.middle, steps);
+        cur = (size_t)par.first;
+    }
+    for (auto& idx : steps) {
+        idx = gdata.index_to_node[idx];
+    }
+
+    path_result result{};
+    result.total_time = best;
+    result.total_node = (int)steps.size();
+    result.steps = std::move(steps);
+    return result;
+}
@@ -1,4 +1,4 @@
-#ifndef DECL_H
+﻿#ifndef DECL_H
 #define DECL_H
 
 #include "incl.h"
@@ -28,6 +28,7 @@ struct config
     std::string config_file{};
     std::string log_file{};
     std::string alt_prep_file{};
+    std::string poi_folder{};
 
     bool use_alt = false;
     bool save_alt = false;
@@ -37,12 +38,425 @@ struct config
     bool personalized_weight = false;
 
     bool log = false;
+    bool benchmark = false;
 
     int search_engine = 1;
 
+    int nb_threads = 0;
+
+    bool use_ch = false;
+
+    int cache_size = 64;
+    int alt_memory = 0;
+    int alt_active = 0;
+    int sssp_delta = 0;
+    int core_percent = 5;
+    int query_timeout_ms = 0;
+    bool compress_chains = false;
+    bool prune_trees = false;
+    int huge_pages = 0;
+    bool lock_memory = false;
+    bool numa_aware = false;
+    std::string alt_strategy = "farthest";
+
     config() = default;
 };
 
+/**
+ * @brief Minimal allocator returning memory aligned on `Align` bytes.
+ *
+ * Used for the flat tables read by SIMD kernels, so every row starts on a
+ * vector-register (or cache-line) boundary.
+ */
+template <typename T, size_t Align>
+struct aligned_allocator
+{
+    using value_type = T;
+
+    template <typename U>
+    struct rebind { using other = aligned_allocator<U, Align>; };
+
+    aligned_allocator() noexcept = default;
+    template <typename U>
+    aligned_allocator(const aligned_allocator<U, Align>&) noexcept {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+    }
+    void deallocate(T* p, size_t) noexcept {
+        ::operator delete(p, std::align_val_t(Align));
+    }
+
+    template <typename U>
+    bool operator==(const aligned_allocator<U, Align>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const aligned_allocator<U, Align>&) const noexcept { return false; }
+};
+
+void* hugePageAllocate(size_t bytes);
+void hugePageDeallocate(void* ptr, size_t bytes) noexcept;
+
+/**
+ * @brief Allocator of the large, hot arrays (CSR, landmark rows, search buffers).
+ *
+ * Blocks of 2 MB or more are mapped on huge page boundaries and backed according to
+ * `conf.huge_pages` (see `configureHugePages()`), which cuts the TLB misses of the random
+ * accesses made by every search. Smaller blocks are 64-byte aligned heap blocks.
+ */
+template <typename T>
+struct huge_page_allocator
+{
+    using value_type = T;
+
+    huge_page_allocator() noexcept = default;
+    template <typename U>
+    huge_page_allocator(const huge_page_allocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(hugePageAllocate(n * sizeof(T)));
+    }
+    void deallocate(T* p, size_t n) noexcept {
+        hugePageDeallocate(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const huge_page_allocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const huge_page_allocator<U>&) const noexcept { return false; }
+};
+
+template <typename T>
+using huge_vector = std::vector<T, huge_page_allocator<T>>;
+
+/**
+ * @brief Huge page coverage of the blocks returned by `hugePageAllocate()` (see `storePerf()`).
+ */
+struct huge_page_report
+{
+    size_t mapped_bytes = 0;        // bytes in 2 MB aligned mappings
+    size_t huge_bytes = 0;          // of which backed by huge pages (transparent or explicit)
+    size_t explicit_bytes = 0;      // of which from the MAP_HUGETLB pool
+    size_t locked_bytes = 0;        // of which pre-faulted and locked
+    size_t regions = 0;
+    size_t hugetlb_fallbacks = 0;   // MAP_HUGETLB requests served by transparent pages
+    size_t lock_failures = 0;       // mlock refused (RLIMIT_MEMLOCK)
+};
+
+/**
+ * @brief Stores the landmark distances as one flat, 64-byte aligned, node-major matrix.
+ *
+ * Row `idx` holds `d_L(idx)` for every landmark `L` (`-1` if unreachable) and is padded
+ * with zeros up to `stride` values (a multiple of the AVX2 width), so the SIMD kernels
+ * never need a scalar tail and padding never changes the bound.
+ *
+ * In compact mode, rows are stored in `data16` as `floor(d_L / scale[L])` (`0xFFFF` if
+ * unreachable), with one scale per landmark (`1` when the landmark fits in 16 bits, so
+ * it stays exact). The kernels then return `scale * (|dq| - 1) + 1`, which never exceeds
+ * the real `|d_L(a) - d_L(b)|`: the heuristic stays admissible at half the memory.
+ *
+ * A table loaded from a version 3 ALT file points `mapped_rows` at the matrix inside the
+ * mapped file (same layout, copy-on-write), so nothing is copied on load.
+ *
+ * `slack` is subtracted from every bound while live weight decreases have not been repaired
+ * (see `weight_updates`): the rows then describe a metric up to `slack` longer than the
+ * current one, and `bound - slack` is still a lower bound.
+ */
+struct landmark_table
+{
+    static const size_t lane_width = 8;
+    static const uint16_t compact_unreachable = 0xFFFF;
+
+    size_t node_count = 0;
+    size_t landmark_count = 0;
+    size_t stride = 0;
+    bool compact = false;
+    int slack = 0;
+
+    huge_vector<int> data;                                      // full rows (compact = false)
+    huge_vector<uint16_t> data16;                               // quantised rows (compact = true)
+    std::vector<int, aligned_allocator<int, 64>> scale;         // per landmark (size stride, padding 1)
+    std::vector<int> landmark_nodes;                            // node ID of each landmark (-1 = not set)
+
+    std::shared_ptr<void> mapping;                              // keeps a mapped ALT file alive
+    void* mapped_rows = nullptr;                                // rows inside the mapping (replaces data / data16)
+    size_t mapped_bytes = 0;
+
+    static size_t paddedStride(size_t nb_landmarks) {
+        return (nb_landmarks + lane_width - 1) / lane_width * lane_width;
+    }
+    static size_t estimateBytes(size_t nodes, size_t nb_landmarks, bool compact_rows) {
+        return nodes * paddedStride(nb_landmarks) * (compact_rows ? sizeof(uint16_t) : sizeof(int));
+    }
+
+    void assign(size_t nodes, size_t nb_landmarks, int value, bool compact_rows = false) {
+        clear();
+        node_count = nodes;
+        landmark_count = nb_landmarks;
+        stride = paddedStride(nb_landmarks);
+        compact = compact_rows;
+        scale.assign(stride, 1);
+        landmark_nodes.assign(nb_landmarks, -1);
+        if (compact) {
+            uint16_t fill = (value < 0) ? compact_unreachable : (uint16_t)std::min(value, 0xFFFE);
+            data16.assign(nodes * stride, 0);
+            for (size_t idx = 0; idx < nodes; ++idx) {
+                std::fill_n(data16.data() + idx * stride, nb_landmarks, fill);
+            }
+        }
+        else {
+            data.assign(nodes * stride, 0);
+            for (size_t idx = 0; idx < nodes; ++idx) {
+                std::fill_n(data.data() + idx * stride, nb_landmarks, value);
+            }
+        }
+    }
+    void resizeLandmarks(size_t nb_landmarks) {   // keeps the first columns, new ones are unreachable
+        landmark_table resized;
+        resized.assign(node_count, nb_landmarks, -1, compact);
+        size_t kept = std::min(landmark_count, nb_landmarks);
+        for (size_t idx = 0; idx < node_count; ++idx) {
+            if (compact) {
+                std::copy_n(row16(idx), kept, resized.row16(idx));
+            }
+            else {
+                std::copy_n(row(idx), kept, resized.row(idx));
+            }
+        }
+        std::copy_n(scale.begin(), kept, resized.scale.begin());
+        std::copy_n(landmark_nodes.begin(), kept, resized.landmark_nodes.begin());
+        *this = std::move(resized);
+    }
+    void attachMapped(std::shared_ptr<void> map, void* rows, size_t nodes, size_t nb_landmarks, bool compact_rows) {
+        clear();
+        node_count = nodes;
+        landmark_count = nb_landmarks;
+        stride = paddedStride(nb_landmarks);
+        compact = compact_rows;
+        scale.assign(stride, 1);
+        landmark_nodes.assign(nb_landmarks, -1);
+        mapping = std::move(map);
+        mapped_rows = rows;
+        mapped_bytes = nodes * stride * (compact ? sizeof(uint16_t) : sizeof(int));
+    }
+    void clear() {
+        node_count = 0;
+        landmark_count = 0;
+        stride = 0;
+        compact = false;
+        slack = 0;
+        data = {};
+        data16 = {};
+        scale = {};
+        landmark_nodes = {};
+        mapping.reset();
+        mapped_rows = nullptr;
+        mapped_bytes = 0;
+    }
+    bool empty() const { return landmark_count == 0; }
+    size_t nodeCount() const { return node_count; }
+    size_t byteSize() const {
+        return data.capacity() * sizeof(int) + data16.capacity() * sizeof(uint16_t) + scale.capacity() * sizeof(int) + mapped_bytes;
+    }
+    int* row(size_t idx) { return (mapped_rows ? static_cast<int*>(mapped_rows) : data.data()) + idx * stride; }
+    const int* row(size_t idx) const { return (mapped_rows ? static_cast<const int*>(mapped_rows) : data.data()) + idx * stride; }
+    uint16_t* row16(size_t idx) { return (mapped_rows ? static_cast<uint16_t*>(mapped_rows) : data16.data()) + idx * stride; }
+    const uint16_t* row16(size_t idx) const { return (mapped_rows ? static_cast<const uint16_t*>(mapped_rows) : data16.data()) + idx * stride; }
+    int value(size_t idx, size_t landmark) const {     // distance (rounded down if compact), -1 if unreachable
+        if (!compact) {
+            return row(idx)[landmark];
+        }
+        uint16_t q = row16(idx)[landmark];
+        return (q == compact_unreachable) ? -1 : (int)q * scale[landmark];
+    }
+};
+
+/**
+ * @brief Stores a contraction hierarchy built on top of the CSR graph.
+ *
+ * Nodes are contracted by increasing importance; every contracted node keeps its
+ * edges towards the nodes still present at that time (its "upward" edges), and
+ * shortcuts remember the node they bypass so they can be unpacked. Nodes are stored
+ * by sweep position (`0` = most important node), so the upward graph is also the
+ * reversed downward graph used by the PHAST sweep.
+ */
+struct contraction_hierarchy
+{
+    struct ch_edge {
+        int target;     // sweep position of the higher-ranked endpoint
+        int weight;
+        int middle;     // node index bypassed by the shortcut (-1 for original edges)
+    };
+
+    std::vector<int> node_at_pos;     // node index at each sweep position
+    std::vector<int> pos_of;          // sweep position of each node index
+
+    std::vector<size_t> up_offsets;   // CSR by sweep position (size N + 1)
+    std::vector<ch_edge> up_edges;
+
+    size_t shortcut_count = 0;
+    bool built = false;
+};
+
+/**
+ * @brief Travel times of a customized CCH (one entry per upward arc).
+ *
+ * `input` holds the smallest graph edge weight of each arc (infinity for fill-in arcs) and
+ * `weight` the customized weight; an arc with `weight == input` is an original edge.
+ */
+struct cch_metric
+{
+    std::vector<int> input;
+    std::vector<int> weight;
+};
+
+/**
+ * @brief Stores a customizable contraction hierarchy (CCH).
+ *
+ * The order (nested dissection) and the chordal upward graph only depend on the topology;
+ * travel times live in `metric`, which a customization replaces as a whole. Arcs are
+ * stored by node index and sorted by rank of their higher endpoint.
+ */
+struct customizable_hierarchy
+{
+    std::vector<int> rank;                              // elimination rank of each node index
+    std::vector<int> etree_parent;                      // elimination tree parent (-1 = root)
+
+    std::vector<size_t> up_offsets;                     // CSR by node index (size N + 1)
+    std::vector<int> up_targets;                        // higher neighbour of each arc
+    std::vector<size_t> down_offsets;                   // CSR by node index (size N + 1)
+    std::vector<std::pair<int, size_t>> down_arcs;      // (lower neighbour, arc towards this node)
+    std::vector<std::vector<int>> levels;               // nodes customizable in parallel
+
+    // swapped with std::atomic_store while queries run (they hold the previous one).
+    mutable std::shared_ptr<const cch_metric> metric;
+    bool built = false;
+};
+
+/**
+ * @brief Stores the partial contraction used by the Core-ALT engine.
+ *
+ * The least important nodes are contracted; the remaining "core" keeps the edges and
+ * shortcuts between core nodes, and the landmark distances are only stored for core nodes
+ * (`landmarks` row `r` = node index `core_nodes[r]`).
+ */
+struct core_hierarchy
+{
+    struct core_edge {
+        int target;     // node index
+        int weight;
+        int middle;     // node index bypassed by the shortcut (-1 for original edges)
+    };
+
+    std::vector<int> core_id;         // core row of each node index (-1 = contracted)
+    std::vector<int> core_nodes;      // node index of each core row
+
+    std::vector<size_t> offsets;      // CSR by node index (size N + 1): upward edges of
+    std::vector<core_edge> edges;     // contracted nodes, core edges of core nodes
+
+    landmark_table landmarks;
+    size_t shortcut_count = 0;
+    bool built = false;
+};
+
+/**
+ * @brief Stores a named set of target nodes (e.g. depots) for nearest-target queries.
+ *
+ * Loaded from `prep/poi/<name>.txt`. The membership flags let a search recognise a
+ * member in O(1) when it settles a node.
+ *
+ * Members removed by `prune_trees` / `compress_chains` are reached through their exits
+ * (`searchGraphExits()`): `reduced` lists them under each exit index, and the exits are
+ * part of `nodes`, so the ALT bound covers them too. The exit costs are not stored, since
+ * live updates can change the chain offsets.
+ *
+ * `alt_min` / `alt_max` hold, per landmark, the range of `d_L` over `nodes` (`-1` when a
+ * node is unreachable from it); they follow the landmark rows (`refreshPoiBounds()`).
+ */
+struct poi_set
+{
+    std::string name;
+    std::vector<int> nodes;                      // member node indices (and exits of reduced members)
+    std::vector<bool> is_member;                 // membership flag per node index
+    std::unordered_map<size_t, std::vector<int>> reduced;   // exit index -> reduced member IDs
+    std::vector<int> alt_min;                    // per landmark, empty without full landmark rows
+    std::vector<int> alt_max;
+};
+
+/**
+ * @brief Degree-2 chains collapsed into single edges (see `compressChains()`).
+ *
+ * Chain `c` runs from `from[c]` to `to[c]` (kept node IDs) through the removed nodes
+ * `interior[first[c] .. first[c + 1])`, in that order; `offset` holds the distance of each
+ * removed node from `from[c]` and `length[c]` is the weight of the collapsed edge.
+ * `edge_chain` gives the chain of every CSR entry of the compressed graph (`-1` = original edge),
+ * and `chains_at` the chains ending at each kept node (loops included, which have no edge).
+ */
+struct chain_compression
+{
+    bool built = false;
+    std::vector<int> from;
+    std::vector<int> to;
+    std::vector<int> length;
+    std::vector<size_t> first;                   // chain count + 1 entries
+    std::vector<int> interior;                   // removed node IDs, chain after chain
+    std::vector<int> offset;                     // distance from `from` of each removed node
+    std::unordered_map<int, size_t> position;    // removed node ID -> slot in `interior`
+    std::vector<int> edge_chain;
+    std::unordered_map<int, std::vector<int>> chains_at;    // kept node ID -> chains ending there
+    size_t original_nodes = 0;
+    size_t original_edges = 0;
+};
+
+/**
+ * @brief Trees hanging off the 2-core, removed from the search graph (see `pruneTrees()`).
+ *
+ * Pruned node `s` (slot in these vectors) is `node[s]`; `parent[s]` is the slot of the next
+ * node towards the core (`-1` when it is the attachment itself), `attachment[s]` the core
+ * node ID its tree hangs from, `dist[s]` the distance to it and `depth[s]` the number of
+ * tree edges to it. `hanging` lists the slots of the trees attached to each node, parents first.
+ */
+struct tree_pruning
+{
+    bool built = false;
+    std::vector<int> node;
+    std::vector<int> parent;
+    std::vector<int> attachment;
+    std::vector<int> dist;
+    std::vector<int> depth;
+    std::unordered_map<int, size_t> position;    // pruned node ID -> slot
+    std::unordered_map<int, std::vector<int>> hanging;      // attachment node ID -> slots
+    size_t original_nodes = 0;
+    size_t original_edges = 0;
+};
+
+/**
+ * @brief One live travel time change: every edge between `from` and `to` now costs `weight`.
+ */
+struct edge_update
+{
+    int from;
+    int to;
+    int weight;
+};
+
+/**
+ * @brief Tracks the travel time changes applied since the graph was loaded.
+ *
+ * `alt_weights` remembers, for each changed edge (CSR position in the list of its lower
+ * index endpoint), the weight the landmark rows were computed with. `decrease_total` is the
+ * sum of `max(0, alt_weight - weight)` over those edges: a simple path is at most that much
+ * cheaper than under the landmark metric, which gives `landmark_table::slack`.
+ */
+struct weight_updates
+{
+    uint64_t epoch = 0;                          // applied update batches
+    size_t increases = 0;
+    size_t decreases = 0;
+    size_t repairs = 0;
+    int64_t decrease_total = 0;
+    std::unordered_map<size_t, int> alt_weights; // CSR position -> weight seen by the landmarks
+};
+
 /**
  * @brief Represents a graph structure with edges lists and landmarks.
  *
@@ -61,10 +475,42 @@ struct graph
         int weight;
     };
 
-    std::vector<size_t> offsets;
-    std::vector<edge_repr> edges;
+    huge_vector<size_t> offsets;      // CSR by node index (size N + 1, offsets[N] = edges.size())
+    huge_vector<edge_repr> edges;
+
+    tree_pruning trees;
+
+    chain_compression chains;
+
+    landmark_table dist_landmark;
+
+    contraction_hierarchy ch;
+
+    core_hierarchy core;
 
-    std::vector<std::vector<int>> dist_landmark;
+    customizable_hierarchy cch;
+
+    weight_updates updates;
+
+    std::unordered_map<std::string, poi_set> poi_sets;
+};
+
+/**
+ * @brief Placement of the graph and of the pool workers on a multi-socket machine.
+ *
+ * Built by `detectNumaTopology()` (sysfs) and `setupNumaPlacement()`. In replicated mode,
+ * each node other than the first one has its own copy of the read-only arrays used by
+ * the pool engines, and every worker reads the copy of the node it is pinned to; in
+ * interleaved mode, all workers share `gdata`, spread over all nodes.
+ */
+struct numa_layout
+{
+    int mode = 0;                                   // 0 = off, 1 = replicated, 2 = interleaved
+    std::vector<int> nodes;                         // sysfs node IDs (nodes with CPUs only)
+    std::vector<std::vector<int>> node_cpus;        // CPUs of each node
+    std::vector<size_t> node_free_bytes;            // free memory of each node at startup
+    std::vector<int> worker_node;                   // node position of each pool worker
+    std::vector<std::unique_ptr<graph>> replicas;   // per node position (nullptr = gdata)
 };
 
 /**
@@ -120,6 +566,18 @@ struct path_result
     std::vector<int> steps;
 };
 
+/**
+ * @brief Result of an anytime query: the best path found before the deadline.
+ *
+ * `bound` is the proven suboptimality factor of `path` (`1.0` = shortest path).
+ */
+struct anytime_result
+{
+    path_result path;
+    double bound;
+    int rounds;
+};
+
 /**
  * @brief Represents an edge in the graph.
  *
@@ -133,6 +591,41 @@ struct edge
     int t;
 };
 
+/**
+ * @brief Deadline of one query, checked by the search loops every `check_interval` expansions.
+ *
+ * `poll()` only reads the clock, so both threads of the bidirectional engine can share it;
+ * the engine that gives up sets `cancelled` once its threads are joined.
+ *
+ * The point-to-point engines and the one-to-many searches (`dijkstraFromSource()`, the
+ * alternative routes trees, the nearest-target A*) all poll it. For `/matrix` and `/batch`,
+ * the gateway copies the armed token into every worker buffer, so each worker stops on its own.
+ */
+struct cancel_token
+{
+    static const size_t check_interval = 256;
+
+    std::chrono::steady_clock::time_point deadline{};
+    bool armed = false;
+    bool cancelled = false;
+
+    void arm(int timeout_ms) {
+        armed = timeout_ms > 0;
+        cancelled = false;
+        deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    }
+    void disarm() {
+        armed = false;
+        cancelled = false;
+    }
+    bool expired() const {
+        return armed && std::chrono::steady_clock::now() >= deadline;
+    }
+    bool poll(size_t& counter) const {
+        return armed && ++counter % check_interval == 0 && expired();
+    }
+};
+
 /**
  * @brief Holds reusable buffers for the shortest path search.
  *
@@ -144,23 +637,104 @@ struct edge
  * Each buffer has an associated version vector that ensures only relevant values 
  * are accessed or updated in a given search. The `current_search_id` increments 
  * with each new search, allowing old values to be automatically ignored.
+ *
+ * The open list of the unidirectional engine is kept here as well, so the last
+ * forward search can be resumed for a new target from the same source.
  */
 struct search_buffers {
-    std::vector<int> dist_from_start;
-    std::vector<int> dist_from_end;
-    std::vector<std::pair<int, int>> parent_forward;
-    std::vector<std::pair<int, int>> parent_backward;
-    std::vector<int> h_forward;
-    std::vector<int> h_backward;
+    huge_vector<int> dist_from_start;
+    huge_vector<int> dist_from_end;
+    huge_vector<std::pair<int, int>> parent_forward;
+    huge_vector<std::pair<int, int>> parent_backward;
+    huge_vector<int> h_forward;
+    huge_vector<int> h_backward;
     
     int current_search_id = 1;
 
-    std::vector<int> version_dist_from_start;
-    std::vector<int> version_dist_from_end;
-    std::vector<int> version_parent_forward;
-    std::vector<int> version_parent_backward;
-    std::vector<int> version_h_forward;
-    std::vector<int> version_h_backward;
+    huge_vector<int> version_dist_from_start;
+    huge_vector<int> version_dist_from_end;
+    huge_vector<int> version_parent_forward;
+    huge_vector<int> version_parent_backward;
+    huge_vector<int> version_h_forward;
+    huge_vector<int> version_h_backward;
+    huge_vector<int> version_closed;
+
+    std::vector<std::pair<double, size_t>> open_list;   // kept between queries for search tree reuse
+    std::vector<std::pair<int64_t, size_t>> keyed_open_list; // same, for the specialized kernels (integer keys)
+    int reuse_search_id = 0;                            // search that can be resumed (0 = none)
+    int reuse_source = -1;
+    bool reuse_parents = false;
+    bool reuse_keyed = false;                           // the kept tree is in `keyed_open_list`
+    std::vector<int> active_landmarks;                  // per-query ALT subset (see conf.alt_active)
+    cancel_token cancel;                                // deadline of the running query (API only)
+};
+
+using search_kernel_fn = path_result (*)(const graph& gdata, search_buffers& buffers, size_t start_idx, size_t end_idx, double weight, bool distance_only, bool reuse_tree);
+
+/**
+ * @brief Unidirectional kernels compiled for one heuristic and queue (see `makeSearchKernels()`).
+ *
+ * `findShortestPathUnidirectional()` uses `unidirectional_kernels` when it is set and still
+ * matches the heuristic and landmark layout of the query; an empty set keeps the generic engine.
+ */
+struct search_kernel_set
+{
+    search_kernel_fn dijkstra = nullptr;    // weight = 0 (no heuristic)
+    search_kernel_fn exact = nullptr;       // weight = 1 (integer keys g + h)
+    search_kernel_fn weighted = nullptr;    // other weights (fixed-point keys)
+    bool use_alt = false;
+    size_t stride = 0;                      // landmark row stride the ALT kernels were built for
+    std::string name;
+};
+
+/**
+ * @brief In-memory result cache placed in front of the point-to-point engines.
+ *
+ * Split into independently locked shards, each one an LRU list bounded by its share of
+ * the memory budget. Keys are normalised so `(a, b)` and `(b, a)` share one entry (the
+ * graph is undirected); `has_path` is `false` for entries stored by distance-only queries.
+ */
+struct route_cache
+{
+    static const size_t shard_count = 16;
+
+    struct key {
+        int a;          // smallest node ID
+        int b;          // largest node ID
+        int weight;     // heuristic weight x 100
+        int engine;
+
+        bool operator==(const key& other) const {
+            return a == other.a && b == other.b && weight == other.weight && engine == other.engine;
+        }
+    };
+
+    struct key_hash {
+        std::size_t operator()(const key& k) const noexcept {
+            std::size_t h = std::hash<long long>{}(((long long)k.a << 32) ^ (unsigned int)k.b);
+            return h ^ ((std::size_t)(k.weight * 31 + k.engine) + 0x9e3779b9 + (h << 6) + (h >> 2));
+        }
+    };
+
+    struct entry {
+        key k;
+        int total_time;
+        bool has_path;
+        std::vector<int> steps;     // from k.a to k.b
+    };
+
+    struct shard {
+        std::mutex mutex;
+        std::list<entry> lru;       // most recently used first
+        std::unordered_map<key, std::list<entry>::iterator, key_hash> index;
+        size_t bytes = 0;
+    };
+
+    std::array<shard, shard_count> shards;
+    size_t shard_budget = 0;        // bytes per shard, 0 = disabled
+
+    std::atomic<unsigned long long> hits{ 0 };
+    std::atomic<unsigned long long> misses{ 0 };
 };
 
 /*------------------------------------------------------------------------------------
@@ -178,10 +752,12 @@ int getInteger(const std::string& prompt);
 double getPercentage(const std::string& prompt);
 bool getYesNo(const std::string& prompt);
 int getOneOrTwo(const std::string& prompt);
+int getChoice(const std::string& prompt, int max_choice);
 
 void initializeSearchBuffers(const graph& gdata, search_buffers& buffers);
+void initializeBufferPool(const graph& gdata, std::vector<search_buffers>& pool, int nb_threads);
 
-std::vector<int> dijkstraSingleSource(const graph& gdata, int source, size_t node_count);
+std::vector<int> dijkstraSingleSource(const graph& gdata, int source, size_t node_count, cancel_token* token = nullptr);
 
 //  log.cpp (Logging)
 bool initLogger(const std::string& log_file_path);
@@ -207,7 +783,50 @@ bool checkIntegrity(const std::vector<edge>& edges);
 //  opti.cpp (Graph optimization)
 optimization_flags checkGraphOptimization(const std::string& map_path, double alt_density_threshold = 1e-4);
 
+//  trees.cpp (Dead-end tree pruning)
+void pruneTrees(graph& gdata);
+path_result routeThroughTrees(const graph& gdata, int start_node, int end_node, bool distance_only, const std::function<path_result(int, int)>& engine);
+bool isReducedNode(const graph& gdata, int node);
+std::vector<std::pair<int, int>> searchGraphExits(const graph& gdata, int node);
+int reducedLocalDistance(const graph& gdata, int a, int b);
+
+//  chains.cpp (Degree-2 chain compression)
+void compressChains(graph& gdata);
+path_result routeThroughChains(const graph& gdata, int start_node, int end_node, bool distance_only, const std::function<path_result(int, int)>& engine);
+std::vector<std::pair<int, int>> chainNodeExits(const graph& gdata, int node);
+
+//  ch.cpp (Contraction hierarchy)
+void buildContractionHierarchy(graph& gdata);
+void buildContractedCore(graph& gdata, size_t core_size);
+
+//  core_alt.cpp (Core-ALT engine)
+void preprocessCoreAlt(graph& gdata, config& conf);
+path_result findShortestPathCoreAlt(const graph& gdata, search_buffers& buffers, int start_node, int end_node, double weight, bool distance_only = false);
+
+//  cch.cpp (Customizable contraction hierarchy)
+void buildCustomizableHierarchy(graph& gdata);
+std::shared_ptr<const cch_metric> customizeCch(const graph& gdata, const std::vector<int>& edge_weights, int nb_threads);
+bool readEdgeWeights(const graph& gdata, const std::string& map_path, std::vector<int>& edge_weights);
+path_result findShortestPathCch(const graph& gdata, search_buffers& buffers, int start_node, int end_node, bool distance_only = false);
+
+//  phast.cpp (One-to-all queries)
+std::vector<std::vector<int>> phastOneToAll(const graph& gdata, const std::vector<int>& sources, int nb_threads);
+std::vector<int> computeOneToAll(const graph& gdata, int source, size_t node_count, int nb_threads = 1, int delta = 0);
+
+//  delta.cpp (Parallel one-to-all)
+int defaultSsspDelta(const graph& gdata);
+std::vector<int> deltaSteppingSingleSource(const graph& gdata, int source, size_t node_count, int delta, int nb_threads);
+
+//  alt_simd.cpp (Vectorized ALT kernels)
+using alt_kernel_fn = int (*)(const int* row_a, const int* row_b, size_t count);
+using alt_kernel16_fn = int (*)(const uint16_t* row_a, const uint16_t* row_b, const int* scale, size_t count);
+extern alt_kernel_fn altMaxAbsDiff;
+extern alt_kernel16_fn altMaxAbsDiff16;
+std::string altKernelName();
+
 //  alt.cpp (ALT preprocessing)
+void setLandmarkColumn(landmark_table& table, size_t landmark, const std::vector<int>& dist);
+void compactLandmarkTable(landmark_table& table);
 void preprocessAlt(graph& gdata, config& conf);
 
 //  bu_alt.cpp (ALT data storage/loading)
@@ -216,12 +835,61 @@ bool loadAltData(graph& gdata, config& conf);
 
 //  perf.cpp (Performance tracking)
 void storePerf(const graph& g);
+void benchmarkAltSearchSpace(const graph& g, search_buffers& buffers, const config& conf);
+void benchmarkSingleSource(const graph& g, const config& conf);
+void benchmarkHugePages(const graph& g, const config& conf);
+void benchmarkSearchKernels(const graph& g, const config& conf);
+bool checkLiveUpdates(const graph& g, const config& conf);
+bool checkChainUpdates(const graph& g, const config& conf);
+
+//  numa.cpp (NUMA placement)
+numa_layout detectNumaTopology(const std::string& sysfs_root = "/sys/devices/system/node");
+bool pinToNumaNode(const numa_layout& numa, size_t position);
+void setupNumaPlacement(graph& gdata, search_buffers& buffers, std::vector<search_buffers>& pool, numa_layout& numa);
+void refreshNumaReplicas(const graph& gdata, numa_layout& numa);
+const graph& enterNumaWorker(const graph& gdata, const numa_layout& numa, size_t worker);
+
+//  hugepages.cpp (Huge page backed storage)
+void configureHugePages(int mode, bool lock_memory);
+huge_page_report hugePageCoverage();
 
 //  search.cpp (Pathfinding)
-path_result findShortestPathBidirectional(const graph& gdata, search_buffers& buffers, const config& conf, int start_node, int end_node, double weight);
-path_result findShortestPathUnidirectional(const graph& gdata, search_buffers& buffers, const config& conf, int start_node, int end_node, double weight);
+path_result findShortestPathBidirectional(const graph& gdata, search_buffers& buffers, const config& conf, int start_node, int end_node, double weight, bool distance_only = false);
+path_result findShortestPathUnidirectional(const graph& gdata, search_buffers& buffers, const config& conf, int start_node, int end_node, double weight, bool distance_only = false, bool reuse_tree = false);
+extern search_kernel_set unidirectional_kernels;
+search_kernel_set makeSearchKernels(const graph& gdata, const config& conf, bool quad_heap);
+
+//  anytime.cpp (Deadline-bounded queries)
+anytime_result findShortestPathAnytime(const graph& gdata, search_buffers& buffers, const config& conf, int start_node, int end_node, int deadline_ms, bool distance_only = false);
+
+//  updates.cpp (Live weight updates)
+bool applyEdgeUpdates(graph& gdata, const std::vector<edge_update>& batch);
+bool repairLandmarks(graph& gdata, const config& conf);
+
+//  alternatives.cpp (Alternative routes)
+std::vector<path_result> findAlternativeRoutes(const graph& gdata, search_buffers& buffers, int start_node, int end_node, int max_routes, double max_stretch, double max_overlap, double min_plateau);
+
+//  cache.cpp (Result cache)
+void initializeRouteCache(route_cache& cache, int size_mb);
+bool lookupRouteCache(route_cache& cache, int start_node, int end_node, double weight, int engine, bool distance_only, path_result& result);
+void storeRouteCache(route_cache& cache, int start_node, int end_node, double weight, int engine, const path_result& result);
+void clearRouteCache(route_cache& cache);
+
+//  batch.cpp (Batched point-to-point queries)
+std::vector<path_result> computeRouteBatch(const graph& gdata, std::vector<search_buffers>& pool, const numa_layout& numa, route_cache& cache, const config& conf, const std::vector<std::pair<int, int>>& queries, bool distance_only);
+
+//  matrix.cpp (Many-to-many queries)
+std::vector<int> computeDistanceMatrix(const graph& gdata, std::vector<search_buffers>& pool, const numa_layout& numa, const std::vector<int>& sources, const std::vector<int>& targets);
+
+//  isochrone.cpp (Range queries)
+bool computeIsochrone(const graph& gdata, search_buffers& buffers, int start_node, int budget, bool boundary_only, std::vector<std::pair<int, int>>& reached);
+
+//  knn.cpp (Nearest-target queries)
+void loadPoiSets(graph& gdata, const config& conf);
+void refreshPoiBounds(graph& gdata);
+bool findNearestTargets(const graph& gdata, search_buffers& buffers, const config& conf, int start_node, const std::string& set_name, int k, std::vector<std::pair<int, int>>& nearest);
 
 //  api.cpp (API management)
-int launchApiGateway(const graph& gdata, search_buffers& buffers, const config& conf);
+int launchApiGateway(graph& gdata, search_buffers& buffers, std::vector<search_buffers>& pool, numa_layout& numa, route_cache& cache, const config& conf);
 
 #endif //DECL_H
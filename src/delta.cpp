@@ -0,0 +1,227 @@
+﻿#include "incl.h"
+#include "decl.h"
+
+namespace {
+    constexpr int delta_inf = std::numeric_limits<int>::max();
+    constexpr size_t no_bin = std::numeric_limits<size_t>::max();
+
+    // Frontier entries handed out to a worker at once.
+    constexpr size_t delta_chunk_size = 64;
+
+    // Below this size, a worker keeps processing its own current bin without a global step.
+    constexpr size_t delta_local_bin_threshold = 1000;
+
+    /**
+     * @brief Reusable barrier for a fixed number of threads (`std::barrier` is C++20).
+     */
+    class step_barrier
+    {
+    public:
+        explicit step_barrier(size_t count) : count_(count) {}
+
+        void wait() {
+            std::unique_lock<std::mutex> lk(mutex_);
+            size_t generation = generation_;
+            if (++waiting_ == count_) {
+                waiting_ = 0;
+                generation_++;
+                cv_.notify_all();
+                return;
+            }
+            cv_.wait(lk, [&] { return generation_ != generation; });
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        size_t count_;
+        size_t waiting_ = 0;
+        size_t generation_ = 0;
+    };
+
+    /**
+     * @brief Lowers `slot` to `value` if it is smaller.
+     *
+     * @return `true` if this call lowered it.
+     */
+    inline bool atomicMin(std::atomic<int>& slot, int value)
+    {
+        int cur = slot.load(std::memory_order_relaxed);
+        while (value < cur) {
+            if (slot.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+/**
+ * @brief Picks a delta for delta-stepping when none is configured.
+ *
+ * @detailed
+ * Buckets of a few average edge weights keep enough nodes per phase to feed all workers
+ * on road networks, without re-relaxing too many nodes whose distance is not final yet.
+ *
+ * @complexity
+ * - Time Complexity: O(E).
+ * - Space Complexity: O(1).
+ */
+int defaultSsspDelta(const graph& gdata)
+{
+    if (gdata.edges.empty()) {
+        return 1;
+    }
+    long long total = 0;
+    for (const auto& e : gdata.edges) {
+        total += e.weight;
+    }
+    return (int)std::max<long long>(1, 4 * total / (long long)gdata.edges.size());
+}
+
+/**
+ * @brief Computes shortest paths from a single source with parallel delta-stepping.
+ *
+ * @detailed
+ * Delta-stepping (Meyer & Sanders) replaces Dijkstra's priority queue by buckets of width
+ * `delta`: all nodes of the lowest non-empty bucket are relaxed in parallel, and nodes whose
+ * distance drops are pushed to the bucket of their new distance. A bucket is repeated until
+ * it stays empty, so distances are exact even though nodes may be relaxed more than once.
+ *
+ * Functionality:
+ * - Distances live in one atomic array over the CSR arrays, lowered with compare-and-swap.
+ * - Every worker keeps its own buckets; a phase gathers the current bucket of every worker
+ *   into the shared frontier, which is consumed in chunks of `delta_chunk_size` entries.
+ * - A worker keeps processing small local buckets on its own before the next global step,
+ *   which removes most barriers on sparse road graphs (GAP benchmark suite layout).
+ * - Entries whose distance already dropped below the current bucket are stale and skipped.
+ *
+ * Choosing `delta`:
+ * - `delta = 1` processes one distance value per phase (Dijkstra order, many phases).
+ * - Very large values turn it into Bellman-Ford (few phases, many re-relaxations).
+ * - `0` uses `defaultSsspDelta()`.
+ *
+ * @param gdata Graph representation containing adjacency information.
+ * @param source The starting node for the shortest path computation.
+ * @param node_count The total number of nodes in the graph.
+ * @param delta Bucket width (`<= 0` for the default).
+ * @param nb_threads Number of workers (`0` for all available threads).
+ * @return The same distances as `dijkstraSingleSource()` (`-1` = unreachable).
+ *
+ * @complexity
+ * - Time Complexity: O(V + E + re-relaxations) work, O(phases × (chunk + barrier)) span.
+ * - Space Complexity: O(V + pushed entries).
+ */
+std::vector<int> deltaSteppingSingleSource(const graph& gdata, int source, size_t node_count, int delta, int nb_threads)
+{
+    std::vector<int> distances(node_count, -1);
+
+    auto it = gdata.node_to_index.find(source);
+    if (it == gdata.node_to_index.end()) {
+        return distances;
+    }
+
+    const size_t step = (size_t)((delta > 0) ? delta : defaultSsspDelta(gdata));
+    const size_t nb_workers = std::max<size_t>(1, (nb_threads > 0) ? (size_t)nb_threads : (size_t)std::thread::hardware_concurrency());
+
+    std::unique_ptr<std::atomic<int>[]> dist(new std::atomic<int>[node_count]);
+    for (size_t idx = 0; idx < node_count; ++idx) {
+        dist[idx].store(delta_inf, std::memory_order_relaxed);
+    }
+    dist[it->second].store(0, std::memory_order_relaxed);
+
+    std::vector<std::vector<size_t>> frontier(nb_workers);     // current bucket, one part per worker
+    frontier[0].push_back(it->second);
+    std::atomic<size_t> next_item(0);
+    std::atomic<size_t> next_bin[2] = { { no_bin }, { no_bin } };
+    step_barrier barrier(nb_workers);
+
+    auto workerFunc = [&](size_t worker) {
+        std::vector<std::vector<size_t>> bins;
+        std::vector<size_t> local;
+        size_t cur_bin = 0;
+
+        auto relax = [&](size_t cur_idx) {
+            int du = dist[cur_idx].load(std::memory_order_relaxed);
+            if ((size_t)du < step * cur_bin) {
+                return;     // stale entry, already relaxed from an earlier bucket
+            }
+            size_t start_edge = gdata.offsets[cur_idx];
+            size_t end_edge = gdata.offsets[cur_idx + 1];
+            for (size_t i = start_edge; i < end_edge; ++i) {
+                const auto& edge = gdata.edges[i];
+                int nd = du + edge.weight;
+                if (atomicMin(dist[edge.target], nd)) {
+                    size_t bin = (size_t)nd / step;
+                    if (bin >= bins.size()) {
+                        bins.resize(bin + 1);
+                    }
+                    bins[bin].push_back((size_t)edge.target);
+                }
+            }
+        };
+
+        for (size_t iter = 0;; ++iter) {
+            size_t total = 0;
+            for (const auto& part : frontier) {
+                total += part.size();
+            }
+            for (size_t begin = next_item.fetch_add(delta_chunk_size); begin < total; begin = next_item.fetch_add(delta_chunk_size)) {
+                size_t end = std::min(total, begin + delta_chunk_size);
+                size_t offset = 0;
+                for (const auto& part : frontier) {
+                    for (size_t k = std::max(begin, offset); k < std::min(end, offset + part.size()); ++k) {
+                        relax(part[k - offset]);
+                    }
+                    offset += part.size();
+                }
+            }
+            while (cur_bin < bins.size() && !bins[cur_bin].empty() && bins[cur_bin].size() < delta_local_bin_threshold) {
+                local.clear();
+                local.swap(bins[cur_bin]);
+                for (size_t cur_idx : local) {
+                    relax(cur_idx);
+                }
+            }
+
+            for (size_t bin = cur_bin; bin < bins.size(); ++bin) {
+                if (!bins[bin].empty()) {
+                    size_t expected = next_bin[iter & 1].load();
+                    while (bin < expected && !next_bin[iter & 1].compare_exchange_weak(expected, bin)) {}
+                    break;
+                }
+            }
+            barrier.wait();
+
+            size_t bin = next_bin[iter & 1].load();
+            if (worker == 0) {
+                next_item.store(0);
+                next_bin[(iter + 1) & 1].store(no_bin);
+            }
+            if (bin == no_bin) {
+                break;
+            }
+            frontier[worker].clear();
+            if (bin < bins.size()) {
+                frontier[worker].swap(bins[bin]);
+            }
+            cur_bin = bin;
+            barrier.wait();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t w = 1; w < nb_workers; ++w) {
+        workers.emplace_back(workerFunc, w);
+    }
+    workerFunc(0);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (size_t idx = 0; idx < node_count; ++idx) {
+        int d = dist[idx].load(std::memory_order_relaxed);
+        distances[idx] = (d == delta_inf) ? -1 : d;
+    }
+    return distances;
+}
@@ -176,6 +176,22 @@ int getOneOrTwo(const std::string& prompt)
     return one_or_two;
 }
 
+/**
+ * @brief Prompts the user until an integer between `1` and `max_choice` is entered.
+ */
+int getChoice(const std::string& prompt, int max_choice)
+{
+    int choice;
+    while (true) {
+        choice = getInteger(prompt);
+        if (choice >= 1 && choice <= max_choice) {
+            break;
+        }
+        console("error", "invalid input. please enter a number between 1 and " + std::to_string(max_choice) + ".");
+    }
+    return choice;
+}
+
 
 // ✅ function + comment verified.
 /**
@@ -201,10 +217,13 @@ int getOneOrTwo(const std::string& prompt)
  *
  * Edge Cases:
  * - If the source node is invalid, the function returns a distance array filled with `-1`.
+ * - If `token` expires, the search stops, `token->cancelled` is set and the partial
+ *   (tentative) distances are returned.
  *
  * @param gdata Graph representation containing adjacency information.
  * @param source The starting node for the shortest path computation.
  * @param node_count The total number of nodes in the graph.
+ * @param token Optional deadline of the computation (`nullptr` = none).
  * @return A vector containing the shortest path distances from the source to all nodes.
  *
  * @complexity
@@ -212,7 +231,7 @@ int getOneOrTwo(const std::string& prompt)
  * - Space Complexity: O(V) (Stores shortest path distances).
  */
 
-std::vector<int> dijkstraSingleSource(const graph& gdata, int source, size_t node_count)
+std::vector<int> dijkstraSingleSource(const graph& gdata, int source, size_t node_count, cancel_token* token)
 {
     std::vector<int> distances(node_count, -1);
 
@@ -226,6 +245,7 @@ std::vector<int> dijkstraSingleSource(const graph& gdata, int source, size_t nod
     using state = std::pair<int, size_t>;
     std::priority_queue<state, std::vector<state>, std::greater<state>> pq;
     pq.push({0, source_idx});
+    size_t polls = 0;
 
     while (!pq.empty()) {
         auto [cur_dist, cur_idx] = pq.top();
@@ -233,9 +253,13 @@ std::vector<int> dijkstraSingleSource(const graph& gdata, int source, size_t nod
 
         if (distances[cur_idx] != cur_dist)
             continue;
+        if (token && token->poll(polls)) {
+            token->cancelled = true;
+            break;
+        }
 
         size_t start_edge = gdata.offsets[cur_idx];
-        size_t end_edge = (cur_idx + 1 < gdata.offsets.size()) ? gdata.offsets[cur_idx + 1] : gdata.edges.size();
+        size_t end_edge = gdata.offsets[cur_idx + 1];
 
         for (size_t i = start_edge; i < end_edge; ++i) {
             const auto& edge = gdata.edges[i];
@@ -286,6 +310,31 @@ void initializeSearchBuffers(const graph& gdata, search_buffers& buffers) {
     buffers.version_parent_backward.assign(n, 0);
     buffers.version_h_forward.assign(n, 0);
     buffers.version_h_backward.assign(n, 0);
+    buffers.version_closed.assign(n, 0);
     
     buffers.current_search_id = 1; 
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Initializes one set of search buffers per worker thread.
+ *
+ * Batch features (e.g. the distance matrix) run several searches in parallel,
+ * and each thread needs its own versioned buffers to avoid any locking.
+ *
+ * @param gdata The graph data structure.
+ * @param pool The vector of buffers to fill.
+ * @param nb_threads Number of workers (`0` or less = number of hardware threads).
+ */
+void initializeBufferPool(const graph& gdata, std::vector<search_buffers>& pool, int nb_threads)
+{
+    size_t nb_workers = (nb_threads > 0) ? (size_t)nb_threads : (size_t)std::thread::hardware_concurrency();
+    if (nb_workers == 0) {
+        nb_workers = 1;
+    }
+
+    pool.clear();
+    pool.resize(nb_workers);
+    for (auto& buffers : pool) {
+        initializeSearchBuffers(gdata, buffers);
+    }
+}
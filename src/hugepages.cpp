@@ -0,0 +1,240 @@
+﻿#include "incl.h"
+#include "decl.h"
+
+namespace {
+    constexpr size_t huge_page_bytes = 2 * 1024 * 1024;
+
+    /**
+     * @brief One large block handed out by `hugePageAllocate()`.
+     */
+    struct huge_region
+    {
+        size_t bytes;       // mapped length (multiple of 2 MB)
+        bool explicit_huge; // backed by MAP_HUGETLB pages
+        bool locked;
+    };
+
+    std::atomic<int> region_mode(0);
+    std::atomic<bool> region_lock(false);
+    std::mutex region_mutex;
+    std::map<uintptr_t, huge_region> regions;
+    size_t hugetlb_fallbacks = 0;
+    size_t lock_failures = 0;
+
+    inline size_t roundToHugePage(size_t bytes)
+    {
+        return (bytes + huge_page_bytes - 1) / huge_page_bytes * huge_page_bytes;
+    }
+
+#ifdef IS_LINUX
+    /**
+     * @brief Maps `bytes` (a multiple of 2 MB) of anonymous memory according to the mode.
+     *
+     * @detailed
+     * - Mode `2` first asks for explicit huge pages (`MAP_HUGETLB`, from the pool reserved in
+     *   `/proc/sys/vm/nr_hugepages`); if the pool is empty, it falls back to mode `1`.
+     * - Otherwise a 2 MB aligned range is carved out of a slightly larger mapping (the kernel
+     *   can only back aligned 2 MB ranges with a transparent huge page) and advised with
+     *   `MADV_HUGEPAGE` (mode `1`/`2`), `MADV_NOHUGEPAGE` (mode `-1`) or left as is (mode `0`).
+     *
+     * @return The mapping, `nullptr` if the system is out of memory.
+     */
+    void* mapRegion(size_t bytes, int mode, bool& explicit_huge)
+    {
+        explicit_huge = false;
+        if (mode == 2) {
+            void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) {
+                explicit_huge = true;
+                return p;
+            }
+            hugetlb_fallbacks++;
+        }
+
+        void* raw = mmap(nullptr, bytes + huge_page_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            return nullptr;
+        }
+        uintptr_t begin = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = (begin + huge_page_bytes - 1) / huge_page_bytes * huge_page_bytes;
+        if (aligned > begin) {
+            munmap(raw, aligned - begin);
+        }
+        if (aligned + bytes < begin + bytes + huge_page_bytes) {
+            munmap(reinterpret_cast<void*>(aligned + bytes), begin + huge_page_bytes - aligned);
+        }
+        void* p = reinterpret_cast<void*>(aligned);
+        if (mode >= 1) {
+            madvise(p, bytes, MADV_HUGEPAGE);
+        }
+        else if (mode < 0) {
+            madvise(p, bytes, MADV_NOHUGEPAGE);
+        }
+        return p;
+    }
+#endif
+}
+
+/**
+ * @brief Selects how the following large allocations are backed.
+ *
+ * @param mode `0` = default pages, `1` = transparent huge pages (`madvise`), `2` = explicit
+ *             huge pages (`MAP_HUGETLB`, falling back to `1`), `-1` = forced 4 KB pages
+ *             (baseline of `benchmarkHugePages()`).
+ * @param lock_memory If `true`, new blocks are pre-faulted and locked in RAM (`mlock`).
+ */
+void configureHugePages(int mode, bool lock_memory)
+{
+    region_mode.store(mode);
+    region_lock.store(lock_memory);
+}
+
+/**
+ * @brief Allocates storage for `huge_page_allocator` (graph arrays, landmarks, search buffers).
+ *
+ * @detailed
+ * Blocks smaller than one huge page (2 MB) are 64-byte aligned heap blocks: they would not
+ * fill a huge page anyway. Larger blocks are rounded up to 2 MB and mapped by `mapRegion()`
+ * on Linux (heap blocks elsewhere); with `lock_memory`, every page is touched and the block
+ * is locked, so no query ever takes a page fault. A failed `mlock` (usually
+ * `RLIMIT_MEMLOCK`) only leaves the block unlocked and is counted.
+ *
+ * The decision only depends on the size, so `hugePageDeallocate()` finds the same path.
+ *
+ * @param bytes Requested size.
+ * @return The block (throws `std::bad_alloc` when out of memory).
+ *
+ * @complexity
+ * - Time Complexity: O(1), O(bytes / 4 KB) when pre-faulting.
+ * - Space Complexity: up to 2 MB of rounding per large block.
+ */
+void* hugePageAllocate(size_t bytes)
+{
+#ifdef IS_LINUX
+    if (bytes >= huge_page_bytes) {
+        size_t mapped = roundToHugePage(bytes);
+        std::lock_guard<std::mutex> lk(region_mutex);
+        bool explicit_huge = false;
+        void* p = mapRegion(mapped, region_mode.load(), explicit_huge);
+        if (!p) {
+            throw std::bad_alloc();
+        }
+        bool locked = false;
+        if (region_lock.load()) {
+            volatile char* bytes_ptr = static_cast<volatile char*>(p);
+            for (size_t off = 0; off < mapped; off += 4096) {
+                bytes_ptr[off] = 0;
+            }
+            locked = (mlock(p, mapped) == 0);
+            lock_failures += !locked;
+        }
+        regions[reinterpret_cast<uintptr_t>(p)] = { mapped, explicit_huge, locked };
+        return p;
+    }
+#endif
+    return ::operator new(bytes, std::align_val_t(64));
+}
+
+/**
+ * @brief Releases a block returned by `hugePageAllocate(bytes)`.
+ */
+void hugePageDeallocate(void* ptr, size_t bytes) noexcept
+{
+#ifdef IS_LINUX
+    if (bytes >= huge_page_bytes) {
+        std::lock_guard<std::mutex> lk(region_mutex);
+        auto it = regions.find(reinterpret_cast<uintptr_t>(ptr));
+        size_t mapped = (it != regions.end()) ? it->second.bytes : roundToHugePage(bytes);
+        if (it != regions.end()) {
+            regions.erase(it);
+        }
+        munmap(ptr, mapped);
+        return;
+    }
+#endif
+    ::operator delete(ptr, std::align_val_t(64));
+}
+
+/**
+ * @brief Measures how much of the large blocks is actually backed by huge pages.
+ *
+ * @detailed
+ * Reads `/proc/self/smaps`: for every mapping overlapping a registered block, explicit
+ * huge page mappings (`KernelPageSize` of 2 MB or more) count fully, and transparent ones
+ * count their `AnonHugePages`, prorated by the overlap (the kernel may merge neighbouring
+ * mappings). Returns zeros for the coverage on other platforms.
+ *
+ * @return The coverage and allocation counters.
+ *
+ * @complexity
+ * - Time Complexity: O(M log R) for `M` process mappings and `R` blocks.
+ * - Space Complexity: O(R).
+ */
+huge_page_report hugePageCoverage()
+{
+    huge_page_report report{};
+    std::vector<std::pair<uintptr_t, uintptr_t>> ranges;
+    {
+        std::lock_guard<std::mutex> lk(region_mutex);
+        for (const auto& [start, region] : regions) {
+            ranges.push_back({ start, start + region.bytes });
+            report.mapped_bytes += region.bytes;
+            report.locked_bytes += region.locked ? region.bytes : 0;
+            report.explicit_bytes += region.explicit_huge ? region.bytes : 0;
+        }
+        report.regions = regions.size();
+        report.hugetlb_fallbacks = hugetlb_fallbacks;
+        report.lock_failures = lock_failures;
+    }
+
+#ifdef IS_LINUX
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    uintptr_t vma_begin = 0;
+    uintptr_t vma_end = 0;
+    size_t overlap = 0;
+    size_t kernel_page_kb = 4;
+    auto overlapWith = [&](uintptr_t begin, uintptr_t end) {
+        size_t total = 0;
+        auto it = std::upper_bound(ranges.begin(), ranges.end(), std::make_pair(begin, std::numeric_limits<uintptr_t>::max()));
+        if (it != ranges.begin()) {
+            --it;
+        }
+        for (; it != ranges.end() && it->first < end; ++it) {
+            uintptr_t lo = std::max(begin, it->first);
+            uintptr_t hi = std::min(end, it->second);
+            total += (hi > lo) ? hi - lo : 0;
+        }
+        return total;
+    };
+    while (std::getline(smaps, line)) {
+        size_t dash = line.find('-');
+        size_t space = line.find(' ');
+        if (dash != std::string::npos && space != std::string::npos && dash < space && line.find(':') > space) {
+            vma_begin = std::stoull(line.substr(0, dash), nullptr, 16);
+            vma_end = std::stoull(line.substr(dash + 1, space - dash - 1), nullptr, 16);
+            overlap = overlapWith(vma_begin, vma_end);
+            kernel_page_kb = 4;
+            continue;
+        }
+        if (overlap == 0) {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string key;
+        size_t value_kb = 0;
+        fields >> key >> value_kb;
+        if (key == "KernelPageSize:") {
+            kernel_page_kb = value_kb;
+        }
+        else if (key == "AnonHugePages:" && kernel_page_kb < 2048) {
+            double share = (double)overlap / (double)(vma_end - vma_begin);
+            report.huge_bytes += (size_t)((double)value_kb * 1024.0 * share);
+        }
+        else if (key == "MMUPageSize:" && kernel_page_kb >= 2048) {
+            report.huge_bytes += overlap;
+        }
+    }
+#endif
+    return report;
+}
@@ -1,4 +1,4 @@
-#ifndef INCL_H
+﻿#ifndef INCL_H
 #define INCL_H
 
 /*------------------------------------------------------------------------------------
@@ -35,6 +35,9 @@
 // ===============================
 
 #include <limits>        // Numeric limits (std::numeric_limits<T>)
+#include <cstdint>       // Fixed-width integers (uint16_t, uint64_t)
+#include <cmath>         // Math functions (std::lround, std::sqrt)
+#include <random>        // Pseudo-random generators (std::mt19937)
 
 // ===============================
 // Multi-threading & Synchronization
@@ -44,6 +47,7 @@
 #include <atomic>             // Atomic operations (std::atomic)
 #include <mutex>              // Mutex for synchronization (std::mutex, std::lock_guard)
 #include <condition_variable> // Thread condition synchronization (std::condition_variable)
+#include <chrono>             // Clocks and deadlines (std::chrono::steady_clock)
 
 // ===============================
 // Data Structures & Algorithms
@@ -57,8 +61,25 @@
 #include <stack>           // Stack (std::stack)
 #include <tuple>           // Tuples (std::tuple)
 #include <algorithm>       // Standard algorithms (std::sort, std::find, etc.)
+#include <numeric>         // Numeric algorithms (std::iota)
 #include <map>			   // Ordered associative containers (std::map, std::multimap)
 #include <memory>          // Smart pointers (std::unique_ptr, std::shared_ptr)
+#include <functional>      // Callable wrappers (std::function)
+#include <list>            // Doubly linked list (std::list)
+#include <array>           // Fixed-size arrays (std::array)
+#include <new>             // Aligned allocation (std::align_val_t)
+
+// ===============================
+// SIMD Intrinsics (x86 only, kernels are selected at runtime)
+// ===============================
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define HAS_X86_SIMD
+#include <immintrin.h>     // AVX2 / AVX-512 intrinsics
+#ifdef _MSC_VER
+#include <intrin.h>        // CPU feature detection (__cpuidex, _xgetbv)
+#endif
+#endif
 
 // ===============================
 // Networking (Cross-Platform)
@@ -85,6 +106,18 @@
 typedef int SOCKET;         // Define socket type for UNIX
 #endif
 
+// ===============================
+// Memory-Mapped Files
+// ===============================
+
+#ifdef _WIN32
+#include <windows.h>        // File mappings (CreateFileMapping, MapViewOfFile)
+#else
+#include <sys/mman.h>       // mmap(), munmap()
+#include <sys/stat.h>       // fstat()
+#include <fcntl.h>          // open()
+#endif
+
 // ===============================
 // Platform-Specific System Info 
 // (not from STL librairy.)
@@ -107,6 +140,8 @@ typedef int SOCKET;         // Define socket type for UNIX
 #include <sys/sysinfo.h>  // System information (RAM, uptime, etc.)
 #include <sys/resource.h> // Process resource usage
 #include <unistd.h>       // Standard symbolic constants and types
+#include <sched.h>        // Thread CPU affinity (sched_setaffinity)
+#include <sys/syscall.h>  // NUMA memory policy system calls (SYS_mbind)
 #endif
 
 
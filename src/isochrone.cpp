@@ -0,0 +1,335 @@
+﻿#include "incl.h"
+#include "decl.h"
+#include "search.h"
+
+namespace {
+    /**
+     * @brief Travel times of the nodes removed by graph reduction around an isochrone.
+     */
+    struct reduced_times
+    {
+        std::unordered_map<int, int> time;      // removed node ID -> travel time (may exceed the budget)
+        std::unordered_set<int> far_child;      // nodes with a pruned child beyond the budget
+    };
+
+    /**
+     * @brief Times the removed nodes hanging from the search graph nodes reached by an isochrone.
+     *
+     * @detailed
+     * - Chains: each chain ending at a reached node gets `min(t(from) + offset, t(to) + length - offset)`
+     *   for its removed nodes, or the walk along the chain when the start (or its attachment)
+     *   lies on it.
+     * - Trees: each tree hanging from a reached node gets `t(attachment) + dist`, or the walk
+     *   through the lowest common ancestor for the tree of the start itself. A pruned node
+     *   beyond the budget marks its parent in `far_child`, for boundary detection.
+     *
+     * @param kept_time Travel time of a search graph node index (`-1` = not reached).
+     * @param reached Search graph node indices within the budget.
+     *
+     * @complexity
+     * - Time Complexity: O(R + K × log C) for the `R` removed nodes of the touched chains and
+     *   trees, and `K` reached nodes.
+     * - Space Complexity: O(R).
+     */
+    template <typename KeptTime>
+    void timeReducedNodes(const graph& gdata, int start_node, int budget, KeptTime&& kept_time, const std::vector<size_t>& reached, reduced_times& out)
+    {
+        const auto& cc = gdata.chains;
+        const auto& tp = gdata.trees;
+
+        auto timeOf = [&](int node) {
+            auto it = gdata.node_to_index.find(node);
+            if (it != gdata.node_to_index.end()) {
+                return kept_time(it->second);
+            }
+            auto it_time = out.time.find(node);
+            return (it_time == out.time.end()) ? -1 : it_time->second;
+        };
+
+        int start_slot = -1;
+        int anchor = start_node;
+        int base = 0;
+        if (tp.built) {
+            auto it = tp.position.find(start_node);
+            if (it != tp.position.end()) {
+                start_slot = (int)it->second;
+                anchor = tp.attachment[start_slot];
+                base = tp.dist[start_slot];
+            }
+        }
+        int anchor_chain = -1;
+        size_t anchor_pos = 0;
+        if (cc.built) {
+            auto it = cc.position.find(anchor);
+            if (it != cc.position.end()) {
+                anchor_pos = it->second;
+                anchor_chain = (int)(std::upper_bound(cc.first.begin(), cc.first.end(), anchor_pos) - cc.first.begin()) - 1;
+            }
+        }
+
+        std::vector<int> attachments;
+        std::unordered_set<int> timed_chains;
+        auto timeChain = [&](int chain) {
+            if (!timed_chains.insert(chain).second) {
+                return;
+            }
+            const long long inf = std::numeric_limits<long long>::max();
+            int t_from = timeOf(cc.from[chain]);
+            int t_to = timeOf(cc.to[chain]);
+            for (size_t k = cc.first[chain]; k < cc.first[chain + 1]; ++k) {
+                long long best = inf;
+                if (t_from >= 0) {
+                    best = (long long)t_from + cc.offset[k];
+                }
+                if (t_to >= 0) {
+                    best = std::min(best, (long long)t_to + cc.length[chain] - cc.offset[k]);
+                }
+                if (chain == anchor_chain) {
+                    best = std::min(best, (long long)base + std::abs(cc.offset[k] - cc.offset[anchor_pos]));
+                }
+                if (best == inf) {
+                    continue;
+                }
+                out.time[cc.interior[k]] = (int)best;
+                if (best <= budget) {
+                    attachments.push_back(cc.interior[k]);
+                }
+            }
+        };
+
+        if (cc.built) {
+            if (anchor_chain >= 0) {
+                timeChain(anchor_chain);
+            }
+            for (size_t idx : reached) {
+                auto it = cc.chains_at.find(gdata.index_to_node[idx]);
+                if (it != cc.chains_at.end()) {
+                    for (int chain : it->second) {
+                        timeChain(chain);
+                    }
+                }
+            }
+        }
+        if (!tp.built) {
+            return;
+        }
+
+        for (size_t idx : reached) {
+            attachments.push_back(gdata.index_to_node[idx]);
+        }
+        if (start_slot >= 0) {
+            attachments.push_back(anchor);
+        }
+        std::unordered_set<int> timed_trees;
+        for (int node : attachments) {
+            auto it = tp.hanging.find(node);
+            if (it == tp.hanging.end() || !timed_trees.insert(node).second) {
+                continue;
+            }
+            const bool own = (start_slot >= 0 && node == anchor);
+            std::unordered_map<int, int> lca_dist;
+            for (int s = own ? start_slot : -1; s >= 0; s = tp.parent[s]) {
+                lca_dist[s] = tp.dist[s];
+            }
+            int t_attach = timeOf(node);
+            if (!own && t_attach < 0) {
+                continue;
+            }
+            for (int s : it->second) {
+                int par = tp.parent[s];
+                long long t = (long long)t_attach + tp.dist[s];
+                if (own) {
+                    auto it_lca = lca_dist.find(s);
+                    int lca = (it_lca != lca_dist.end()) ? it_lca->second : (par < 0) ? 0 : lca_dist[par];
+                    lca_dist[s] = lca;
+                    t = (long long)base + tp.dist[s] - 2LL * lca;
+                }
+                out.time[tp.node[s]] = (int)t;
+                if (t > budget) {
+                    out.far_child.insert((par < 0) ? node : tp.node[par]);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Computes every node reachable from `start_node` within `budget` time units.
+ *
+ * @detailed
+ * This function answers range (isochrone) queries for catchment analysis.
+ *
+ * Functionality:
+ * - Runs a bounded Dijkstra with the versioned `search_buffers` (no O(N) reset) that
+ *   stops as soon as the next node to settle is beyond the budget.
+ * - Hierarchy-accelerated variant: if a contraction hierarchy is available and the
+ *   bounded search settles more than `V / 8` nodes, the search is abandoned and a
+ *   PHAST sweep (no priority queue, linear memory access) computes all distances
+ *   instead, which is much faster for large budgets.
+ * - Graph reduction: a start removed by `prune_trees` / `compress_chains` seeds the search
+ *   from its exits (`searchGraphExits()`), and the removed nodes hanging from the reached
+ *   area are timed from the chain offsets and tree distances (`timeReducedNodes()`), so
+ *   the result covers the original graph.
+ * - Boundary-only mode keeps only the reached nodes that have at least one neighbour
+ *   outside the budget (the "edge" of the isochrone), which makes the output compact.
+ * - The bounded search polls `buffers.cancel`; once it expires, `reached` is left empty
+ *   and `buffers.cancel.cancelled` is set (the PHAST sweep is not started).
+ *
+ * @param gdata Reference to the graph data.
+ * @param buffers Reference to `search_buffers` for optimized memory management.
+ * @param start_node The source node ID.
+ * @param budget Maximum travel time (inclusive).
+ * @param boundary_only `true` to only return boundary nodes.
+ * @param reached Output list of `(node ID, time)` pairs, sorted by time.
+ * @return `false` if the start node does not exist.
+ *
+ * @complexity
+ * - Time Complexity: O(E_T log V_T) where `V_T`/`E_T` are the nodes/edges within the budget,
+ *   or O(V + E_up) with the PHAST fallback, plus O(R_T) for the removed nodes around them.
+ * - Space Complexity: O(V_T + R_T) for the result.
+ */
+bool computeIsochrone(const graph& gdata, search_buffers& buffers, int start_node, int budget, bool boundary_only, std::vector<std::pair<int, int>>& reached)
+{
+    reached.clear();
+
+    auto exits = searchGraphExits(gdata, start_node);
+    if (exits.empty()) {
+        return false;
+    }
+    std::vector<std::pair<size_t, int>> seeds;
+    for (const auto& [node, cost] : exits) {
+        if (cost <= budget) {
+            seeds.push_back({ gdata.node_to_index.at(node), cost });
+        }
+    }
+
+    const size_t node_count = gdata.index_to_node.size();
+    const size_t phast_threshold = gdata.ch.built ? std::max<size_t>(node_count / 8, 1) : std::numeric_limits<size_t>::max();
+
+    std::vector<size_t> settled;
+    bool use_phast = false;
+
+    dijkstraFromSeeds<false>(gdata, buffers, seeds, [&](size_t idx, int dist) {
+        if (dist > budget) {
+            return false;
+        }
+        if (settled.size() >= phast_threshold) {
+            use_phast = true;
+            return false;
+        }
+        settled.push_back(idx);
+        return true;
+    });
+    if (buffers.cancel.cancelled) {
+        return true;
+    }
+
+    std::vector<int> all_dist;
+    if (use_phast) {
+        all_dist.assign(node_count, -1);
+        for (const auto& [seed_idx, seed_dist] : seeds) {
+            std::vector<int> seed_all = computeOneToAll(gdata, gdata.index_to_node[seed_idx], node_count);
+            for (size_t idx = 0; idx < node_count; ++idx) {
+                if (seed_all[idx] >= 0 && (all_dist[idx] < 0 || seed_all[idx] + seed_dist < all_dist[idx])) {
+                    all_dist[idx] = seed_all[idx] + seed_dist;
+                }
+            }
+        }
+        settled.clear();
+        for (size_t idx = 0; idx < node_count; ++idx) {
+            if (all_dist[idx] >= 0 && all_dist[idx] <= budget) {
+                settled.push_back(idx);
+            }
+        }
+        std::sort(settled.begin(), settled.end(), [&](size_t a, size_t b) {
+            return all_dist[a] < all_dist[b];
+        });
+    }
+
+    auto distOf = [&](size_t idx) -> int {
+        return use_phast ? all_dist[idx] : getDistFromStart(buffers, idx);
+    };
+    auto outside = [&](int time) {
+        return time < 0 || time > budget;
+    };
+
+    const auto& cc = gdata.chains;
+    const auto& tp = gdata.trees;
+    const bool reduced = cc.built || tp.built;
+    reduced_times extra;
+    if (reduced) {
+        timeReducedNodes(gdata, start_node, budget, distOf, settled, extra);
+    }
+    auto timeOf = [&](int node) {
+        auto it = gdata.node_to_index.find(node);
+        if (it != gdata.node_to_index.end()) {
+            return distOf(it->second);
+        }
+        auto it_time = extra.time.find(node);
+        return (it_time == extra.time.end()) ? -1 : it_time->second;
+    };
+
+    reached.reserve(settled.size());
+    for (size_t idx : settled) {
+        int node = gdata.index_to_node[idx];
+        if (boundary_only) {
+            bool on_boundary = reduced && extra.far_child.count(node);
+            size_t start_edge = gdata.offsets[idx];
+            size_t end_edge = gdata.offsets[idx + 1];
+            for (size_t i = start_edge; i < end_edge && !on_boundary; ++i) {
+                if (cc.built && cc.edge_chain[i] >= 0) {
+                    continue;
+                }
+                on_boundary = outside(distOf((size_t)gdata.edges[i].target));
+            }
+            auto it_chains = cc.built ? cc.chains_at.find(node) : cc.chains_at.end();
+            if (!on_boundary && it_chains != cc.chains_at.end()) {
+                for (int chain : it_chains->second) {
+                    if (cc.from[chain] == node) {
+                        on_boundary |= outside(timeOf(cc.interior[cc.first[chain]]));
+                    }
+                    if (cc.to[chain] == node) {
+                        on_boundary |= outside(timeOf(cc.interior[cc.first[chain + 1] - 1]));
+                    }
+                }
+            }
+            if (!on_boundary) {
+                continue;
+            }
+        }
+        reached.push_back({ node, distOf(idx) });
+    }
+    if (!reduced) {
+        return true;
+    }
+
+    for (const auto& [node, time] : extra.time) {
+        if (outside(time)) {
+            continue;
+        }
+        if (boundary_only) {
+            bool on_boundary = extra.far_child.count(node) > 0;
+            auto it_tree = tp.built ? tp.position.find(node) : tp.position.end();
+            if (it_tree != tp.position.end()) {
+                int par = tp.parent[it_tree->second];
+                on_boundary |= outside(timeOf((par < 0) ? tp.attachment[it_tree->second] : tp.node[par]));
+            }
+            else {
+                size_t slot = cc.position.at(node);
+                int chain = (int)(std::upper_bound(cc.first.begin(), cc.first.end(), slot) - cc.first.begin()) - 1;
+                int prev = (slot == cc.first[chain]) ? cc.from[chain] : cc.interior[slot - 1];
+                int next = (slot + 1 == cc.first[chain + 1]) ? cc.to[chain] : cc.interior[slot + 1];
+                on_boundary |= outside(timeOf(prev)) || outside(timeOf(next));
+            }
+            if (!on_boundary) {
+                continue;
+            }
+        }
+        reached.push_back({ node, time });
+    }
+    std::stable_sort(reached.begin(), reached.end(), [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+        return a.second < b.second;
+    });
+
+    return true;
+}
@@ -0,0 +1,390 @@
+﻿#include "incl.h"
+#include "decl.h"
+#include "search.h"
+
+namespace {
+    /**
+     * @brief Computes the range of every landmark distance over the nodes of a set.
+     *
+     * @detailed
+     * Fills `set.alt_min` / `set.alt_max` from the full landmark rows; a landmark that does
+     * not reach every node gets `-1` and is ignored by the bound. Both stay empty without
+     * landmarks or with compact (16-bit) rows, which the ALT nearest search does not use.
+     *
+     * @param gdata Reference to the graph data (landmark rows).
+     * @param set The set to update.
+     *
+     * @complexity
+     * - Time Complexity: O(P × L), with `P` nodes in the set and `L` landmarks.
+     * - Space Complexity: O(L).
+     */
+    void computePoiBounds(const graph& gdata, poi_set& set)
+    {
+        const auto& table = gdata.dist_landmark;
+        set.alt_min.clear();
+        set.alt_max.clear();
+        if (table.empty() || table.compact) {
+            return;
+        }
+
+        set.alt_min.assign(table.landmark_count, std::numeric_limits<int>::max());
+        set.alt_max.assign(table.landmark_count, 0);
+        for (int idx : set.nodes) {
+            const int* row = table.row((size_t)idx);
+            for (size_t l = 0; l < table.landmark_count; ++l) {
+                if (row[l] < 0 || set.alt_min[l] < 0) {
+                    set.alt_min[l] = -1;
+                    continue;
+                }
+                set.alt_min[l] = std::min(set.alt_min[l], row[l]);
+                set.alt_max[l] = std::max(set.alt_max[l], row[l]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Loads the named target sets stored in the POI folder.
+ *
+ * @detailed
+ * Every `<name>.txt` file inside `conf.poi_folder` defines a set called `<name>`,
+ * with one node ID per line (empty lines and lines starting with `#` are ignored).
+ *
+ * Functionality:
+ * - Unknown node IDs are logged and skipped, duplicates are merged.
+ * - Nodes removed by `prune_trees` or `compress_chains` are registered under their exits
+ *   (`searchGraphExits()`), which join the member indices used by the ALT bound.
+ * - The landmark ranges of each set are computed (`computePoiBounds()`).
+ * - Empty sets are ignored.
+ *
+ * @param gdata Reference to the graph data (sets are stored in `gdata.poi_sets`).
+ * @param conf Reference to the configuration settings (POI folder).
+ *
+ * @complexity
+ * - Time Complexity: O(P × L) per set, with `P` the number of lines and `L` landmarks.
+ * - Space Complexity: O(V / 8 + P + L) per set.
+ */
+void loadPoiSets(graph& gdata, const config& conf)
+{
+    std::error_code ec;
+    if (conf.poi_folder.empty() || !std::filesystem::is_directory(conf.poi_folder, ec)) {
+        return;
+    }
+
+    const size_t node_count = gdata.index_to_node.size();
+
+    for (const auto& entry : std::filesystem::directory_iterator(conf.poi_folder, ec)) {
+        if (!entry.is_regular_file() || entry.path().extension() != ".txt") {
+            continue;
+        }
+
+        poi_set set;
+        set.name = entry.path().stem().string();
+        set.is_member.assign(node_count, false);
+
+        std::ifstream ifs(entry.path());
+        std::string line;
+        size_t line_num = 0;
+        size_t skipped = 0;
+        size_t reduced = 0;
+        std::unordered_set<int> reduced_seen;
+        while (std::getline(ifs, line)) {
+            line_num++;
+            line.erase(std::remove_if(line.begin(), line.end(), [](unsigned char ch) { return std::isspace(ch); }), line.end());
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            try {
+                size_t consumed = 0;
+                int node = std::stoi(line, &consumed);
+                auto it = gdata.node_to_index.find(node);
+                if (consumed == line.size() && isReducedNode(gdata, node)) {
+                    if (reduced_seen.insert(node).second) {
+                        reduced++;
+                        for (const auto& exit : searchGraphExits(gdata, node)) {
+                            set.reduced[gdata.node_to_index.at(exit.first)].push_back(node);
+                        }
+                    }
+                    continue;
+                }
+                if (consumed != line.size() || it == gdata.node_to_index.end()) {
+                    throw std::invalid_argument("unknown node");
+                }
+                if (!set.is_member[it->second]) {
+                    set.is_member[it->second] = true;
+                    set.nodes.push_back((int)it->second);
+                }
+            }
+            catch (...) {
+                skipped++;
+                logger("warning: invalid node at line " + std::to_string(line_num) + " of " + entry.path().string() + " - skipping line.");
+            }
+        }
+
+        size_t members = set.nodes.size() + reduced;
+        for (const auto& entry : set.reduced) {
+            if (!set.is_member[entry.first]) {
+                set.nodes.push_back((int)entry.first);
+            }
+        }
+        if (set.nodes.empty()) {
+            console("warning", "POI set '" + set.name + "' is empty, ignoring it.");
+            logger("warning: POI set '" + set.name + "' is empty, ignoring it.");
+            continue;
+        }
+
+        console("success", "POI set '" + set.name + "' loaded (" + std::to_string(members) + " nodes, " + std::to_string(reduced) + " removed by graph reduction, " + std::to_string(skipped) + " skipped).");
+        logger("POI set '" + set.name + "' loaded: " + std::to_string(members) + " nodes, " + std::to_string(reduced) + " removed by graph reduction, " + std::to_string(skipped) + " skipped.");
+        computePoiBounds(gdata, set);
+        std::string name = set.name;
+        gdata.poi_sets[name] = std::move(set);
+    }
+}
+
+/**
+ * @brief Recomputes the landmark ranges of every POI set after the landmark rows changed.
+ *
+ * @param gdata Reference to the graph data.
+ *
+ * @complexity
+ * - Time Complexity: O(P × L) over all sets.
+ * - Space Complexity: O(1).
+ */
+void refreshPoiBounds(graph& gdata)
+{
+    for (auto& entry : gdata.poi_sets) {
+        computePoiBounds(gdata, entry.second);
+    }
+}
+
+/**
+ * @brief Computes an ALT lower bound from a node to the closest member of a set.
+ *
+ * @detailed
+ * For every member `p`, the triangle inequality gives `d(n, p) >= |d_L(p) - d_L(n)|`, and
+ * `d_L(p)` lies in `[min_L, max_L]` (`set.alt_min` / `set.alt_max`), so every member is at
+ * least as far as the gap between `d_L(n)` and that range:
+ *
+ *      h(n) = max_L { max(0, min_L - d_L(n), d_L(n) - max_L) }
+ *
+ * which is admissible and consistent (each term moves by at most `|d_L(n) - d_L(m)|`
+ * along an edge `(n, m)`), and costs O(L) whatever the size of the set. A member removed
+ * by graph reduction is at least as far as one of its exits, so the ranges include the
+ * exits in its place. The table `slack` is subtracted like in `landmarkLowerBound()`.
+ *
+ * @complexity
+ * - Time Complexity: O(L), with `L` landmarks.
+ * - Space Complexity: O(1).
+ */
+static inline int poiLowerBound(size_t idx, const poi_set& set, const graph& gdata)
+{
+    if (set.is_member[idx]) {
+        return 0;
+    }
+
+    const auto& table = gdata.dist_landmark;
+    const int* row = table.row(idx);
+    int best_val = 0;
+    for (size_t l = 0; l < table.landmark_count; ++l) {
+        if (row[l] < 0 || set.alt_min[l] < 0) {
+            continue;
+        }
+        best_val = std::max({ best_val, set.alt_min[l] - row[l], row[l] - set.alt_max[l] });
+    }
+    return std::max(best_val - table.slack, 0);
+}
+
+/**
+ * @brief Finds the `k` members of a registered set closest to `start_node` by travel time.
+ *
+ * @detailed
+ * Plain variant (no landmarks): a Dijkstra expansion from the start node that stops as soon
+ * as `k` members have been settled.
+ *
+ * Accelerated variant (ALT enabled): an A* search towards the whole set, guided by
+ * `poiLowerBound()`. Because the bound is consistent, members are settled in increasing
+ * order of their exact distance, so the search can still stop after `k` members, but it
+ * only explores the area in the direction of the closest members. The bound only reads the
+ * landmark ranges of the set, so its cost does not grow with the set.
+ *
+ * Compact (16-bit) landmark tables use the plain variant: their rounded bounds are not
+ * consistent, so members would not be settled in order. The same holds while live weight
+ * decreases are not repaired (`dist_landmark.slack > 0`): the bound minus the slack is
+ * still admissible, but no longer consistent.
+ *
+ * Graph reduction: a removed start seeds the search from its exits (`searchGraphExits()`),
+ * and a removed member is offered at `d(exit) + cost` when one of its exits is settled
+ * (plus the walk inside a shared tree or chain, `reducedLocalDistance()`). Offers wait in
+ * a heap and are only returned once the search key reaches them: no later exit can improve
+ * them, since exits have a bound of `0`.
+ *
+ * Both variants poll `buffers.cancel`; once it expires the search stops with the members
+ * found so far and `buffers.cancel.cancelled` is set.
+ *
+ * @param gdata Reference to the graph data.
+ * @param buffers Reference to `search_buffers` for optimized memory management.
+ * @param conf Configuration settings (ALT usage).
+ * @param start_node The source node ID.
+ * @param set_name Name of the registered set.
+ * @param k Number of members to return.
+ * @param nearest Output list of `(node ID, time)` pairs, sorted by time.
+ * @return `false` if the start node or the set does not exist.
+ *
+ * @complexity
+ * - Time Complexity: O(E' log V') with `V'`/`E'` the explored nodes/edges.
+ * - Space Complexity: O(V') for the priority queue.
+ */
+bool findNearestTargets(const graph& gdata, search_buffers& buffers, const config& conf, int start_node, const std::string& set_name, int k, std::vector<std::pair<int, int>>& nearest)
+{
+    nearest.clear();
+
+    auto it_set = gdata.poi_sets.find(set_name);
+    auto exits = searchGraphExits(gdata, start_node);
+    if (exits.empty() || it_set == gdata.poi_sets.end() || k <= 0) {
+        return false;
+    }
+
+    const poi_set& set = it_set->second;
+    size_t member_count = 0;
+    for (int idx : set.nodes) {
+        member_count += set.is_member[idx];
+    }
+    for (const auto& entry : set.reduced) {
+        member_count += entry.second.size();
+    }
+    const size_t wanted = std::min<size_t>((size_t)k, member_count);
+
+    std::vector<std::pair<size_t, int>> seeds;
+    for (const auto& [node, cost] : exits) {
+        seeds.push_back({ gdata.node_to_index.at(node), cost });
+    }
+
+    // offers (time, member ID), returned once the search key reaches them.
+    std::unordered_map<int, int> best;
+    using offer_item = std::pair<int, int>;
+    std::priority_queue<offer_item, std::vector<offer_item>, std::greater<offer_item>> offers;
+    auto offer = [&](int member, int time) {
+        auto [it, inserted] = best.try_emplace(member, time);
+        if (!inserted) {
+            if (time >= it->second) {
+                return;
+            }
+            it->second = time;
+        }
+        offers.push({ time, member });
+    };
+    auto release = [&](long long key) {
+        while (!offers.empty() && nearest.size() < wanted && offers.top().first <= key) {
+            auto [time, member] = offers.top();
+            offers.pop();
+            if (best[member] == time) {
+                nearest.push_back({ member, time });
+            }
+        }
+    };
+    auto settleMember = [&](size_t idx, int dist) {
+        if (set.is_member[idx]) {
+            offer(gdata.index_to_node[idx], dist);
+        }
+        if (!set.reduced.empty()) {
+            auto it = set.reduced.find(idx);
+            if (it != set.reduced.end()) {
+                for (int member : it->second) {
+                    for (const auto& [node, cost] : searchGraphExits(gdata, member)) {
+                        if (node == gdata.index_to_node[idx]) {
+                            offer(member, dist + cost);
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    if (isReducedNode(gdata, start_node)) {
+        for (const auto& exit : exits) {
+            auto it = set.reduced.find(gdata.node_to_index.at(exit.first));
+            if (it == set.reduced.end()) {
+                continue;
+            }
+            for (int member : it->second) {
+                int direct = reducedLocalDistance(gdata, start_node, member);
+                if (direct >= 0) {
+                    offer(member, direct);
+                }
+            }
+        }
+    }
+
+    if (!conf.use_alt || gdata.dist_landmark.empty() || gdata.dist_landmark.compact || gdata.dist_landmark.slack > 0
+        || set.alt_min.size() != gdata.dist_landmark.landmark_count) {
+        dijkstraFromSeeds<false>(gdata, buffers, seeds, [&](size_t idx, int dist) {
+            settleMember(idx, dist);
+            release(dist);
+            return nearest.size() < wanted;
+        });
+        if (!buffers.cancel.cancelled) {
+            release(std::numeric_limits<long long>::max());
+        }
+        return true;
+    }
+
+    buffers.current_search_id++;
+
+    using pq_item = std::pair<int, size_t>;
+    std::priority_queue<pq_item, std::vector<pq_item>, std::greater<pq_item>> open_list;
+
+    for (const auto& [seed_idx, seed_dist] : seeds) {
+        int old_g = getDistFromStart(buffers, seed_idx);
+        if (old_g >= 0 && old_g <= seed_dist) {
+            continue;
+        }
+        setDistFromStart(buffers, seed_idx, seed_dist);
+        int h_seed = getHForward(buffers, seed_idx);
+        if (h_seed < 0) {
+            h_seed = poiLowerBound(seed_idx, set, gdata);
+            setHForward(buffers, seed_idx, h_seed);
+        }
+        open_list.push({ seed_dist + h_seed, seed_idx });
+    }
+    size_t polls = 0;
+
+    while (!open_list.empty() && nearest.size() < wanted) {
+        auto [cur_f, cur_idx] = open_list.top();
+        open_list.pop();
+
+        int cur_g = getDistFromStart(buffers, cur_idx);
+        if (cur_g + getHForward(buffers, cur_idx) != cur_f) {
+            continue;
+        }
+        if (buffers.cancel.poll(polls)) {
+            buffers.cancel.cancelled = true;
+            break;
+        }
+        settleMember(cur_idx, cur_g);
+        release(cur_f);
+
+        size_t start_edge = gdata.offsets[cur_idx];
+        size_t end_edge = gdata.offsets[cur_idx + 1];
+
+        for (size_t i = start_edge; i < end_edge; ++i) {
+            size_t nbr_idx = (size_t)gdata.edges[i].target;
+            int new_g = cur_g + gdata.edges[i].weight;
+            int old_g = getDistFromStart(buffers, nbr_idx);
+            if (old_g >= 0 && new_g >= old_g) {
+                continue;
+            }
+            setDistFromStart(buffers, nbr_idx, new_g);
+            int h_val = getHForward(buffers, nbr_idx);
+            if (h_val < 0) {
+                h_val = poiLowerBound(nbr_idx, set, gdata);
+                setHForward(buffers, nbr_idx, h_val);
+            }
+            open_list.push({ new_g + h_val, nbr_idx });
+        }
+    }
+    if (!buffers.cancel.cancelled) {
+        release(std::numeric_limits<long long>::max());
+    }
+
+    return true;
+}
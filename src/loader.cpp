@@ -23,16 +23,23 @@
  * - Builds a reverse mapping (`index_to_node`) for quick lookups of node identifiers by index.
  * - Clears the original edge vector after processing to conserve memory.
  * - Logs the progress and key statistics (total lines processed, unique nodes) via console and logger.
+ * - Optionally builds a contraction hierarchy (used by PHAST one-to-all queries) if enabled in the configuration.
  * - Optionally invokes ALT (A*, Landmarks, and Triangle inequality) pre-processing if enabled in the configuration.
  *
  * Processing Steps:
  * - First pass: Iterate through edges to assign unique indices to nodes using a hash map.
- * - Compute node degrees to determine adjacency list offsets.
+ * - Compute node degrees to determine adjacency list offsets (plus a final `edges.size()`
+ *   sentinel, so the edges of any node `v` are `[offsets[v], offsets[v + 1])`).
  * - Allocate adjacency list storage (`edges`) and populate it with bidirectional connections.
  * - Construct a reverse mapping vector (`index_to_node`) for node lookups.
  * - Clear the original edge list to free memory.
  * - Log progress messages and summary statistics.
+ * - If tree pruning and/or chain compression are enabled, call `pruneTrees` then `compressChains`
+ *   first: every later step (and every engine) then works on the reduced graph.
+ * - If contraction hierarchies are enabled, call `buildContractionHierarchy` (before ALT, which then uses PHAST).
  * - If ALT heuristics are enabled in the configuration, call `preprocessAlt` for further pre-processing.
+ * - For the core-ALT (`3`) and CCH (`4`) engines, build their own preprocessing.
+ * - Load the named target sets of the POI folder (after ALT, as they index landmark distances).
  *
  * Edge Case Handling:
  * - If no edges exist, an empty graph is returned.
@@ -75,12 +82,13 @@ graph loadGraphData(config& conf, std::vector<edge>& edges)
         degrees[ib]++;
     }
 
-    gdata.offsets.resize(num_nodes);
+    gdata.offsets.resize(num_nodes + 1);
     size_t total_edges = 0;
     for (size_t i = 0; i < num_nodes; ++i) {
         gdata.offsets[i] = total_edges;
         total_edges += degrees[i];
     }
+    gdata.offsets[num_nodes] = total_edges;
 
     gdata.edges.resize(total_edges);
     std::vector<size_t> current(num_nodes, 0);
@@ -112,12 +120,43 @@ graph loadGraphData(config& conf, std::vector<edge>& edges)
     logger("total lines processed: " + std::to_string(gdata.line_count));
     logger("total unique nodes: " + std::to_string(gdata.node_to_index.size()));
 
+    if (conf.prune_trees) {
+        pruneTrees(gdata);
+    }
+
+    if (conf.compress_chains) {
+        compressChains(gdata);
+    }
+
+    if (conf.use_ch) {
+        buildContractionHierarchy(gdata);
+    }
+
     if (conf.use_alt) {
         console("info", "starting ALT pre-processing.");
         logger("starting ALT pre-processing.");
         preprocessAlt(gdata, conf);
+        console("info", "ALT heuristic kernel: " + altKernelName());
+        logger("ALT heuristic kernel: " + altKernelName());
     }
 
+    if (conf.search_engine == 3) {
+        console("info", "starting core-ALT pre-processing.");
+        logger("starting core-ALT pre-processing.");
+        preprocessCoreAlt(gdata, conf);
+    }
+
+    if (conf.search_engine == 4) {
+        buildCustomizableHierarchy(gdata);
+        std::vector<int> edge_weights(gdata.edges.size());
+        for (size_t i = 0; i < gdata.edges.size(); ++i) {
+            edge_weights[i] = gdata.edges[i].weight;
+        }
+        gdata.cch.metric = customizeCch(gdata, edge_weights, conf.nb_threads);
+    }
+
+    loadPoiSets(gdata, conf);
+
     return gdata;
 }
 
@@ -44,12 +44,13 @@ void printMenu(std::string step)
 }
 
 // ✅ function verified.
-int main() 
+int main(int argc, char* argv[]) 
 {	
 	std::ios::sync_with_stdio(false);
 	std::cin.tie(nullptr);
 
 	config conf;
+    const bool check_mode = (argc > 1 && std::string(argv[1]) == "--check");
 
 	printMenu("configuration (1/3)");
 
@@ -104,14 +105,46 @@ int main()
         logger("connectivity check passed without any error. continueing.");
     }
     
+    configureHugePages(conf.huge_pages, conf.lock_memory);
+    if (conf.huge_pages > 0 || conf.lock_memory) {
+        static const char* modes[] = { "default", "transparent", "reserved" };
+        console("info", std::string("large arrays use ") + modes[conf.huge_pages] + " pages" + (conf.lock_memory ? ", pre-faulted and locked." : "."));
+        logger(std::string("large arrays use ") + modes[conf.huge_pages] + " pages" + (conf.lock_memory ? ", pre-faulted and locked." : "."));
+    }
+
     graph gdata;
 
     gdata = loadGraphData(conf, edges);
+
+    unidirectional_kernels = makeSearchKernels(gdata, conf, true);
+    console("info", "unidirectional search kernel: " + unidirectional_kernels.name + ".");
+    logger("unidirectional search kernel: " + unidirectional_kernels.name + ".");
     
     search_buffers buffers;
     initializeSearchBuffers(gdata, buffers);
     console("success", "search buffers succefully initialized.");
 
+    std::vector<search_buffers> pool;
+    initializeBufferPool(gdata, pool, conf.nb_threads);
+    console("success", "worker buffers succefully initialized (" + std::to_string(pool.size()) + " workers).");
+
+    numa_layout numa;
+    if (conf.numa_aware) {
+        numa = detectNumaTopology();
+        setupNumaPlacement(gdata, buffers, pool, numa);
+    }
+
+    route_cache cache;
+    initializeRouteCache(cache, conf.cache_size);
+
+    if (check_mode) {
+        printMenu("checks");
+        bool passed = checkLiveUpdates(gdata, conf);
+        passed = checkChainUpdates(gdata, conf) && passed;
+        closeLogger();
+        return passed ? 0 : 1;
+    }
+
 #if defined(_WIN32) || defined(_WIN64)
     Sleep(3000);
 #else
@@ -121,8 +154,16 @@ int main()
     printMenu("ready (3/3)");
 
     storePerf(gdata);
+    if (conf.benchmark) {
+        benchmarkSingleSource(gdata, conf);
+        benchmarkHugePages(gdata, conf);
+        benchmarkSearchKernels(gdata, conf);
+    }
+    if (conf.log && conf.use_alt) {
+        benchmarkAltSearchSpace(gdata, buffers, conf);
+    }
 
-    std::thread apiThread(launchApiGateway, std::ref(gdata), std::ref(buffers), std::ref(conf));
+    std::thread apiThread(launchApiGateway, std::ref(gdata), std::ref(buffers), std::ref(pool), std::ref(numa), std::ref(cache), std::ref(conf));
     apiThread.detach();
 
     std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
@@ -0,0 +1,148 @@
+﻿#include "incl.h"
+#include "decl.h"
+#include "search.h"
+
+/**
+ * @brief Computes a dense many-to-many travel-time matrix.
+ *
+ * @detailed
+ * This function answers an N×M distance table in one batch instead of N×M
+ * independent point-to-point queries. It runs one Dijkstra expansion per source
+ * and stops it as soon as every requested target has been settled, so the work
+ * for all targets of a row is shared by a single search.
+ *
+ * Functionality:
+ * - Maps every target node to its column(s) once (duplicated targets are allowed).
+ * - Nodes removed by `prune_trees` / `compress_chains` are reached through their exits
+ *   (`searchGraphExits()`): a removed source seeds the search from its exits, and a removed
+ *   target takes the best of its exits plus their cost. When both nodes of a cell are
+ *   removed and share an exit, the path inside their tree or chain is checked too
+ *   (`reducedLocalDistance()`).
+ * - Distributes the sources over the worker pool through an atomic counter; with NUMA
+ *   placement, each worker is pinned to its node and reads the local graph replica.
+ * - Each worker uses its own `search_buffers`, so no synchronization is needed
+ *   inside the searches and the versioned buffers avoid any O(N) reset.
+ * - Each row stops early once all distinct targets (or their exits) are settled.
+ * - Each worker honours the deadline armed in its own `search_buffers::cancel`: it is
+ *   polled inside the expansions and checked before each new row. A worker that gives
+ *   up sets its `cancel.cancelled`, and the remaining cells stay at `-1`.
+ *
+ * Output Format:
+ * - Row-major vector of size `sources.size() * targets.size()`.
+ * - `matrix[i * targets.size() + j]` is the travel time from `sources[i]` to `targets[j]`.
+ * - `-1` marks an unknown node or an unreachable target.
+ *
+ * @param gdata Reference to the graph data.
+ * @param pool Worker buffers, one per thread (must be initialized, with their `cancel` armed by the caller).
+ * @param numa Worker placement (see `setupNumaPlacement()`).
+ * @param sources List of source node IDs.
+ * @param targets List of target node IDs.
+ * @return The flattened distance matrix.
+ *
+ * @complexity
+ * - Time Complexity: O(N × E log V) in the worst case, divided by the number of workers.
+ * - Space Complexity: O(N × M) for the result, plus O(M) for the target lookup.
+ */
+std::vector<int> computeDistanceMatrix(const graph& gdata, std::vector<search_buffers>& pool, const numa_layout& numa, const std::vector<int>& sources, const std::vector<int>& targets)
+{
+    const size_t nb_sources = sources.size();
+    const size_t nb_targets = targets.size();
+    std::vector<int> matrix(nb_sources * nb_targets, -1);
+
+    if (nb_sources == 0 || nb_targets == 0 || pool.empty()) {
+        return matrix;
+    }
+
+    std::unordered_map<size_t, std::vector<std::pair<size_t, int>>> target_columns;   // exit index -> (column, cost)
+    std::vector<std::vector<std::pair<int, int>>> reduced_exits(nb_targets);
+    target_columns.reserve(nb_targets);
+    for (size_t j = 0; j < nb_targets; ++j) {
+        auto exits = searchGraphExits(gdata, targets[j]);
+        for (const auto& [node, cost] : exits) {
+            target_columns[gdata.node_to_index.at(node)].push_back({ j, cost });
+        }
+        if (isReducedNode(gdata, targets[j])) {
+            reduced_exits[j] = std::move(exits);
+        }
+    }
+
+    if (target_columns.empty()) {
+        return matrix;
+    }
+
+    std::atomic<size_t> next_source(0);
+
+    auto workerFunc = [&](const graph& local, search_buffers& buffers) {
+        while (true) {
+            size_t i = next_source.fetch_add(1, std::memory_order_relaxed);
+            if (i >= nb_sources) {
+                break;
+            }
+            if (buffers.cancel.expired()) {
+                buffers.cancel.cancelled = true;
+            }
+            if (buffers.cancel.cancelled) {
+                break;
+            }
+
+            auto exits = searchGraphExits(local, sources[i]);
+            if (exits.empty()) {
+                continue;
+            }
+            std::vector<std::pair<size_t, int>> seeds;
+            for (const auto& [node, cost] : exits) {
+                seeds.push_back({ local.node_to_index.at(node), cost });
+            }
+
+            int* row = matrix.data() + i * nb_targets;
+            size_t remaining = target_columns.size();
+
+            dijkstraFromSeeds<false>(local, buffers, seeds, [&](size_t idx, int dist) {
+                auto it_col = target_columns.find(idx);
+                if (it_col == target_columns.end()) {
+                    return true;
+                }
+                for (const auto& [j, cost] : it_col->second) {
+                    if (row[j] < 0 || dist + cost < row[j]) {
+                        row[j] = dist + cost;
+                    }
+                }
+                return --remaining > 0;
+            });
+
+            if (!isReducedNode(local, sources[i])) {
+                continue;
+            }
+            for (size_t j = 0; j < nb_targets; ++j) {
+                bool shared = std::any_of(reduced_exits[j].begin(), reduced_exits[j].end(), [&](const std::pair<int, int>& target_exit) {
+                    return std::any_of(exits.begin(), exits.end(), [&](const std::pair<int, int>& source_exit) { return source_exit.first == target_exit.first; });
+                });
+                if (shared) {
+                    int direct = reducedLocalDistance(local, sources[i], targets[j]);
+                    if (direct >= 0 && (row[j] < 0 || direct < row[j])) {
+                        row[j] = direct;
+                    }
+                }
+            }
+        }
+    };
+
+    size_t nb_workers = std::min(pool.size(), nb_sources);
+    if (nb_workers == 1) {
+        workerFunc(gdata, pool[0]);
+        return matrix;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(nb_workers);
+    for (size_t w = 0; w < nb_workers; ++w) {
+        workers.emplace_back([&, w]() {
+            workerFunc(enterNumaWorker(gdata, numa, w), pool[w]);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    return matrix;
+}
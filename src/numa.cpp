@@ -0,0 +1,362 @@
+﻿#include "incl.h"
+#include "decl.h"
+
+namespace {
+    // Memory policy constants of <numaif.h>, kept here so libnuma is not needed.
+    constexpr int mpol_preferred = 1;
+    constexpr int mpol_interleave = 3;
+    constexpr unsigned mpol_mf_move = 1u << 1;
+    constexpr size_t max_policy_nodes = 64;
+    constexpr size_t huge_page_bytes = 2 * 1024 * 1024;
+
+    /**
+     * @brief Parses a sysfs CPU list such as `0-3,8-11`.
+     */
+    std::vector<int> parseCpuList(const std::string& list)
+    {
+        std::vector<int> cpus;
+        std::stringstream ss(list);
+        std::string range;
+        while (std::getline(ss, range, ',')) {
+            range.erase(std::remove_if(range.begin(), range.end(), ::isspace), range.end());
+            if (range.empty()) {
+                continue;
+            }
+            size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+
+    /**
+     * @brief Applies a memory policy to one large graph array and migrates its pages.
+     *
+     * @detailed
+     * Only blocks of 2 MB or more are moved: they come from `hugePageAllocate()` and are
+     * mapped on 2 MB boundaries, as `mbind` requires. Smaller arrays stay where they are.
+     *
+     * @return `false` if the kernel refused the policy (no NUMA support, node without memory).
+     */
+    bool placeRange(const void* ptr, size_t bytes, int policy, const std::vector<int>& nodes)
+    {
+#ifdef IS_LINUX
+        if (!ptr || bytes < huge_page_bytes) {
+            return true;
+        }
+        unsigned long mask = 0;
+        for (int node : nodes) {
+            if (node >= 0 && (size_t)node < max_policy_nodes) {
+                mask |= 1ul << node;
+            }
+        }
+        size_t len = (bytes + huge_page_bytes - 1) / huge_page_bytes * huge_page_bytes;
+        return syscall(SYS_mbind, const_cast<void*>(ptr), len, policy, &mask, max_policy_nodes + 1, mpol_mf_move) == 0;
+#else
+        (void)ptr; (void)bytes; (void)policy; (void)nodes;
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Applies `placeRange()` to the CSR and the landmark rows of `gdata`.
+     *
+     * @return Number of arrays the kernel refused to place.
+     */
+    size_t placeGraphArrays(const graph& gdata, int policy, const std::vector<int>& nodes)
+    {
+        size_t failures = 0;
+        failures += !placeRange(gdata.offsets.data(), gdata.offsets.size() * sizeof(size_t), policy, nodes);
+        failures += !placeRange(gdata.edges.data(), gdata.edges.size() * sizeof(graph::edge_repr), policy, nodes);
+        if (!gdata.dist_landmark.mapped_rows) {
+            failures += !placeRange(gdata.dist_landmark.data.data(), gdata.dist_landmark.data.size() * sizeof(int), policy, nodes);
+            failures += !placeRange(gdata.dist_landmark.data16.data(), gdata.dist_landmark.data16.size() * sizeof(uint16_t), policy, nodes);
+        }
+        return failures;
+    }
+
+    /**
+     * @brief Estimates the memory of one replica built by `buildReplica()`.
+     */
+    size_t replicaBytes(const graph& gdata)
+    {
+        const landmark_table& table = gdata.dist_landmark;
+        size_t rows = table.node_count * table.stride * (table.compact ? sizeof(uint16_t) : sizeof(int));
+        return gdata.offsets.size() * sizeof(size_t)
+            + gdata.edges.size() * sizeof(graph::edge_repr)
+            + gdata.index_to_node.size() * sizeof(int)
+            + gdata.node_to_index.size() * (sizeof(std::pair<int, size_t>) + 2 * sizeof(void*))
+            + rows;
+    }
+
+    /**
+     * @brief Copies the read-only arrays used by the pool engines into a new graph.
+     *
+     * @detailed
+     * Meant to run on a thread pinned to the target node: every page is first touched by
+     * the copy, so the kernel places the replica in local memory. Only what the worker
+     * queries read is copied (node maps, CSR, landmarks, pruned trees and chains); the
+     * hierarchies, POI sets and update bookkeeping stay in `gdata`. Landmark rows read
+     * from a mapped ALT file are copied out of the mapping.
+     *
+     * @param gdata Reference to the graph data.
+     * @return The replica.
+     *
+     * @complexity
+     * - Time Complexity: O(V + E + V × L).
+     * - Space Complexity: O(V + E + V × L).
+     */
+    std::unique_ptr<graph> buildReplica(const graph& gdata)
+    {
+        auto replica = std::make_unique<graph>();
+        replica->node_to_index = gdata.node_to_index;
+        replica->index_to_node = gdata.index_to_node;
+        replica->line_count = gdata.line_count;
+        replica->index_count = gdata.index_count;
+        replica->offsets = gdata.offsets;
+        replica->edges = gdata.edges;
+        replica->trees = gdata.trees;
+        replica->chains = gdata.chains;
+        replica->dist_landmark = gdata.dist_landmark;
+
+        landmark_table& table = replica->dist_landmark;
+        if (table.mapped_rows) {
+            size_t values = table.node_count * table.stride;
+            if (table.compact) {
+                const uint16_t* rows = static_cast<const uint16_t*>(table.mapped_rows);
+                table.data16.assign(rows, rows + values);
+            }
+            else {
+                const int* rows = static_cast<const int*>(table.mapped_rows);
+                table.data.assign(rows, rows + values);
+            }
+            table.mapped_rows = nullptr;
+            table.mapped_bytes = 0;
+            table.mapping.reset();
+        }
+        return replica;
+    }
+
+    /**
+     * @brief Runs `task` on a temporary thread pinned to the NUMA node at `position`.
+     */
+    void runOnNode(const numa_layout& numa, size_t position, const std::function<void()>& task)
+    {
+        std::thread worker([&]() {
+            pinToNumaNode(numa, position);
+            task();
+        });
+        worker.join();
+    }
+}
+
+/**
+ * @brief Reads the NUMA topology from sysfs.
+ *
+ * @detailed
+ * Lists the `nodeN` directories of `sysfs_root`, and for each one reads its CPUs
+ * (`cpulist`) and free memory (`MemFree` in `meminfo`). Nodes without CPUs (memory-only
+ * expanders) are skipped, since no worker can be pinned next to them. On other platforms,
+ * or if sysfs is unavailable, the layout is left empty.
+ *
+ * @param sysfs_root Node directory (`/sys/devices/system/node`).
+ * @return The detected layout, with `mode = 0` (nothing placed yet).
+ *
+ * @complexity
+ * - Time Complexity: O(C) for `C` CPUs.
+ * - Space Complexity: O(C).
+ */
+numa_layout detectNumaTopology(const std::string& sysfs_root)
+{
+    numa_layout numa;
+#ifdef IS_LINUX
+    std::error_code ec;
+    std::vector<int> node_ids;
+    for (const auto& entry : std::filesystem::directory_iterator(sysfs_root, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() > 4 && name.compare(0, 4, "node") == 0
+            && std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+            node_ids.push_back(std::stoi(name.substr(4)));
+        }
+    }
+    std::sort(node_ids.begin(), node_ids.end());
+
+    for (int node : node_ids) {
+        std::string folder = sysfs_root + "/node" + std::to_string(node);
+        std::ifstream cpulist(folder + "/cpulist");
+        std::string list;
+        std::getline(cpulist, list);
+        std::vector<int> cpus = parseCpuList(list);
+        if (cpus.empty()) {
+            continue;
+        }
+
+        size_t free_bytes = 0;
+        std::ifstream meminfo(folder + "/meminfo");
+        std::string line;
+        while (std::getline(meminfo, line)) {
+            size_t pos = line.find("MemFree:");
+            if (pos != std::string::npos) {
+                free_bytes = (size_t)std::stoull(line.substr(pos + 8)) * 1024;
+                break;
+            }
+        }
+
+        numa.nodes.push_back(node);
+        numa.node_cpus.push_back(std::move(cpus));
+        numa.node_free_bytes.push_back(free_bytes);
+    }
+#else
+    (void)sysfs_root;
+#endif
+    return numa;
+}
+
+/**
+ * @brief Restricts the calling thread to the CPUs of the NUMA node at `position`.
+ *
+ * @param numa Detected layout.
+ * @param position Index in `numa.nodes` (not the sysfs node ID).
+ * @return `false` if the affinity could not be set (unsupported platform, bad position).
+ */
+bool pinToNumaNode(const numa_layout& numa, size_t position)
+{
+#ifdef IS_LINUX
+    if (position >= numa.node_cpus.size()) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : numa.node_cpus[position]) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)numa; (void)position;
+    return false;
+#endif
+}
+
+/**
+ * @brief Places the graph, its replicas and the search buffers on the NUMA nodes.
+ *
+ * @detailed
+ * Does nothing on a single node machine. Otherwise:
+ * - Replicated mode (when every other node has room for a replica plus 25%): the large
+ *   arrays of `gdata` are moved to the first node, and each other node gets a replica
+ *   built by a thread pinned to it (see `buildReplica()`).
+ * - Interleaved mode (memory is tight): the large arrays of `gdata` are spread page by
+ *   page over all nodes, so no node serves every access.
+ *
+ * Pool workers are assigned to nodes round-robin and their buffers are rebuilt by a
+ * thread pinned to that node; the API thread's buffers are rebuilt on the first node,
+ * where `launchApiGateway()` pins the API thread.
+ *
+ * @param gdata Reference to the graph data.
+ * @param buffers Search buffers of the API thread.
+ * @param pool Worker buffers (already sized by `initializeBufferPool()`).
+ * @param numa Layout from `detectNumaTopology()`, completed here.
+ *
+ * @complexity
+ * - Time Complexity: O(K × (V + E + V × L)) for `K` nodes.
+ * - Space Complexity: O((K - 1) × (V + E + V × L)) in replicated mode.
+ */
+void setupNumaPlacement(graph& gdata, search_buffers& buffers, std::vector<search_buffers>& pool, numa_layout& numa)
+{
+    const size_t nb_nodes = numa.nodes.size();
+    if (nb_nodes < 2) {
+        numa.mode = 0;
+        console("info", "single NUMA node detected, numa placement is not needed.");
+        logger("single NUMA node detected, numa placement is not needed.");
+        return;
+    }
+
+    size_t replica_bytes = replicaBytes(gdata);
+    bool fits = true;
+    for (size_t k = 1; k < nb_nodes; ++k) {
+        fits = fits && numa.node_free_bytes[k] >= replica_bytes + replica_bytes / 4;
+    }
+    numa.mode = fits ? 1 : 2;
+
+    size_t failures = 0;
+    if (numa.mode == 1) {
+        failures = placeGraphArrays(gdata, mpol_preferred, { numa.nodes[0] });
+        numa.replicas.clear();
+        numa.replicas.resize(nb_nodes);
+        for (size_t k = 1; k < nb_nodes; ++k) {
+            runOnNode(numa, k, [&]() { numa.replicas[k] = buildReplica(gdata); });
+        }
+    }
+    else {
+        failures = placeGraphArrays(gdata, mpol_interleave, numa.nodes);
+        numa.replicas.clear();
+    }
+
+    numa.worker_node.resize(pool.size());
+    for (size_t w = 0; w < pool.size(); ++w) {
+        size_t node = w % nb_nodes;
+        numa.worker_node[w] = (int)node;
+        const graph& local = numa.replicas.empty() || !numa.replicas[node] ? gdata : *numa.replicas[node];
+        runOnNode(numa, node, [&]() {
+            pool[w] = search_buffers();
+            initializeSearchBuffers(local, pool[w]);
+        });
+    }
+    runOnNode(numa, 0, [&]() {
+        buffers = search_buffers();
+        initializeSearchBuffers(gdata, buffers);
+    });
+
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(1) << "numa: " << nb_nodes << " nodes, graph "
+       << (numa.mode == 1 ? "replicated (" : "interleaved (") << (double)replica_bytes / 1048576.0 << " MB per copy), "
+       << pool.size() << " workers pinned round-robin.";
+    console("success", ss.str());
+    logger(ss.str());
+    if (failures > 0) {
+        console("warning", "the kernel refused to place " + std::to_string(failures) + " graph arrays (no NUMA memory policy support?).");
+        logger("warning: the kernel refused to place " + std::to_string(failures) + " graph arrays.");
+    }
+}
+
+/**
+ * @brief Rebuilds the replicas after `gdata` changed (live weight updates, landmark repair).
+ *
+ * @param gdata Reference to the graph data.
+ * @param numa Layout set up by `setupNumaPlacement()`.
+ *
+ * @complexity
+ * - Time Complexity: O(K × (V + E + V × L)).
+ * - Space Complexity: O((K - 1) × (V + E + V × L)).
+ */
+void refreshNumaReplicas(const graph& gdata, numa_layout& numa)
+{
+    for (size_t k = 0; k < numa.replicas.size(); ++k) {
+        if (numa.replicas[k]) {
+            runOnNode(numa, k, [&]() { numa.replicas[k] = buildReplica(gdata); });
+        }
+    }
+}
+
+/**
+ * @brief Pins the calling pool thread to the node of `worker` and returns its graph.
+ *
+ * @param gdata Reference to the graph data.
+ * @param numa Layout set up by `setupNumaPlacement()`.
+ * @param worker Index of the worker in the pool.
+ * @return The replica local to the worker, or `gdata` (NUMA off, first node, interleaved).
+ */
+const graph& enterNumaWorker(const graph& gdata, const numa_layout& numa, size_t worker)
+{
+    if (numa.mode == 0 || worker >= numa.worker_node.size()) {
+        return gdata;
+    }
+    size_t node = (size_t)numa.worker_node[worker];
+    pinToNumaNode(numa, node);
+    return (node < numa.replicas.size() && numa.replicas[node]) ? *numa.replicas[node] : gdata;
+}
@@ -33,21 +33,11 @@ size_t estimateUnorderedMapIntSizeT(const std::unordered_map<int, size_t>& m) {
     return total;
 }
 
-template <typename T>
-size_t estimateVector1d(const std::vector<T>& v) {
+template <typename T, typename Alloc>
+size_t estimateVector1d(const std::vector<T, Alloc>& v) {
     return sizeof(v) + (v.capacity() * sizeof(T));
 }
 
-template <typename T>
-size_t estimateVector2d(const std::vector<std::vector<T>>& vec2d) {
-    size_t total = sizeof(vec2d)
-        + (vec2d.capacity() * sizeof(std::vector<T>));
-    for (auto& sub : vec2d) {
-        total += sizeof(sub) + (sub.capacity() * sizeof(T));
-    }
-    return total;
-}
-
 size_t estimateTotalGraphMemory(const graph& g) {
     size_t total = 0;
     total += sizeof(g.line_count);
@@ -56,7 +46,11 @@ size_t estimateTotalGraphMemory(const graph& g) {
     total += estimateVector1d(g.index_to_node);
     total += estimateVector1d(g.offsets);
     total += estimateVector1d(g.edges);
-    total += estimateVector2d(g.dist_landmark);
+    total += g.dist_landmark.byteSize();
+    total += estimateVector1d(g.ch.node_at_pos);
+    total += estimateVector1d(g.ch.pos_of);
+    total += estimateVector1d(g.ch.up_offsets);
+    total += estimateVector1d(g.ch.up_edges);
     return total;
 }
 
@@ -197,7 +191,8 @@ double getProcessMemory() {
  *   - `estimateVector1d(g.index_to_node)`: Estimates memory for the index-to-node vector.
  *   - `estimateVector1d(g.offsets)`: Estimates memory for the CSR offsets.
  *   - `estimateVector1d(g.edges)`: Estimates memory for the CSR edge list.
- *   - `estimateVector2d(g.dist_landmark)`: Computes memory for landmark-to-node distances.
+ *   - `g.dist_landmark.byteSize()`: Memory of the flat landmark distance table (int32 or compact uint16).
+ *   - `estimateVector1d(g.ch.*)`: Estimates memory for the contraction hierarchy (if built).
  *
  * - System Memory Analysis:
  *   - `getSystemMemory(total_ram_mb, free_ram_mb)`: Retrieves total and free system RAM.
@@ -259,7 +254,11 @@ void storePerf(const graph& g) {
         static_cast<double>(estimateVector1d(g.edges)) / 1048576.0;
 
     double mem_dist_landmark_mb =
-        static_cast<double>(estimateVector2d(g.dist_landmark)) / 1048576.0;
+        static_cast<double>(g.dist_landmark.byteSize()) / 1048576.0;
+
+    double mem_ch_mb =
+        static_cast<double>(estimateVector1d(g.ch.node_at_pos) + estimateVector1d(g.ch.pos_of)
+            + estimateVector1d(g.ch.up_offsets) + estimateVector1d(g.ch.up_edges)) / 1048576.0;
 
     output_stream.str("");
     output_stream.clear();
@@ -291,6 +290,22 @@ void storePerf(const graph& g) {
     output_stream << "  dist_landmark: " << mem_dist_landmark_mb << " MB";
     logger(output_stream.str());
 
+    output_stream.str("");
+    output_stream.clear();
+    output_stream << "  contraction hierarchy: " << mem_ch_mb << " MB";
+    logger(output_stream.str());
+
+    huge_page_report pages = hugePageCoverage();
+    output_stream.str("");
+    output_stream.clear();
+    output_stream << "huge pages: " << (static_cast<double>(pages.huge_bytes) / 1048576.0) << " MB of "
+        << (static_cast<double>(pages.mapped_bytes) / 1048576.0) << " MB in " << pages.regions << " large blocks ("
+        << (pages.mapped_bytes ? 100.0 * static_cast<double>(pages.huge_bytes) / static_cast<double>(pages.mapped_bytes) : 0.0)
+        << "%), reserved " << (static_cast<double>(pages.explicit_bytes) / 1048576.0) << " MB, locked "
+        << (static_cast<double>(pages.locked_bytes) / 1048576.0) << " MB, " << pages.hugetlb_fallbacks
+        << " reserved pool fallbacks, " << pages.lock_failures << " lock failures";
+    logger(output_stream.str());
+
     double total_graph_mem_mb =
         static_cast<double>(estimateTotalGraphMemory(g)) / 1048576.0;
 
@@ -350,3 +365,504 @@ void storePerf(const graph& g) {
         << "% of the RAM not used by other processes.";
     logger(output_stream.str());
 }
+
+/**
+ * @brief Measures the search space of ALT queries with the current landmarks.
+ *
+ * @detailed
+ * Runs a fixed set of random point-to-point queries (same seed on every run) with the
+ * unidirectional ALT engine and logs the average number of settled nodes, which is the
+ * figure landmark selection strategies are compared on (smaller is better).
+ *
+ * Logged Statistics:
+ * - Landmark selection strategy and number of landmarks.
+ * - Average settled nodes per query, and as a fraction of the node count.
+ * - Average query time in milliseconds.
+ *
+ * @param g Reference to the `graph` structure.
+ * @param buffers Search buffers used by the queries.
+ * @param conf Configuration settings (ALT usage, strategy).
+ *
+ * @complexity
+ * - Time Complexity: O(Q × E' log V') for `Q` queries exploring `V'`/`E'` nodes/edges.
+ * - Space Complexity: O(1) beyond the search buffers.
+ */
+void benchmarkAltSearchSpace(const graph& g, search_buffers& buffers, const config& conf) {
+    const size_t n = g.index_to_node.size();
+    const int nb_queries = 100;
+    if (n < 2 || g.dist_landmark.empty()) {
+        return;
+    }
+
+    std::mt19937 rng(42);
+    size_t settled_total = 0;
+    auto t_begin = std::chrono::steady_clock::now();
+    for (int q = 0; q < nb_queries; ++q) {
+        int start_node = g.index_to_node[rng() % n];
+        int end_node = g.index_to_node[rng() % n];
+        findShortestPathUnidirectional(g, buffers, conf, start_node, end_node, 1.0, true);
+        for (size_t idx = 0; idx < n; ++idx) {
+            if (buffers.version_closed[idx] == buffers.current_search_id) {
+                settled_total++;
+            }
+        }
+    }
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_begin).count();
+
+    double avg_settled = static_cast<double>(settled_total) / nb_queries;
+    std::ostringstream output_stream;
+    output_stream << std::fixed << std::setprecision(2);
+    output_stream << "ALT search space (" << conf.alt_strategy << ", " << g.dist_landmark.landmark_count
+        << " landmarks, " << nb_queries << " random queries): " << avg_settled << " settled nodes per query ("
+        << (100.0 * avg_settled / static_cast<double>(n)) << "% of the graph), "
+        << (elapsed_ms / nb_queries) << " ms per query.";
+    logger(output_stream.str());
+}
+
+/**
+ * @brief Compares the serial Dijkstra one-to-all search with parallel delta-stepping.
+ *
+ * @detailed
+ * Runs both implementations from the same fixed-seed random sources, checks that they
+ * return identical distance vectors and reports their average times and the speedup, with
+ * the configured thread count and bucket width (`nb_threads`, `sssp_delta`).
+ * Runs at startup when `conf.benchmark` is set.
+ *
+ * @param g Reference to the `graph` structure.
+ * @param conf Configuration settings (threads, delta).
+ *
+ * @complexity
+ * - Time Complexity: O(S × (E log V + E)) for `S` sources.
+ * - Space Complexity: O(V).
+ */
+void benchmarkSingleSource(const graph& g, const config& conf) {
+    const size_t n = g.index_to_node.size();
+    const int nb_sources = 4;
+    if (n == 0) {
+        return;
+    }
+
+    std::mt19937 rng(7);
+    double serial_ms = 0.0, parallel_ms = 0.0;
+    size_t mismatches = 0;
+    for (int s = 0; s < nb_sources; ++s) {
+        int source = g.index_to_node[rng() % n];
+
+        auto t_begin = std::chrono::steady_clock::now();
+        std::vector<int> serial = dijkstraSingleSource(g, source, n);
+        auto t_mid = std::chrono::steady_clock::now();
+        std::vector<int> parallel = deltaSteppingSingleSource(g, source, n, conf.sssp_delta, conf.nb_threads);
+        auto t_end = std::chrono::steady_clock::now();
+
+        serial_ms += std::chrono::duration<double, std::milli>(t_mid - t_begin).count();
+        parallel_ms += std::chrono::duration<double, std::milli>(t_end - t_mid).count();
+        if (serial != parallel) {
+            mismatches++;
+        }
+    }
+
+    int threads = (conf.nb_threads > 0) ? conf.nb_threads : (int)std::thread::hardware_concurrency();
+    int delta = (conf.sssp_delta > 0) ? conf.sssp_delta : defaultSsspDelta(g);
+    std::ostringstream output_stream;
+    output_stream << std::fixed << std::setprecision(2);
+    output_stream << "one-to-all search (" << nb_sources << " sources): dijkstra " << (serial_ms / nb_sources)
+        << " ms, delta-stepping " << (parallel_ms / nb_sources) << " ms (" << threads << " threads, delta "
+        << delta << ", speedup x" << (parallel_ms > 0.0 ? serial_ms / parallel_ms : 0.0) << ")"
+        << (mismatches ? ", " + std::to_string(mismatches) + " MISMATCHING RESULTS" : std::string()) << ".";
+    console(mismatches ? "error" : "info", output_stream.str());
+    logger(output_stream.str());
+}
+
+/**
+ * @brief Compares query latency with and without huge page backed graph arrays.
+ *
+ * @detailed
+ * Copies the graph and a set of search buffers while large blocks are forced onto 4 KB
+ * pages (`configureHugePages(-1, ...)`), then runs the same fixed-seed random queries with
+ * the unidirectional engine on the copy and on the loaded graph, and reports both average
+ * times and the speedup. Runs at startup when `conf.benchmark` and `conf.huge_pages` are set.
+ *
+ * @param g Reference to the `graph` structure (huge page backed).
+ * @param conf Configuration settings (huge page mode).
+ *
+ * @complexity
+ * - Time Complexity: O(V + E) for the copy, plus O(Q × E' log V') for `Q` queries.
+ * - Space Complexity: O(V + E), one more graph copy.
+ */
+void benchmarkHugePages(const graph& g, const config& conf) {
+    const size_t n = g.index_to_node.size();
+    const int nb_queries = 200;
+    if (n < 2 || conf.huge_pages <= 0) {
+        return;
+    }
+
+    configureHugePages(-1, false);
+    graph small_pages = g;
+    search_buffers small_buffers;
+    initializeSearchBuffers(small_pages, small_buffers);
+    configureHugePages(conf.huge_pages, conf.lock_memory);
+
+    search_buffers huge_buffers;
+    initializeSearchBuffers(g, huge_buffers);
+
+    auto run = [&](const graph& target, search_buffers& buffers) {
+        std::mt19937 rng(11);
+        auto t_begin = std::chrono::steady_clock::now();
+        for (int q = 0; q < nb_queries; ++q) {
+            int start_node = target.index_to_node[rng() % n];
+            int end_node = target.index_to_node[rng() % n];
+            findShortestPathUnidirectional(target, buffers, conf, start_node, end_node, 1.0, true);
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_begin).count();
+    };
+    run(small_pages, small_buffers);
+    double small_ms = run(small_pages, small_buffers);
+    run(g, huge_buffers);
+    double huge_ms = run(g, huge_buffers);
+
+    std::ostringstream output_stream;
+    output_stream << std::fixed << std::setprecision(3);
+    output_stream << "huge pages (" << nb_queries << " random queries): 4 KB pages " << (small_ms / nb_queries)
+        << " ms, huge pages " << (huge_ms / nb_queries) << " ms per query (speedup x"
+        << (huge_ms > 0.0 ? small_ms / huge_ms : 0.0) << ").";
+    console("info", output_stream.str());
+    logger(output_stream.str());
+}
+
+/**
+ * @brief Compares the generic unidirectional engine with the specialized kernels.
+ *
+ * @detailed
+ * Runs the same fixed-seed random queries with `weight = 0` (Dijkstra), `weight = 1` and with
+ * the configured weight (if different) through the generic engine (kernels switched off),
+ * then through the binary heap and the 4-ary heap kernel sets (each after one warm-up pass),
+ * and reports the average times and speedups. Runs at startup when `conf.benchmark` is set.
+ * With `weight = 0`, and with ALT at `weight = 1`, every kernel answer is also checked against
+ * the generic one (weighted answers may legitimately differ, see `fixed_point_cost`).
+ * `unidirectional_kernels` is restored afterwards.
+ *
+ * @param g Reference to the `graph` structure.
+ * @param conf Configuration settings (heuristic, weight).
+ *
+ * @complexity
+ * - Time Complexity: O(Q × E log V) per variant.
+ * - Space Complexity: O(V) for one set of search buffers.
+ */
+void benchmarkSearchKernels(const graph& g, const config& conf) {
+    const size_t n = g.index_to_node.size();
+    const int nb_queries = 200;
+    if (n < 2) {
+        return;
+    }
+
+    search_buffers buffers;
+    initializeSearchBuffers(g, buffers);
+    const search_kernel_set selected = unidirectional_kernels;
+    const search_kernel_set variants[] = { search_kernel_set(), makeSearchKernels(g, conf, false), makeSearchKernels(g, conf, true) };
+
+    std::vector<double> weights = { 0.0, 1.0 };
+    if (conf.weight != 1.0 && conf.weight != 0.0) {
+        weights.push_back(conf.weight);
+    }
+    for (double weight : weights) {
+        double elapsed_ms[3] = { 0.0, 0.0, 0.0 };
+        std::vector<int> reference(nb_queries, -1);
+        size_t mismatches = 0;
+        for (int v = 0; v < 3; ++v) {
+            unidirectional_kernels = variants[v];
+            for (int pass = 0; pass < 2; ++pass) {
+                std::mt19937 rng(13);
+                auto t_begin = std::chrono::steady_clock::now();
+                for (int q = 0; q < nb_queries; ++q) {
+                    int start_node = g.index_to_node[rng() % n];
+                    int end_node = g.index_to_node[rng() % n];
+                    int cost = findShortestPathUnidirectional(g, buffers, conf, start_node, end_node, weight, true).total_time;
+                    if (v == 0) {
+                        reference[q] = cost;
+                    }
+                    else if (pass == 1 && (weight == 0.0 || (conf.use_alt && weight == 1.0)) && cost != reference[q]) {
+                        mismatches++;
+                    }
+                }
+                elapsed_ms[v] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_begin).count();
+            }
+        }
+
+        std::ostringstream output_stream;
+        output_stream << std::fixed << std::setprecision(3);
+        output_stream << "search kernels (" << nb_queries << " random queries, weight " << weight << "): generic "
+            << (elapsed_ms[0] / nb_queries) << " ms, " << variants[1].name << " " << (elapsed_ms[1] / nb_queries)
+            << " ms (x" << (elapsed_ms[1] > 0.0 ? elapsed_ms[0] / elapsed_ms[1] : 0.0) << "), " << variants[2].name << " "
+            << (elapsed_ms[2] / nb_queries) << " ms (x" << (elapsed_ms[2] > 0.0 ? elapsed_ms[0] / elapsed_ms[2] : 0.0) << ")"
+            << (mismatches ? ", " + std::to_string(mismatches) + " MISMATCHING RESULTS" : std::string()) << ".";
+        console(mismatches ? "error" : "info", output_stream.str());
+        logger(output_stream.str());
+    }
+    unidirectional_kernels = selected;
+}
+
+/**
+ * @brief Checks the queries that read live weights against Dijkstra after unrepaired updates.
+ *
+ * @detailed
+ * Works on a copy of the graph with a random 16-member POI set. The shortest paths from a
+ * few sources to one member each are shortened to weight 1, and a batch of random edges is
+ * slowed down, all through `applyEdgeUpdates()` without `repairLandmarks()`: the landmark
+ * bounds then overestimate the shortened paths. `findNearestTargets()` is queried from every
+ * source and each returned member (order and time) is compared with a Dijkstra one-to-all
+ * search on the updated weights. Mismatches are reported.
+ * Only runs in check mode (`--check` on the command line), since it copies the graph.
+ *
+ * @param g Reference to the `graph` structure.
+ * @param conf Configuration settings (heuristic).
+ * @return `true` if every query matched.
+ *
+ * @complexity
+ * - Time Complexity: O(V + E) for the copy, plus O(Q × E log V) for `Q` checked queries.
+ * - Space Complexity: O(V + E), one more graph copy.
+ */
+bool checkLiveUpdates(const graph& g, const config& conf) {
+    const size_t n = g.index_to_node.size();
+    const int nb_queries = 50;
+    const int nb_shortened = 10;
+    const int nb_slowed = 64;
+    const size_t k = 4;
+    if (n < 2 || g.edges.empty()) {
+        return true;
+    }
+
+    graph copy = g;
+    const auto& cc = copy.chains;
+    auto is_shortcut = [&](size_t pos) { return !cc.edge_chain.empty() && cc.edge_chain[pos] >= 0; };
+    std::mt19937 rng(17);
+
+    poi_set set;
+    set.name = "check";
+    set.is_member.assign(n, false);
+    while (set.nodes.size() < std::min<size_t>(16, n)) {
+        size_t idx = rng() % n;
+        if (!set.is_member[idx]) {
+            set.is_member[idx] = true;
+            set.nodes.push_back((int)idx);
+        }
+    }
+    copy.poi_sets[set.name] = set;
+    refreshPoiBounds(copy);
+
+    std::vector<size_t> sources(nb_queries);
+    for (size_t& source : sources) {
+        source = rng() % n;
+    }
+
+    std::vector<edge_update> batch;
+    for (int q = 0; q < nb_shortened; ++q) {
+        std::vector<int> dist = dijkstraSingleSource(copy, copy.index_to_node[sources[q]], n);
+        size_t cur = (size_t)set.nodes[rng() % set.nodes.size()];
+        if (dist[cur] < 0) {
+            continue;
+        }
+        while (dist[cur] > 0) {
+            size_t prev = cur;
+            for (size_t i = copy.offsets[cur]; i < copy.offsets[cur + 1]; ++i) {
+                size_t nbr = (size_t)copy.edges[i].target;
+                if (dist[nbr] >= 0 && dist[nbr] + copy.edges[i].weight == dist[cur]) {
+                    if (!is_shortcut(i)) {
+                        batch.push_back({ copy.index_to_node[nbr], copy.index_to_node[cur], 1 });
+                    }
+                    prev = nbr;
+                    break;
+                }
+            }
+            cur = prev;
+        }
+    }
+    for (int slowed = 0; slowed < nb_slowed;) {
+        size_t u = rng() % n;
+        if (copy.offsets[u] == copy.offsets[u + 1]) {
+            continue;
+        }
+        size_t pos = copy.offsets[u] + rng() % (copy.offsets[u + 1] - copy.offsets[u]);
+        if (!is_shortcut(pos)) {
+            batch.push_back({ copy.index_to_node[u], copy.index_to_node[copy.edges[pos].target], copy.edges[pos].weight * 2 });
+            ++slowed;
+        }
+    }
+    applyEdgeUpdates(copy, batch);
+
+    search_buffers buffers;
+    initializeSearchBuffers(copy, buffers);
+    size_t mismatches = 0;
+    std::vector<std::pair<int, int>> nearest;
+    for (size_t source : sources) {
+        std::vector<int> dist = dijkstraSingleSource(copy, copy.index_to_node[source], n);
+        std::vector<int> expected;
+        for (int member : set.nodes) {
+            if (dist[member] >= 0) {
+                expected.push_back(dist[member]);
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+        expected.resize(std::min(expected.size(), k));
+
+        findNearestTargets(copy, buffers, conf, copy.index_to_node[source], set.name, (int)k, nearest);
+        bool same = nearest.size() == expected.size();
+        for (size_t i = 0; same && i < nearest.size(); ++i) {
+            same = nearest[i].second == expected[i] && nearest[i].second == dist[copy.node_to_index.at(nearest[i].first)];
+        }
+        mismatches += !same;
+    }
+
+    std::ostringstream output_stream;
+    output_stream << "live update check (" << batch.size() << " updated edges, ALT slack " << copy.dist_landmark.slack << ", "
+        << nb_queries << " nearest queries): " << (mismatches ? std::to_string(mismatches) + " MISMATCHING RESULTS." : std::string("no mismatch."));
+    console(mismatches ? "error" : "success", output_stream.str());
+    logger(output_stream.str());
+    return mismatches == 0;
+}
+
+/**
+ * @brief Checks live updates on compressed chains against a Dijkstra on the expanded graph.
+ *
+ * @detailed
+ * Works on a copy of a graph built with `compress_chains`. The original graph is rebuilt
+ * aside as a plain adjacency list (kept edges plus every chain segment), then a batch of
+ * random chain segments and original edges is applied to both: through `applyEdgeUpdates()`
+ * on the copy, by hand on the adjacency list. Random pairs of original nodes (kept or
+ * removed) are then routed with `routeThroughChains()` (Dijkstra core queries) and compared
+ * with a Dijkstra on the adjacency list. An update naming the two ends of a chain that are not joined by an
+ * original edge must be rejected. Mismatches are reported.
+ * Only runs in check mode (`--check` on the command line), since it copies the graph.
+ *
+ * @param g Reference to the `graph` structure.
+ * @param conf Configuration settings (heuristic).
+ * @return `true` if the batch was applied, the chain ends were rejected and every route matched.
+ *
+ * @complexity
+ * - Time Complexity: O(V + E) for the copies, plus O(Q × E log V) for `Q` checked routes.
+ * - Space Complexity: O(V + E).
+ */
+bool checkChainUpdates(const graph& g, const config& conf) {
+    const auto& gc = g.chains;
+    const int nb_updates = 64;
+    const int nb_queries = 20;
+    if (!gc.built) {
+        return true;
+    }
+
+    graph copy = g;
+    const auto& cc = copy.chains;
+    std::mt19937 rng(23);
+
+    std::unordered_map<int, size_t> dense;
+    std::vector<int> nodes;
+    std::vector<std::vector<std::pair<size_t, int>>> adj;
+    auto id = [&](int node) {
+        auto [it, inserted] = dense.try_emplace(node, nodes.size());
+        if (inserted) {
+            nodes.push_back(node);
+            adj.emplace_back();
+        }
+        return it->second;
+    };
+    auto link = [&](int a, int b, int weight) {
+        size_t ia = id(a);
+        size_t ib = id(b);
+        adj[ia].push_back({ ib, weight });
+        adj[ib].push_back({ ia, weight });
+    };
+    auto chain_node = [&](size_t c, size_t k) {
+        size_t count = cc.first[c + 1] - cc.first[c];
+        return (k == 0) ? cc.from[c] : (k > count) ? cc.to[c] : cc.interior[cc.first[c] + k - 1];
+    };
+    auto chain_offset = [&](size_t c, size_t k) {
+        size_t count = cc.first[c + 1] - cc.first[c];
+        return (k == 0) ? 0 : (k > count) ? cc.length[c] : cc.offset[cc.first[c] + k - 1];
+    };
+    for (size_t u = 0; u < copy.index_to_node.size(); ++u) {
+        id(copy.index_to_node[u]);
+        for (size_t pos = copy.offsets[u]; pos < copy.offsets[u + 1]; ++pos) {
+            if (cc.edge_chain[pos] < 0 && u < (size_t)copy.edges[pos].target) {
+                link(copy.index_to_node[u], copy.index_to_node[copy.edges[pos].target], copy.edges[pos].weight);
+            }
+        }
+    }
+    for (size_t c = 0; c < cc.from.size(); ++c) {
+        for (size_t k = 0; k <= cc.first[c + 1] - cc.first[c]; ++k) {
+            link(chain_node(c, k), chain_node(c, k + 1), chain_offset(c, k + 1) - chain_offset(c, k));
+        }
+    }
+
+    std::vector<edge_update> batch;
+    while ((int)batch.size() < nb_updates) {
+        size_t a = rng() % nodes.size();
+        if (adj[a].empty()) {
+            continue;
+        }
+        auto [b, weight] = adj[a][rng() % adj[a].size()];
+        batch.push_back({ nodes[a], nodes[b], (rng() % 2) ? weight * 3 : std::max(weight / 3, 1) });
+    }
+    bool applied = applyEdgeUpdates(copy, batch);
+    for (const auto& upd : batch) {
+        size_t a = dense.at(upd.from);
+        size_t b = dense.at(upd.to);
+        for (auto& [target, weight] : adj[a]) {
+            weight = (target == b) ? upd.weight : weight;
+        }
+        for (auto& [target, weight] : adj[b]) {
+            weight = (target == a) ? upd.weight : weight;
+        }
+    }
+
+    bool rejected = true;
+    for (size_t c = 0; c < cc.from.size(); ++c) {
+        if (cc.from[c] == cc.to[c]) {
+            continue;
+        }
+        bool direct = false;
+        for (const auto& [target, weight] : adj[dense.at(cc.from[c])]) {
+            direct = direct || nodes[target] == cc.to[c];
+        }
+        if (!direct) {
+            rejected = !applyEdgeUpdates(copy, { { cc.from[c], cc.to[c], 1 } });
+            break;
+        }
+    }
+
+    search_buffers buffers;
+    initializeSearchBuffers(copy, buffers);
+    auto engine = [&](int s, int t) { return findShortestPathUnidirectional(copy, buffers, conf, s, t, 0.0, true); };
+    size_t mismatches = 0;
+    for (int q = 0; q < nb_queries; ++q) {
+        size_t source = rng() % nodes.size();
+        size_t target = rng() % nodes.size();
+        std::vector<int> dist(nodes.size(), -1);
+        using pq_item = std::pair<int, size_t>;
+        std::priority_queue<pq_item, std::vector<pq_item>, std::greater<pq_item>> queue;
+        dist[source] = 0;
+        queue.push({ 0, source });
+        while (!queue.empty()) {
+            auto [d, cur] = queue.top();
+            queue.pop();
+            if (d != dist[cur]) {
+                continue;
+            }
+            for (const auto& [nbr, weight] : adj[cur]) {
+                if (dist[nbr] < 0 || d + weight < dist[nbr]) {
+                    dist[nbr] = d + weight;
+                    queue.push({ dist[nbr], nbr });
+                }
+            }
+        }
+        path_result route = routeThroughChains(copy, nodes[source], nodes[target], true, engine);
+        mismatches += (route.total_time != dist[target]);
+    }
+
+    std::ostringstream output_stream;
+    output_stream << "chain update check (" << nb_updates << " updated edges" << (applied ? "" : " REJECTED")
+        << (rejected ? "" : ", chain ends ACCEPTED as an edge") << ", " << nb_queries << " routes): "
+        << (mismatches ? std::to_string(mismatches) + " MISMATCHING RESULTS." : std::string("no mismatch."));
+    bool passed = applied && rejected && mismatches == 0;
+    console(passed ? "success" : "error", output_stream.str());
+    logger(output_stream.str());
+    return passed;
+}
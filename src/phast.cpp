@@ -0,0 +1,184 @@
+﻿#include "incl.h"
+#include "decl.h"
+
+namespace {
+    constexpr int phast_inf = std::numeric_limits<int>::max() / 2;
+
+    /**
+     * @brief Runs PHAST for up to `K` sources at once.
+     *
+     * @detailed
+     * Distances are stored source-interleaved (`d[pos * K + k]`), so the downward sweep
+     * relaxes the `K` sources of an edge with one contiguous, auto-vectorizable loop and
+     * walks every array linearly in sweep order.
+     *
+     * Steps:
+     * 1. Reset the `K`-wide distance array to infinity.
+     * 2. For each source, run a small Dijkstra on the upward graph only.
+     * 3. Sweep the nodes by decreasing rank (increasing position) and relax their
+     *    incoming downward edges, which all come from already-final positions.
+     * 4. Copy the final distances back to node-index order (`-1` = unreachable).
+     */
+    template <int K>
+    void phastBatch(const graph& gdata, const std::vector<int>& source_idx, size_t first, size_t count, std::vector<int>& d, std::vector<std::vector<int>>& out)
+    {
+        const auto& ch = gdata.ch;
+        const size_t n = ch.node_at_pos.size();
+        d.assign(n * K, phast_inf);
+
+        using pq_item = std::pair<int, int>;
+        std::priority_queue<pq_item, std::vector<pq_item>, std::greater<pq_item>> open_list;
+
+        for (size_t k = 0; k < count; ++k) {
+            int src = source_idx[first + k];
+            if (src < 0) {
+                continue;
+            }
+            int src_pos = ch.pos_of[src];
+            d[(size_t)src_pos * K + k] = 0;
+            open_list.push({ 0, src_pos });
+
+            while (!open_list.empty()) {
+                auto [cur_dist, cur_pos] = open_list.top();
+                open_list.pop();
+                if (d[(size_t)cur_pos * K + k] != cur_dist) {
+                    continue;
+                }
+                for (size_t i = ch.up_offsets[cur_pos]; i < ch.up_offsets[cur_pos + 1]; ++i) {
+                    const auto& e = ch.up_edges[i];
+                    int nd = cur_dist + e.weight;
+                    int& old = d[(size_t)e.target * K + k];
+                    if (nd < old) {
+                        old = nd;
+                        open_list.push({ nd, e.target });
+                    }
+                }
+            }
+        }
+
+        int* dist = d.data();
+        for (size_t pos = 0; pos < n; ++pos) {
+            int* cur = dist + pos * K;
+            for (size_t i = ch.up_offsets[pos]; i < ch.up_offsets[pos + 1]; ++i) {
+                const auto& e = ch.up_edges[i];
+                const int* from = dist + (size_t)e.target * K;
+                const int w = e.weight;
+                for (int k = 0; k < K; ++k) {
+                    int nd = from[k] + w;
+                    cur[k] = (nd < cur[k]) ? nd : cur[k];
+                }
+            }
+        }
+
+        for (size_t k = 0; k < count; ++k) {
+            auto& row = out[first + k];
+            row.assign(n, -1);
+            if (source_idx[first + k] < 0) {
+                continue;
+            }
+            for (size_t pos = 0; pos < n; ++pos) {
+                int v = dist[pos * K + k];
+                row[ch.node_at_pos[pos]] = (v >= phast_inf) ? -1 : v;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Computes full distance vectors from many sources with PHAST.
+ *
+ * @detailed
+ * PHAST (hardware-accelerated shortest path trees) replaces the heap-based
+ * one-to-all Dijkstra by a tiny upward CH search followed by a linear sweep over all
+ * nodes in rank order. The sweep has no priority queue and perfectly predictable
+ * memory accesses, and several sources are processed together in the same sweep.
+ *
+ * Functionality:
+ * - Sources are grouped into batches of 8 (a single source uses a 1-wide sweep).
+ * - Batches are distributed over `nb_threads` threads, each with its own sweep array.
+ * - The output has the same layout as `dijkstraSingleSource()`: one vector per source,
+ *   indexed by node index, with `-1` for unreachable nodes or unknown sources.
+ *
+ * @param gdata Reference to the graph data (`gdata.ch` must be built).
+ * @param sources List of source node IDs.
+ * @param nb_threads Number of threads (`0` or less = number of hardware threads).
+ * @return One distance vector per source.
+ *
+ * @complexity
+ * - Time Complexity: O(S/K × (V + E_up)) sweeps, with `K` sources per sweep.
+ * - Space Complexity: O(S × V) for the result, O(K × V) per thread for the sweep.
+ */
+std::vector<std::vector<int>> phastOneToAll(const graph& gdata, const std::vector<int>& sources, int nb_threads)
+{
+    constexpr int batch_width = 8;
+
+    std::vector<std::vector<int>> out(sources.size());
+    if (sources.empty() || !gdata.ch.built) {
+        return out;
+    }
+
+    std::vector<int> source_idx(sources.size(), -1);
+    for (size_t i = 0; i < sources.size(); ++i) {
+        auto it = gdata.node_to_index.find(sources[i]);
+        if (it != gdata.node_to_index.end()) {
+            source_idx[i] = (int)it->second;
+        }
+    }
+
+    if (sources.size() == 1) {
+        std::vector<int> d;
+        phastBatch<1>(gdata, source_idx, 0, 1, d, out);
+        return out;
+    }
+
+    size_t nb_batches = (sources.size() + batch_width - 1) / batch_width;
+    size_t nb_workers = (nb_threads > 0) ? (size_t)nb_threads : (size_t)std::thread::hardware_concurrency();
+    nb_workers = std::max<size_t>(1, std::min(nb_workers, nb_batches));
+
+    std::atomic<size_t> next_batch(0);
+    auto workerFunc = [&]() {
+        std::vector<int> d;
+        while (true) {
+            size_t b = next_batch.fetch_add(1, std::memory_order_relaxed);
+            if (b >= nb_batches) {
+                break;
+            }
+            size_t first = b * batch_width;
+            size_t count = std::min<size_t>(batch_width, sources.size() - first);
+            phastBatch<batch_width>(gdata, source_idx, first, count, d, out);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t w = 1; w < nb_workers; ++w) {
+        workers.emplace_back(workerFunc);
+    }
+    workerFunc();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    return out;
+}
+
+/**
+ * @brief Computes the distances from one source to every node.
+ *
+ * Drop-in replacement for `dijkstraSingleSource()`: uses the PHAST sweep when a
+ * contraction hierarchy is available, and delta-stepping otherwise (its bucket queue is
+ * faster than Dijkstra's binary heap even on a single thread).
+ *
+ * @param gdata Reference to the graph data.
+ * @param source The source node ID.
+ * @param node_count The total number of nodes in the graph.
+ * @param nb_threads Threads for this one search (`0` for all available threads).
+ * @param delta Delta-stepping bucket width (`0` for the default).
+ * @return Distances indexed by node index (`-1` = unreachable).
+ */
+std::vector<int> computeOneToAll(const graph& gdata, int source, size_t node_count, int nb_threads, int delta)
+{
+    if (!gdata.ch.built) {
+        return deltaSteppingSingleSource(gdata, source, node_count, delta, nb_threads);
+    }
+    return std::move(phastOneToAll(gdata, { source }, 1)[0]);
+}
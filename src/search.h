@@ -1,4 +1,4 @@
-// ✅ file verified.
+﻿// ✅ file verified.
 #include "incl.h"
 #include "decl.h"
 
@@ -6,8 +6,8 @@
 /**
  * @brief Inline helper functions for lazy-access to search buffers.
  *
- * These functions provide getters and setters for distances, heuristics, and parent pointers
- * in the `search_buffers` structure. They utilize versioning to ensure that only data from the
+ * These functions provide getters and setters for distances, heuristics, parent pointers and
+ * the closed set in the `search_buffers` structure. They utilize versioning to ensure that only data from the
  * current search (indicated by `current_search_id`) is considered valid, thereby avoiding
  * unnecessary full-buffer resets.
  */
@@ -59,6 +59,16 @@ namespace {
         buffers.parent_backward[idx] = value;
         buffers.version_parent_backward[idx] = buffers.current_search_id;
     }
+
+    inline bool isClosed(const search_buffers &buffers, size_t idx) {
+        return buffers.version_closed[idx] == buffers.current_search_id;
+    }
+    inline void setClosed(search_buffers &buffers, size_t idx) {
+        buffers.version_closed[idx] = buffers.current_search_id;
+    }
+    inline void clearClosed(search_buffers &buffers, size_t idx) {
+        buffers.version_closed[idx] = 0;
+    }
 }
 
 // ✅ function + comment verified.
@@ -100,6 +110,25 @@ static inline int baseHeuristicFunc(size_t current_idx, size_t goal_idx, const g
     return diff < 0 ? -diff : diff;
 }
 
+/**
+ * @brief Returns the landmark lower bound `max_L |d_L(a) - d_L(b)|` between two nodes.
+ *
+ * @detailed
+ * Dispatches to the SIMD kernel matching the table layout: full `int` rows, or compact
+ * 16-bit rows whose per-landmark bound is rounded down (still a valid lower bound).
+ * The table `slack` (unrepaired weight decreases) is then subtracted, floored at `0`.
+ *
+ * @complexity
+ * - Time Complexity: O(L / W) (W = 8 or 16 lanes per SIMD step).
+ * - Space Complexity: O(1).
+ */
+static inline int landmarkLowerBound(const landmark_table& table, size_t idx_a, size_t idx_b)
+{
+    int bound = table.compact ? altMaxAbsDiff16(table.row16(idx_a), table.row16(idx_b), table.scale.data(), table.stride)
+                              : altMaxAbsDiff(table.row(idx_a), table.row(idx_b), table.stride);
+    return std::max(bound - table.slack, 0);
+}
+
 // ✅ function + comment verified.
 /**
  * @brief Computes a heuristic estimate between two nodes using landmark-based heuristics.
@@ -114,13 +143,11 @@ static inline int baseHeuristicFunc(size_t current_idx, size_t goal_idx, const g
  * - `d_L(n)` represents the precomputed distance from landmark L to node n.
  *
  * Functionality:
- * - Computes heuristic estimates based on landmark distances.
- * - Uses the triangle inequality to derive a tighter lower bound.
- * - Processes multiple landmarks in an optimized loop.
- *
- * @note
- * - Caching has been removed to enhance performance by eliminating synchronization overhead.
- * - Loop unrolling is employed to reduce iteration overhead and boost performance.
+ * - Reads both rows from the flat, node-major `landmark_table` (contiguous, 64-byte aligned).
+ * - Delegates the max-abs-diff to `landmarkLowerBound`, i.e. the SIMD kernel selected at
+ *   startup (AVX-512 / AVX2 / scalar), which masks unreachable landmarks to `0`.
+ * - Padding lanes hold `0` in every row, so they never raise the maximum.
+ * - With a compact (16-bit) table, each landmark bound is rounded down, so `h` stays admissible.
  *
  * @param current_node The starting node.
  * @param goal_node The target node.
@@ -128,7 +155,7 @@ static inline int baseHeuristicFunc(size_t current_idx, size_t goal_idx, const g
  * @return The heuristic estimate based on landmark distances.
  *
  * @complexity
- * - Time Complexity: O(L) (L is the number of landmarks used; loop unrolling helps reduce overhead but remains linear).
+ * - Time Complexity: O(L / W) (W = 8 or 16 lanes per SIMD step).
  * - Space Complexity: O(1) (No caching is used).
  */
 static inline int altHeuristicFunc(size_t current_idx, size_t goal_idx, const graph& gdata)
@@ -136,38 +163,7 @@ static inline int altHeuristicFunc(size_t current_idx, size_t goal_idx, const gr
     if (current_idx == goal_idx) {
         return 0;
     }
-    const auto &dm_c = gdata.dist_landmark[current_idx];
-    const auto &dm_g = gdata.dist_landmark[goal_idx];
-
-    int best_val = 0;
-    int count_l = (int)dm_c.size();
-    const int* dm_c_ptr = dm_c.data();
-    const int* dm_g_ptr = dm_g.data();
-
-#define ALT_HEURISTIC_STEP(I)                                \
-    {                                                        \
-        int d_c = dm_c_ptr[(I)];                             \
-        int d_g = dm_g_ptr[(I)];                             \
-        if (d_c < 0 || d_g < 0)                              \
-            continue;                                        \
-        int diff = d_g - d_c;                                \
-        if (diff < 0) diff = -diff;                          \
-        if (diff > best_val) best_val = diff;                \
-    }
-
-    int i = 0;
-    for (; i + 3 < count_l; i += 4) {
-        ALT_HEURISTIC_STEP(i);
-        ALT_HEURISTIC_STEP(i + 1);
-        ALT_HEURISTIC_STEP(i + 2);
-        ALT_HEURISTIC_STEP(i + 3);
-    }
-    for (; i < count_l; i++) {
-        ALT_HEURISTIC_STEP(i);
-    }
-
-#undef ALT_HEURISTIC_STEP
-    return best_val;
+    return landmarkLowerBound(gdata.dist_landmark, current_idx, goal_idx);
 }
 
 // ✅ function + comment verified.
@@ -201,4 +197,218 @@ static inline int computeHeuristic(size_t current_idx, size_t goal_idx, const gr
 {
     return conf.use_alt ? altHeuristicFunc(current_idx, goal_idx, gdata)
                         : baseHeuristicFunc(current_idx, goal_idx, gdata);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Number of settled nodes between two refreshes of the active landmark set.
+ *
+ * A refresh is one O(L) scan; the open list is only re-keyed when a landmark is added,
+ * which happens at most `L` times per query, so checking often stays cheap.
+ */
+static const size_t active_landmark_refresh = 16;
+
+/**
+ * @brief Lower bound `|d_L(a) - d_L(b)|` given by a single landmark.
+ *
+ * @detailed
+ * Same per-landmark value as the SIMD kernels: `0` if one of the nodes is unreachable,
+ * and the rounded-down `scale * (|dq| - 1) + 1` for compact tables, minus the table `slack`.
+ *
+ * @complexity
+ * - Time Complexity: O(1).
+ * - Space Complexity: O(1).
+ */
+static inline int singleLandmarkBound(const landmark_table& table, size_t idx_a, size_t idx_b, size_t landmark)
+{
+    if (table.compact) {
+        int q_a = table.row16(idx_a)[landmark];
+        int q_b = table.row16(idx_b)[landmark];
+        if (q_a == landmark_table::compact_unreachable || q_b == landmark_table::compact_unreachable || q_a == q_b) {
+            return 0;
+        }
+        int step = table.scale[landmark];
+        return std::max(step * (std::abs(q_a - q_b) - 1) + 1 - table.slack, 0);
+    }
+    int d_a = table.row(idx_a)[landmark];
+    int d_b = table.row(idx_b)[landmark];
+    return (d_a < 0 || d_b < 0) ? 0 : std::max(std::abs(d_a - d_b) - table.slack, 0);
+}
+
+/**
+ * @brief ALT lower bound restricted to the active landmarks of the current query.
+ *
+ * @complexity
+ * - Time Complexity: O(K) with `K` active landmarks.
+ * - Space Complexity: O(1).
+ */
+static inline int activeLandmarkBound(const landmark_table& table, size_t idx_a, size_t idx_b, const std::vector<int>& active)
+{
+    int best_val = 0;
+    for (int l : active) {
+        best_val = std::max(best_val, singleLandmarkBound(table, idx_a, idx_b, (size_t)l));
+    }
+    return best_val;
+}
+
+/**
+ * @brief Selects the `count` landmarks giving the best lower bound between two nodes.
+ *
+ * @detailed
+ * For a given source/target pair, only a few landmarks (usually 2 to 4, roughly "behind"
+ * the source or "beyond" the target) give a useful bound. Landmarks that bound
+ * `(start, end)` by `0` are left out; the refresh may add them later.
+ *
+ * @param table Landmark table.
+ * @param start_idx Internal index of the source.
+ * @param end_idx Internal index of the target.
+ * @param count Maximum number of active landmarks.
+ * @param active Output landmark indices, best bound first.
+ *
+ * @complexity
+ * - Time Complexity: O(L log K).
+ * - Space Complexity: O(L).
+ */
+static inline void selectActiveLandmarks(const landmark_table& table, size_t start_idx, size_t end_idx, size_t count, std::vector<int>& active)
+{
+    std::vector<std::pair<int, int>> ranked;
+    ranked.reserve(table.landmark_count);
+    for (size_t l = 0; l < table.landmark_count; ++l) {
+        int bound = singleLandmarkBound(table, start_idx, end_idx, l);
+        if (bound > 0) {
+            ranked.push_back({ bound, (int)l });
+        }
+    }
+    count = std::min(count, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(), std::greater<std::pair<int, int>>());
+
+    active.clear();
+    for (size_t k = 0; k < count; ++k) {
+        active.push_back(ranked[k].second);
+    }
+}
+
+/**
+ * @brief Adds the best inactive landmark for `(current, end)` if it beats the active set there.
+ *
+ * @detailed
+ * As the search moves away from the source, another landmark may become better than the
+ * ones chosen at query start. The set only grows, so the heuristic only increases (it
+ * stays a max of consistent per-landmark bounds); the caller must then re-key its open list.
+ *
+ * @return `true` if a landmark was added.
+ *
+ * @complexity
+ * - Time Complexity: O(L).
+ * - Space Complexity: O(1).
+ */
+static inline bool refreshActiveLandmarks(const landmark_table& table, size_t current_idx, size_t end_idx, std::vector<int>& active)
+{
+    int current_val = activeLandmarkBound(table, current_idx, end_idx, active);
+    int best_val = current_val;
+    int best_l = -1;
+    for (size_t l = 0; l < table.landmark_count; ++l) {
+        int bound = singleLandmarkBound(table, current_idx, end_idx, l);
+        if (bound > best_val && std::find(active.begin(), active.end(), (int)l) == active.end()) {
+            best_val = bound;
+            best_l = (int)l;
+        }
+    }
+    if (best_l < 0) {
+        return false;
+    }
+    active.push_back(best_l);
+    return true;
+}
+
+/**
+ * @brief Runs a plain Dijkstra expansion from a set of seeds and reports each settled node.
+ *
+ * @detailed
+ * This helper is the shared one-to-many primitive used by the matrix, isochrone and
+ * nearest-target features. It reuses the versioned `dist_from_start` / `parent_forward`
+ * buffers, so starting a new expansion only costs a `current_search_id` increment
+ * instead of an O(N) reset.
+ *
+ * Several seeds with initial distances let a query start from an original node removed
+ * by graph reduction: the seeds are its `searchGraphExits()`.
+ *
+ * Functionality:
+ * - Bumps `current_search_id` and seeds every `(index, distance)` pair (a seed is its own parent).
+ * - Pops nodes in increasing distance order (lazy deletion: stale entries are skipped).
+ * - Calls `on_settle(idx, dist)` exactly once per settled node; returning `false` stops the search.
+ * - Parent pointers are only written when `StoreParents` is `true`.
+ * - Polls `buffers.cancel`; once it expires the search stops and `buffers.cancel.cancelled`
+ *   is set, so the caller can tell a cancelled expansion from an exhausted one.
+ *
+ * @tparam StoreParents Whether to record `parent_forward` for path reconstruction.
+ * @param gdata Reference to the graph data.
+ * @param buffers Reference to the `search_buffers` owned by the calling thread.
+ * @param seeds `(internal index, initial distance)` pairs (may be empty).
+ * @param on_settle Callback `bool(size_t idx, int dist)`.
+ *
+ * @complexity
+ * - Time Complexity: O(E log V) in the worst case, less when `on_settle` stops early.
+ * - Space Complexity: O(V) for the priority queue in the worst case.
+ */
+template <bool StoreParents, typename OnSettle>
+static inline void dijkstraFromSeeds(const graph& gdata, search_buffers& buffers, const std::vector<std::pair<size_t, int>>& seeds, OnSettle&& on_settle)
+{
+    buffers.current_search_id++;
+
+    using pq_item = std::pair<int, size_t>;
+    std::priority_queue<pq_item, std::vector<pq_item>, std::greater<pq_item>> open_list;
+    for (const auto& [seed_idx, seed_dist] : seeds) {
+        int old_dist = getDistFromStart(buffers, seed_idx);
+        if (old_dist >= 0 && old_dist <= seed_dist) {
+            continue;
+        }
+        setDistFromStart(buffers, seed_idx, seed_dist);
+        if (StoreParents) {
+            setParentForward(buffers, seed_idx, { (int)seed_idx, 0 });
+        }
+        open_list.push({ seed_dist, seed_idx });
+    }
+    size_t polls = 0;
+
+    while (!open_list.empty()) {
+        auto [cur_dist, cur_idx] = open_list.top();
+        open_list.pop();
+
+        if (getDistFromStart(buffers, cur_idx) != cur_dist) {
+            continue;
+        }
+        if (buffers.cancel.poll(polls)) {
+            buffers.cancel.cancelled = true;
+            return;
+        }
+        if (!on_settle(cur_idx, cur_dist)) {
+            return;
+        }
+
+        size_t start_edge = gdata.offsets[cur_idx];
+        size_t end_edge = gdata.offsets[cur_idx + 1];
+
+        for (size_t i = start_edge; i < end_edge; ++i) {
+            const auto& edge = gdata.edges[i];
+            size_t nbr_idx = (size_t)edge.target;
+            int new_dist = cur_dist + edge.weight;
+            int old_dist = getDistFromStart(buffers, nbr_idx);
+            if (old_dist < 0 || new_dist < old_dist) {
+                setDistFromStart(buffers, nbr_idx, new_dist);
+                if (StoreParents) {
+                    setParentForward(buffers, nbr_idx, { (int)cur_idx, edge.weight });
+                }
+                open_list.push({ new_dist, nbr_idx });
+            }
+        }
+    }
+}
+
+/**
+ * @brief Runs a plain Dijkstra expansion from a single source (see `dijkstraFromSeeds()`).
+ */
+template <bool StoreParents, typename OnSettle>
+static inline void dijkstraFromSource(const graph& gdata, search_buffers& buffers, size_t source_idx, OnSettle&& on_settle)
+{
+    dijkstraFromSeeds<StoreParents>(gdata, buffers, { { source_idx, 0 } }, std::forward<OnSettle>(on_settle));
+}
@@ -20,6 +20,13 @@
  * - Once a thread detects it cannot improve upon `best_distance`, it marks the search
  *   as complete.
  * - The search stops as soon as both queues are empty or no better solution is possible.
+ * - In `distance_only` mode, parent pointers are never written and the best meeting
+ *   distance is returned directly (no path reconstruction, empty `steps`).
+ * - With `conf.alt_active > 0`, both directions only evaluate the `alt_active` landmarks
+ *   with the best bound for (start, end). The set is chosen once per query (no refresh:
+ *   both threads share it and their queues cannot be re-keyed safely while running).
+ * - Both threads poll `buffers.cancel`; the first one to see it expire stops the search,
+ *   which then returns "no path" with `buffers.cancel.cancelled` set.
  * - The `weight` parameter allows a suboptimal but faster search:
  *   - `1.0` = Best path (no suboptimality).
  *   - `1.1` = Up to 10% suboptimal but potentially faster.
@@ -51,13 +58,14 @@
  * @param weight Heuristic weight influencing path selection
  *               (`1.0` = guaranteed shortest path, `>1.0` = faster but possibly suboptimal).
  * @param buffers Reference to `search_buffers` for optimized memory management.
+ * @param distance_only If `true`, only `total_time` is computed (`total_node = 0`, no `steps`).
  * @return A `path_result` structure containing the shortest path details.
  *
  * @complexity
  * - Time Complexity: Approximately O(E log V), but performed in parallel (2 threads).
  * - Space Complexity: O(V) for storing distances, parents, etc.
  */
-path_result findShortestPathBidirectional(const graph& gdata, search_buffers& buffers, const config& conf, int start_node, int end_node, double weight)
+path_result findShortestPathBidirectional(const graph& gdata, search_buffers& buffers, const config& conf, int start_node, int end_node, double weight, bool distance_only)
 {
     if (start_node == end_node) {
         return { 0, 0, {} };
@@ -84,8 +92,19 @@ path_result findShortestPathBidirectional(const graph& gdata, search_buffers& bu
     std::priority_queue<pq_item, std::vector<pq_item>, decltype(cmp)> forward_queue(cmp);
     std::priority_queue<pq_item, std::vector<pq_item>, decltype(cmp)> backward_queue(cmp);
 
-    int h_start = computeHeuristic(start_idx, end_idx, gdata, conf);
-    int h_end = computeHeuristic(end_idx, start_idx, gdata, conf);
+    const auto& table = gdata.dist_landmark;
+    const bool use_active = conf.use_alt && conf.alt_active > 0 && (size_t)conf.alt_active < table.landmark_count;
+    const auto& active = buffers.active_landmarks;
+    if (use_active) {
+        selectActiveLandmarks(table, start_idx, end_idx, (size_t)conf.alt_active, buffers.active_landmarks);
+    }
+    auto heuristic = [&](size_t idx, size_t goal_idx) -> int {
+        return use_active ? activeLandmarkBound(table, idx, goal_idx, active)
+                          : computeHeuristic(idx, goal_idx, gdata, conf);
+    };
+
+    int h_start = heuristic(start_idx, end_idx);
+    int h_end = heuristic(end_idx, start_idx);
     setHForward(buffers, start_idx, h_start);
     setHBackward(buffers, end_idx, h_end);
 
@@ -95,6 +114,7 @@ path_result findShortestPathBidirectional(const graph& gdata, search_buffers& bu
     std::atomic<int> best_distance(inf);
     std::atomic<int> best_meet_node(-1);
     std::atomic<bool> search_done(false);
+    std::atomic<bool> timed_out(false);
 
     std::mutex forward_mutex;
     std::mutex backward_mutex;
@@ -104,7 +124,7 @@ path_result findShortestPathBidirectional(const graph& gdata, search_buffers& bu
         if (hv >= 0) {
             return hv;
         }
-        hv = computeHeuristic(idx, end_idx, gdata, conf);
+        hv = heuristic(idx, end_idx);
         setHForward(buffers, idx, hv);
         return hv;
     };
@@ -114,7 +134,7 @@ path_result findShortestPathBidirectional(const graph& gdata, search_buffers& bu
         if (hv >= 0) {
             return hv;
         }
-        hv = computeHeuristic(idx, start_idx, gdata, conf);
+        hv = heuristic(idx, start_idx);
         setHBackward(buffers, idx, hv);
         return hv;
     };
@@ -133,7 +153,7 @@ path_result findShortestPathBidirectional(const graph& gdata, search_buffers& bu
         }
 
         size_t start_edge = gdata.offsets[cur_idx];
-        size_t end_edge = ((cur_idx + 1) < gdata.offsets.size()) ? gdata.offsets[cur_idx + 1] : gdata.edges.size();
+        size_t end_edge = gdata.offsets[cur_idx + 1];
 
         std::vector<pq_item> local_queue_insert;
         local_queue_insert.reserve(end_edge - start_edge);
@@ -157,7 +177,9 @@ path_result findShortestPathBidirectional(const graph& gdata, search_buffers& bu
             int existing = getDistFromStart(buffers, nbr_idx);
             if (existing < 0 || new_g < existing) {
                 setDistFromStart(buffers, nbr_idx, new_g);
-                setParentForward(buffers, nbr_idx, { (int)cur_idx, cost });
+                if (!distance_only) {
+                    setParentForward(buffers, nbr_idx, { (int)cur_idx, cost });
+                }
                 int h_nbr = getForwardH(nbr_idx);
                 int f_cost = new_g + (int)(weight * h_nbr);
                 local_queue_insert.push_back({ f_cost, nbr_idx });
@@ -203,7 +225,7 @@ path_result findShortestPathBidirectional(const graph& gdata, search_buffers& bu
         }
 
         size_t start_edge = gdata.offsets[cur_idx];
-        size_t end_edge = ((cur_idx + 1) < gdata.offsets.size()) ? gdata.offsets[cur_idx + 1] : gdata.edges.size();
+        size_t end_edge = gdata.offsets[cur_idx + 1];
 
         std::vector<pq_item> local_queue_insert;
         local_queue_insert.reserve(end_edge - start_edge);
@@ -227,7 +249,9 @@ path_result findShortestPathBidirectional(const graph& gdata, search_buffers& bu
             int existing = getDistFromEnd(buffers, nbr_idx);
             if (existing < 0 || new_g < existing) {
                 setDistFromEnd(buffers, nbr_idx, new_g);
-                setParentBackward(buffers, nbr_idx, { (int)cur_idx, cost });
+                if (!distance_only) {
+                    setParentBackward(buffers, nbr_idx, { (int)cur_idx, cost });
+                }
                 int h_nbr = getBackwardH(nbr_idx);
                 int f_cost = new_g + (int)(weight * h_nbr);
                 local_queue_insert.push_back({ f_cost, nbr_idx });
@@ -259,6 +283,7 @@ path_result findShortestPathBidirectional(const graph& gdata, search_buffers& bu
     };
 
     auto forwardThreadFunc = [&]() {
+        size_t polls = 0;
         while (!search_done.load(std::memory_order_relaxed)) {
             int cur_f, cur_idx;
             {
@@ -277,11 +302,17 @@ path_result findShortestPathBidirectional(const graph& gdata, search_buffers& bu
                 search_done.store(true, std::memory_order_relaxed);
                 break;
             }
+            if (buffers.cancel.poll(polls)) {
+                timed_out.store(true, std::memory_order_relaxed);
+                search_done.store(true, std::memory_order_relaxed);
+                break;
+            }
             expandForward(cur_idx, cur_f);
         }
     };
 
     auto backwardThreadFunc = [&]() {
+        size_t polls = 0;
         while (!search_done.load(std::memory_order_relaxed)) {
             int cur_f, cur_idx;
             {
@@ -300,6 +331,11 @@ path_result findShortestPathBidirectional(const graph& gdata, search_buffers& bu
                 search_done.store(true, std::memory_order_relaxed);
                 break;
             }
+            if (buffers.cancel.poll(polls)) {
+                timed_out.store(true, std::memory_order_relaxed);
+                search_done.store(true, std::memory_order_relaxed);
+                break;
+            }
             expandBackward(cur_idx, cur_f);
         }
     };
@@ -309,12 +345,19 @@ path_result findShortestPathBidirectional(const graph& gdata, search_buffers& bu
 
     forward_thread.join();
     backward_thread.join();
+    if (timed_out.load(std::memory_order_relaxed)) {
+        buffers.cancel.cancelled = true;
+        return { -1, 0, {} };
+    }
 
     int final_best_distance = best_distance.load(std::memory_order_relaxed);
     int meet_idx = best_meet_node.load(std::memory_order_relaxed);
     if (meet_idx < 0 || final_best_distance >= inf) {
         return { -1, 0, {} };
     }
+    if (distance_only) {
+        return { final_best_distance, 0, {} };
+    }
 
     std::vector<int> forward_indices;
     {
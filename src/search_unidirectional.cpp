@@ -3,6 +3,387 @@
 #include "decl.h"
 #include "search.h"
 
+search_kernel_set unidirectional_kernels;
+
+namespace {
+    /**
+     * @brief Reads the answer of a forward search whose target has been reached.
+     *
+     * @return The cost and, unless `distance_only`, the path rebuilt from the parent pointers.
+     */
+    path_result buildForwardResult(const graph& gdata, const search_buffers& buffers, size_t start_idx, size_t end_idx, bool distance_only)
+    {
+        int final_cost = getDistFromStart(buffers, end_idx);
+        if (distance_only) {
+            return { final_cost, 0, {} };
+        }
+        std::vector<int> path;
+        path.reserve(64);
+        int cur = (int)end_idx;
+        while (cur != (int)start_idx)
+        {
+            path.push_back(gdata.index_to_node[cur]);
+            cur = getParentForward(buffers, cur).first;
+        }
+        path.push_back(gdata.index_to_node[start_idx]);
+        std::reverse(path.begin(), path.end());
+        return { final_cost, (int)path.size(), path };
+    }
+
+    /**
+     * @brief Heuristic policies of the specialized kernels.
+     *
+     * `consistent` allows search tree reuse (with exact costs); `cached` keeps the values in
+     * `h_forward`, which only pays off for the landmark bound.
+     */
+    struct no_heuristic
+    {
+        static constexpr bool consistent = true;
+        static constexpr bool cached = false;
+        no_heuristic(const graph&, size_t) {}
+        int operator()(size_t) const { return 0; }
+    };
+
+    struct index_heuristic
+    {
+        static constexpr bool consistent = false;
+        static constexpr bool cached = false;
+        const graph& gdata;
+        size_t goal_idx;
+        index_heuristic(const graph& g, size_t goal) : gdata(g), goal_idx(goal) {}
+        int operator()(size_t idx) const { return baseHeuristicFunc(idx, goal_idx, gdata); }
+    };
+
+    /**
+     * @brief ALT bound on a full-precision table; `Stride > 0` fixes the row length at compile
+     * time (inlined, unrolled loop), `0` calls the runtime-selected SIMD kernel.
+     */
+    template <size_t Stride>
+    struct alt_heuristic
+    {
+        static constexpr bool consistent = true;
+        static constexpr bool cached = true;
+        const int* rows;
+        const int* goal_row;
+        size_t stride;
+        alt_heuristic(const graph& g, size_t goal)
+            : rows(g.dist_landmark.row(0)), goal_row(g.dist_landmark.row(goal)), stride(Stride ? Stride : g.dist_landmark.stride) {}
+        int operator()(size_t idx) const {
+            const int* row = rows + idx * (Stride ? Stride : stride);
+            if constexpr (Stride == 0) {
+                return altMaxAbsDiff(row, goal_row, stride);
+            }
+            else {
+                int best_val = 0;
+                for (size_t l = 0; l < Stride; ++l) {
+                    int d_a = row[l];
+                    int d_b = goal_row[l];
+                    int diff = (d_a < 0 || d_b < 0) ? 0 : std::abs(d_a - d_b);
+                    best_val = std::max(best_val, diff);
+                }
+                return best_val;
+            }
+        }
+    };
+
+    /**
+     * @brief Cost policies: integer `g + h` for `weight = 1`, fixed-point `g + weight × h`
+     * otherwise (weight rounded down to 1/1024, so the suboptimality bound still holds).
+     */
+    struct exact_cost
+    {
+        static constexpr bool exact = true;
+        explicit exact_cost(double) {}
+        int64_t key(int g, int h) const { return (int64_t)g + h; }
+    };
+
+    struct fixed_point_cost
+    {
+        static constexpr bool exact = false;
+        static constexpr int shift = 10;
+        int64_t factor;
+        explicit fixed_point_cost(double weight) : factor((int64_t)std::floor(weight * (double)(1 << shift))) {}
+        int64_t key(int g, int h) const { return ((int64_t)g << shift) + factor * h; }
+    };
+
+    /**
+     * @brief Queue policies over `search_buffers::keyed_open_list` (min-heaps on the key).
+     */
+    struct binary_heap_queue
+    {
+        using item = std::pair<int64_t, size_t>;
+        std::vector<item>& items;
+
+        static bool later(const item& a, const item& b) { return a.first > b.first; }
+        bool empty() const { return items.empty(); }
+        const item& top() const { return items.front(); }
+        void push(int64_t key, size_t idx) {
+            items.push_back({ key, idx });
+            std::push_heap(items.begin(), items.end(), later);
+        }
+        void pop() {
+            std::pop_heap(items.begin(), items.end(), later);
+            items.pop_back();
+        }
+        void rebuild() { std::make_heap(items.begin(), items.end(), later); }
+    };
+
+    /**
+     * @brief 4-ary heap: half the depth of a binary heap, and the four children of a node
+     * share one cache line, so `pop` touches fewer lines.
+     */
+    struct quad_heap_queue
+    {
+        using item = std::pair<int64_t, size_t>;
+        std::vector<item>& items;
+
+        bool empty() const { return items.empty(); }
+        const item& top() const { return items.front(); }
+        void push(int64_t key, size_t idx) {
+            items.push_back({ key, idx });
+            siftUp(items.size() - 1);
+        }
+        void pop() {
+            items.front() = items.back();
+            items.pop_back();
+            if (!items.empty()) {
+                siftDown(0);
+            }
+        }
+        void rebuild() {
+            for (size_t i = items.size() / 4 + 1; i-- > 0;) {
+                siftDown(i);
+            }
+        }
+        void siftUp(size_t pos) {
+            item moved = items[pos];
+            while (pos > 0) {
+                size_t parent = (pos - 1) / 4;
+                if (items[parent].first <= moved.first) {
+                    break;
+                }
+                items[pos] = items[parent];
+                pos = parent;
+            }
+            items[pos] = moved;
+        }
+        void siftDown(size_t pos) {
+            const size_t n = items.size();
+            item moved = items[pos];
+            while (true) {
+                size_t first = 4 * pos + 1;
+                if (first >= n) {
+                    break;
+                }
+                size_t last = std::min(first + 4, n);
+                size_t best = first;
+                for (size_t c = first + 1; c < last; ++c) {
+                    if (items[c].first < items[best].first) {
+                        best = c;
+                    }
+                }
+                if (items[best].first >= moved.first) {
+                    break;
+                }
+                items[pos] = items[best];
+                pos = best;
+            }
+            items[pos] = moved;
+        }
+    };
+
+    /**
+     * @brief Unidirectional A* specialized at compile time on its heuristic, cost and queue.
+     *
+     * @detailed
+     * Same search as `findShortestPathUnidirectional()` (versioned buffers, lazy deletion,
+     * target kept in the open list, tree reuse, cancellation), without any of its runtime
+     * checks on the hot path: the heuristic is inlined (no `conf.use_alt` test per call),
+     * keys are integers (no double arithmetic), and the CSR sentinel gives the edge range
+     * without a bound check. Closed nodes are never reopened, so this only serves tables
+     * whose bound is consistent (full precision, no slack) or heuristics that never needed
+     * reopening in the generic engine.
+     *
+     * @complexity
+     * - Time Complexity: O(E log V).
+     * - Space Complexity: O(V) in the search buffers.
+     */
+    template <typename Heuristic, typename Cost, typename Queue>
+    path_result specializedSearch(const graph& gdata, search_buffers& buffers, size_t start_idx, size_t end_idx, double weight, bool distance_only, bool reuse_tree)
+    {
+        constexpr bool consistent = Heuristic::consistent && Cost::exact;
+        const Heuristic heuristic(gdata, end_idx);
+        const Cost cost(weight);
+        Queue open_list{ buffers.keyed_open_list };
+
+        auto hValue = [&](size_t idx) -> int {
+            if constexpr (Heuristic::cached) {
+                int h_val = getHForward(buffers, idx);
+                if (h_val < 0) {
+                    h_val = heuristic(idx);
+                    setHForward(buffers, idx, h_val);
+                }
+                return h_val;
+            }
+            else {
+                return heuristic(idx);
+            }
+        };
+
+        const bool resume = consistent && reuse_tree && buffers.reuse_keyed
+            && buffers.reuse_search_id == buffers.current_search_id
+            && buffers.reuse_source == (int)start_idx
+            && (buffers.reuse_parents || distance_only);
+
+        bool store_parents = !distance_only;
+        if (resume) {
+            store_parents = buffers.reuse_parents;
+            if (!isClosed(buffers, end_idx)) {
+                auto& items = buffers.keyed_open_list;
+                size_t kept = 0;
+                for (size_t k = 0; k < items.size(); ++k) {
+                    size_t idx = items[k].second;
+                    if (isClosed(buffers, idx)) {
+                        continue;
+                    }
+                    int h_val = heuristic(idx);
+                    if constexpr (Heuristic::cached) {
+                        setHForward(buffers, idx, h_val);
+                    }
+                    items[kept++] = { cost.key(getDistFromStart(buffers, idx), h_val), idx };
+                }
+                items.resize(kept);
+                open_list.rebuild();
+            }
+        }
+        else {
+            buffers.current_search_id++;
+            buffers.keyed_open_list.clear();
+            setDistFromStart(buffers, start_idx, 0);
+            open_list.push(cost.key(0, hValue(start_idx)), start_idx);
+        }
+
+        buffers.reuse_search_id = (reuse_tree && consistent) ? buffers.current_search_id : 0;
+        buffers.reuse_source = (int)start_idx;
+        buffers.reuse_parents = store_parents;
+        buffers.reuse_keyed = true;
+
+        if (resume && isClosed(buffers, end_idx)) {
+            return buildForwardResult(gdata, buffers, start_idx, end_idx, distance_only);
+        }
+
+        const size_t* offsets = gdata.offsets.data();
+        const graph::edge_repr* edges = gdata.edges.data();
+        size_t polls = 0;
+
+        while (!open_list.empty())
+        {
+            size_t cur_idx = open_list.top().second;
+            if (isClosed(buffers, cur_idx)) {
+                open_list.pop();
+                continue;
+            }
+            if (cur_idx == end_idx) {
+                // the target stays in the open list (not expanded yet), so a reused tree remains valid.
+                return buildForwardResult(gdata, buffers, start_idx, end_idx, distance_only);
+            }
+            open_list.pop();
+            if (buffers.cancel.poll(polls)) {
+                buffers.cancel.cancelled = true;
+                buffers.reuse_search_id = 0;
+                return { -1, 0, {} };
+            }
+            setClosed(buffers, cur_idx);
+
+            const int cur_cost = getDistFromStart(buffers, cur_idx);
+            const size_t end_edge = offsets[cur_idx + 1];
+            for (size_t i = offsets[cur_idx]; i < end_edge; ++i)
+            {
+                size_t nbr_idx = (size_t)edges[i].target;
+                if (isClosed(buffers, nbr_idx)) {
+                    continue;
+                }
+                int new_cost = cur_cost + edges[i].weight;
+                int old_cost = getDistFromStart(buffers, nbr_idx);
+                if (old_cost < 0 || new_cost < old_cost)
+                {
+                    setDistFromStart(buffers, nbr_idx, new_cost);
+                    if (store_parents) {
+                        setParentForward(buffers, nbr_idx, { (int)cur_idx, edges[i].weight });
+                    }
+                    open_list.push(cost.key(new_cost, hValue(nbr_idx)), nbr_idx);
+                }
+            }
+        }
+        return { -1, 0, {} };
+    }
+
+    /**
+     * @brief Fills a kernel set for one heuristic and queue.
+     */
+    template <typename Heuristic, typename Queue>
+    void setKernels(search_kernel_set& kernels)
+    {
+        kernels.dijkstra = specializedSearch<no_heuristic, exact_cost, Queue>;
+        kernels.exact = specializedSearch<Heuristic, exact_cost, Queue>;
+        kernels.weighted = specializedSearch<Heuristic, fixed_point_cost, Queue>;
+    }
+
+    template <typename Queue>
+    void setKernelsForTable(search_kernel_set& kernels, const graph& gdata, const config& conf)
+    {
+        if (!conf.use_alt) {
+            setKernels<index_heuristic, Queue>(kernels);
+        }
+        else if (gdata.dist_landmark.stride == 8) {
+            setKernels<alt_heuristic<8>, Queue>(kernels);
+        }
+        else if (gdata.dist_landmark.stride == 16) {
+            setKernels<alt_heuristic<16>, Queue>(kernels);
+        }
+        else {
+            setKernels<alt_heuristic<0>, Queue>(kernels);
+        }
+    }
+}
+
+/**
+ * @brief Picks the specialized unidirectional kernels matching the loaded graph and config.
+ *
+ * @detailed
+ * The choice that `findShortestPathUnidirectional()` would otherwise repeat on every node
+ * (which heuristic, which landmark row length) is made once here; each set holds the three
+ * weight modes (Dijkstra for `weight = 0`, exact integer keys for `weight = 1`, fixed-point
+ * keys otherwise), and the engine picks one per query. The result is meant to be stored
+ * in `unidirectional_kernels` at startup.
+ *
+ * @param gdata Reference to the graph data (landmark table layout).
+ * @param conf Configuration settings (heuristic).
+ * @param quad_heap `true` for the 4-ary heap, `false` for the binary heap.
+ * @return The kernel set.
+ *
+ * @complexity
+ * - Time Complexity: O(1).
+ * - Space Complexity: O(1).
+ */
+search_kernel_set makeSearchKernels(const graph& gdata, const config& conf, bool quad_heap)
+{
+    search_kernel_set kernels;
+    if (quad_heap) {
+        setKernelsForTable<quad_heap_queue>(kernels, gdata, conf);
+    }
+    else {
+        setKernelsForTable<binary_heap_queue>(kernels, gdata, conf);
+    }
+    kernels.use_alt = conf.use_alt;
+    kernels.stride = gdata.dist_landmark.stride;
+
+    std::string heuristic = !conf.use_alt ? "index"
+        : "alt/" + ((kernels.stride == 8 || kernels.stride == 16) ? std::to_string(kernels.stride) : std::string("simd"));
+    kernels.name = heuristic + (quad_heap ? ", 4-ary heap" : ", binary heap");
+    return kernels;
+}
+
 // ✅ function + comment verified.
 /**
  * @brief Implements a unidirectional A* shortest path search algorithm.
@@ -20,9 +401,48 @@
  * - Uses a priority queue (`open_list`) to select the most promising node to expand based on its f-cost.
  * - Expands nodes by relaxing edges and updating cost estimates if a better path is found.
  * - Terminates once the target node is expanded, reconstructing the path by tracing back through parent pointers.
+ * - In `distance_only` mode, parent pointers are never written and the search returns the
+ *   cost as soon as the target is expanded (no path reconstruction, empty `steps`).
+ *
+ * Search tree reuse (`reuse_tree`):
+ * - The open list lives in `search_buffers`, so the last forward search can be resumed when
+ *   the next query comes from the same source (and no other search used the buffers since).
+ * - If the new target is already closed, the answer is read directly from the tree.
+ * - Otherwise, the open list is re-keyed with the heuristic towards the new target and the
+ *   expansion simply continues; closed nodes keep their exact distances.
+ * - This is only done when the heuristic is consistent (ALT with `weight = 1.0`); the target
+ *   is never expanded when the search stops, so the kept tree is always a valid state.
+ *
+ * Active landmarks (`conf.alt_active > 0`):
+ * - At query start, only the `alt_active` landmarks with the best bound for (start, end)
+ *   are kept, so each heuristic evaluation costs O(alt_active) instead of O(nb_alt).
+ * - Every `active_landmark_refresh` settled nodes, the best landmark for (current, end) is
+ *   added if it beats the active set there; the open list is then re-keyed. The set only
+ *   grows, so the heuristic stays consistent and closed distances stay exact.
+ *
+ * Compact landmark tables:
+ * - Rounded-down 16-bit landmark bounds are admissible but not consistent, so a closed node
+ *   may later be reached by a cheaper path. In that case it is reopened (and tree reuse is
+ *   disabled), which keeps the returned path optimal with `weight = 1.0`.
+ * - The same holds while live weight decreases are not repaired (`table.slack > 0`): the
+ *   bound minus the slack is admissible, but no longer consistent.
+ *
+ * Specialized kernels:
+ * - When `unidirectional_kernels` was set at startup (`makeSearchKernels()`) and the query
+ *   needs no reopening and no active landmark set, it is answered by the kernel compiled for
+ *   the configured heuristic and this weight (Dijkstra, exact or fixed-point keys).
+ * - The Dijkstra kernel (`weight = 0`) is consistent, so it also keeps and resumes trees
+ *   with `reuse_tree`, which the generic engine only does for ALT with `weight = 1.0`.
+ * - Fixed-point keys round the weight down to a multiple of 1/1024: the suboptimality bound
+ *   still holds, but ties can be broken in another order than with the generic engine, so a
+ *   weighted query may return another path (and cost) within the bound.
+ *
+ * Cancellation:
+ * - `buffers.cancel` is polled while expanding; once it expires the search returns
+ *   "no path" with `buffers.cancel.cancelled` set, and the tree is not kept for reuse.
  *
  * Optimizations:
- * - Avoids revisiting already closed nodes using a `closed` vector.
+ * - Avoids revisiting already closed nodes using a versioned closed set (no O(N) reset).
  * - Computes and caches heuristic values to reduce redundant calculations.
  * - Uses lazy updates in the search buffers for efficient memory management.
  *
@@ -33,13 +453,15 @@
  * @param end_node The target node.
  * @param weight Heuristic weight influencing path selection
  *               (`1.0` = guaranteed shortest path, `>1.0` = faster but possibly suboptimal).
+ * @param distance_only If `true`, only `total_time` is computed (`total_node = 0`, no `steps`).
+ * @param reuse_tree If `true`, the search may resume (and keeps) the previous tree from the same source.
  * @return A `path_result` structure containing the shortest path details.
  *
  * @complexity
  * - Time Complexity: Approximately O(E log V), where E is the number of edges and V is the number of vertices.
  * - Space Complexity: O(V) for storing distances, parents, and other search-related data.
  */
-path_result findShortestPathUnidirectional(const graph& gdata, search_buffers& buffers, const config& conf, int start_node, int end_node, double weight)
+path_result findShortestPathUnidirectional(const graph& gdata, search_buffers& buffers, const config& conf, int start_node, int end_node, double weight, bool distance_only, bool reuse_tree)
 {
     if (start_node == end_node) {
         return { 0, 0, {} };
@@ -55,62 +477,125 @@ path_result findShortestPathUnidirectional(const graph& gdata, search_buffers& b
     size_t end_idx = it_end->second;
     const int INF = std::numeric_limits<int>::max();
 
-    buffers.current_search_id++;
-    setDistFromStart(buffers, start_idx, 0);
-    setDistFromEnd(buffers, end_idx, INF);
-
     using pq_item = std::pair<double, size_t>;
     auto cmp = [](const pq_item &a, const pq_item &b) {
         return a.first > b.first;
     };
-    std::priority_queue<pq_item, std::vector<pq_item>, decltype(cmp)> open_list(cmp);
+    auto& open_list = buffers.open_list;
+
+    const bool reopen = conf.use_alt && (gdata.dist_landmark.compact || gdata.dist_landmark.slack > 0);
+    const bool consistent = conf.use_alt && weight == 1.0 && !reopen;
 
-    int h_start = computeHeuristic(start_idx, end_idx, gdata, conf);
-    setHForward(buffers, start_idx, h_start);
-    double f_start = (double)getDistFromStart(buffers, start_idx) + weight * (double)h_start;
-    open_list.push({ f_start, start_idx });
+    const auto& table = gdata.dist_landmark;
+    const bool use_active = conf.use_alt && conf.alt_active > 0 && (size_t)conf.alt_active < table.landmark_count;
+    auto& active = buffers.active_landmarks;
+    if (use_active) {
+        selectActiveLandmarks(table, start_idx, end_idx, (size_t)conf.alt_active, active);
+    }
+    const search_kernel_set& kernels = unidirectional_kernels;
+    if (kernels.exact && !use_active && !reopen && kernels.use_alt == conf.use_alt && (!conf.use_alt || kernels.stride == table.stride)) {
+        search_kernel_fn kernel = (weight == 1.0) ? kernels.exact : (weight == 0.0) ? kernels.dijkstra : kernels.weighted;
+        return kernel(gdata, buffers, start_idx, end_idx, weight, distance_only, reuse_tree);
+    }
+
+    auto heuristic = [&](size_t idx) -> int {
+        return use_active ? activeLandmarkBound(table, idx, end_idx, active)
+                          : computeHeuristic(idx, end_idx, gdata, conf);
+    };
+    auto rekeyOpenList = [&]() {
+        size_t kept = 0;
+        for (size_t k = 0; k < open_list.size(); ++k) {
+            size_t idx = open_list[k].second;
+            if (isClosed(buffers, idx)) {
+                continue;
+            }
+            int h_val = heuristic(idx);
+            setHForward(buffers, idx, h_val);
+            open_list[kept++] = { (double)getDistFromStart(buffers, idx) + weight * (double)h_val, idx };
+        }
+        open_list.resize(kept);
+        std::make_heap(open_list.begin(), open_list.end(), cmp);
+    };
+    const bool resume = reuse_tree && consistent && !buffers.reuse_keyed
+        && buffers.reuse_search_id == buffers.current_search_id
+        && buffers.reuse_source == (int)start_idx
+        && (buffers.reuse_parents || distance_only);
+
+    bool store_parents = !distance_only;
+    if (resume) {
+        store_parents = buffers.reuse_parents;
+        if (!isClosed(buffers, end_idx)) {
+            rekeyOpenList();
+        }
+    }
+    else {
+        buffers.current_search_id++;
+        open_list.clear();
+        setDistFromStart(buffers, start_idx, 0);
+        setDistFromEnd(buffers, end_idx, INF);
+
+        int h_start = heuristic(start_idx);
+        setHForward(buffers, start_idx, h_start);
+        double f_start = (double)getDistFromStart(buffers, start_idx) + weight * (double)h_start;
+        open_list.push_back({ f_start, start_idx });
+    }
+
+    buffers.reuse_search_id = (reuse_tree && consistent) ? buffers.current_search_id : 0;
+    buffers.reuse_source = (int)start_idx;
+    buffers.reuse_parents = store_parents;
+    buffers.reuse_keyed = false;
+
+    auto buildResult = [&]() -> path_result {
+        return buildForwardResult(gdata, buffers, start_idx, end_idx, distance_only);
+    };
+
+    if (resume && isClosed(buffers, end_idx)) {
+        return buildResult();
+    }
 
     const auto& offsets = gdata.offsets;
     const auto& edges = gdata.edges;
-    size_t node_count = gdata.index_to_node.size();
-
-    std::vector<bool> closed(node_count, false);
+    size_t settled = 0;
+    size_t polls = 0;
 
     while (!open_list.empty())
     {
-        auto top_item = open_list.top();
-        open_list.pop();
+        std::pop_heap(open_list.begin(), open_list.end(), cmp);
+        auto top_item = open_list.back();
 
         int cur_idx = (int)top_item.second;
-        if (closed[cur_idx]) {
+        if (isClosed(buffers, cur_idx)) {
+            open_list.pop_back();
             continue;
         }
-        closed[cur_idx] = true;
 
         if (cur_idx == (int)end_idx)
         {
-            std::vector<int> path;
-            path.reserve(64); 
-            int cur = end_idx;
-            while (cur != (int)start_idx)
-            {
-                path.push_back(gdata.index_to_node[cur]);
-                cur = getParentForward(buffers, cur).first;
-            }
-            path.push_back(gdata.index_to_node[start_idx]);
-            std::reverse(path.begin(), path.end());
-            int final_cost = getDistFromStart(buffers, end_idx);
-            return { final_cost, (int)path.size(), path };
+            // the target stays in the open list (not expanded yet), so a reused tree remains valid.
+            std::push_heap(open_list.begin(), open_list.end(), cmp);
+            return buildResult();
+        }
+        open_list.pop_back();
+        if (buffers.cancel.poll(polls)) {
+            buffers.cancel.cancelled = true;
+            buffers.reuse_search_id = 0;
+            return { -1, 0, {} };
+        }
+        setClosed(buffers, cur_idx);
+
+        if (use_active && ++settled % active_landmark_refresh == 0
+            && refreshActiveLandmarks(table, cur_idx, end_idx, active)) {
+            rekeyOpenList();
         }
 
         int cur_cost = getDistFromStart(buffers, cur_idx);
         size_t start_edge = offsets[cur_idx];
-        size_t end_edge = ((static_cast<size_t>(cur_idx) + 1) < gdata.offsets.size()) ? gdata.offsets[static_cast<size_t>(cur_idx) + 1] : gdata.edges.size();
+        size_t end_edge = offsets[static_cast<size_t>(cur_idx) + 1];
 
         for (size_t i = start_edge; i < end_edge; i++)
         {
             int nbr_idx = edges[i].target;
-            if (closed[nbr_idx]) {
+            if (!reopen && isClosed(buffers, nbr_idx)) {
                 continue;
             }
             int edge_cost = edges[i].weight;
@@ -120,18 +605,24 @@ path_result findShortestPathUnidirectional(const graph& gdata, search_buffers& b
             if (old_cost < 0 || new_cost < old_cost)
             {
                 setDistFromStart(buffers, nbr_idx, new_cost);
-                setParentForward(buffers, nbr_idx, { cur_idx, edge_cost });
+                if (reopen) {
+                    clearClosed(buffers, nbr_idx);
+                }
+                if (store_parents) {
+                    setParentForward(buffers, nbr_idx, { cur_idx, edge_cost });
+                }
 
                 int h_val = getHForward(buffers, nbr_idx);
                 if (h_val < 0)
                 {
-                    h_val = computeHeuristic(nbr_idx, end_idx, gdata, conf);
+                    h_val = heuristic(nbr_idx);
                     setHForward(buffers, nbr_idx, h_val);
                 }
                 double f_cost = (double)new_cost + weight * (double)h_val;
-                open_list.push({ f_cost, (size_t)nbr_idx });
+                open_list.push_back({ f_cost, (size_t)nbr_idx });
+                std::push_heap(open_list.begin(), open_list.end(), cmp);
             }
         }
     }
     return { -1, 0, {} };
-}
\ No newline at end of file
+}
@@ -0,0 +1,358 @@
+﻿#include "incl.h"
+#include "decl.h"
+
+namespace {
+    /**
+     * @brief Returns the CSR range `[begin, end)` of the edges of a node index.
+     */
+    inline std::pair<size_t, size_t> edgeRange(const graph& gdata, size_t idx)
+    {
+        size_t end = gdata.offsets[idx + 1];
+        return { gdata.offsets[idx], end };
+    }
+
+    /**
+     * @brief Appends the nodes met when climbing from a pruned node to its attachment.
+     *
+     * @param slot Pruned node to start from (appended first).
+     * @param stop Slot to stop at, excluded (`-1` = up to the attachment, also excluded).
+     */
+    void appendTreeClimb(const tree_pruning& tp, int slot, int stop, std::vector<int>& out)
+    {
+        while (slot != stop) {
+            out.push_back(tp.node[slot]);
+            slot = tp.parent[slot];
+        }
+    }
+}
+
+/**
+ * @brief Removes the trees hanging off the 2-core of the graph (dead ends, cul-de-sacs).
+ *
+ * @detailed
+ * A node with a single neighbour can only be the first or last node of a shortest path,
+ * never an intermediate one. Peeling such nodes until none is left gives the 2-core; every
+ * peeled node belongs to a tree attached to exactly one core node.
+ *
+ * - Degrees count distinct neighbours (parallel edges and self-loops do not keep a dead end
+ *   alive); a node is peeled when at most one unpeeled neighbour remains, which becomes its
+ *   parent (the cheapest parallel edge gives the tree edge weight).
+ * - A node peeled without any neighbour left is the last node of a component that is a
+ *   whole tree: it stays in the graph (isolated) and serves as the attachment of its tree.
+ * - For each pruned node, `gdata.trees` stores its parent, attachment, distance to the
+ *   attachment and depth, filled in reverse peeling order (parents first), and `hanging`
+ *   lists the slots of each attachment in the same order.
+ * - The CSR, `node_to_index` and `index_to_node` are rebuilt over the core nodes, so the
+ *   ALT table, the search buffers and every engine only cover the core.
+ *
+ * Must run right after the CSR is built (before `compressChains()`, since peeling trees
+ * leaves new degree-2 nodes). The node and edge reduction is logged.
+ *
+ * @param gdata Reference to the graph data.
+ *
+ * @complexity
+ * - Time Complexity: O(V + E).
+ * - Space Complexity: O(V).
+ */
+void pruneTrees(graph& gdata)
+{
+    auto& tp = gdata.trees;
+    tp = tree_pruning();
+    const size_t n = gdata.index_to_node.size();
+    tp.original_nodes = n;
+    tp.original_edges = gdata.edges.size() / 2;
+
+    std::vector<int> mark(n, -1);
+    std::vector<int> degree(n, 0);
+    for (size_t idx = 0; idx < n; ++idx) {
+        auto [begin, end] = edgeRange(gdata, idx);
+        for (size_t pos = begin; pos < end; ++pos) {
+            size_t nbr = (size_t)gdata.edges[pos].target;
+            if (nbr != idx && mark[nbr] != (int)idx) {
+                mark[nbr] = (int)idx;
+                degree[idx]++;
+            }
+        }
+    }
+
+    std::vector<char> peeled(n, 0);
+    std::vector<int> parent_idx(n, -1);
+    std::vector<int> parent_weight(n, 0);
+    std::vector<size_t> order;
+    std::vector<size_t> stack;
+    for (size_t idx = 0; idx < n; ++idx) {
+        if (degree[idx] <= 1) {
+            stack.push_back(idx);
+        }
+    }
+    std::fill(mark.begin(), mark.end(), -1);
+    while (!stack.empty()) {
+        size_t idx = stack.back();
+        stack.pop_back();
+        if (peeled[idx]) {
+            continue;
+        }
+        peeled[idx] = 1;
+        order.push_back(idx);
+        auto [begin, end] = edgeRange(gdata, idx);
+        for (size_t pos = begin; pos < end; ++pos) {
+            size_t nbr = (size_t)gdata.edges[pos].target;
+            if (nbr == idx || peeled[nbr]) {
+                continue;
+            }
+            if (parent_idx[idx] < 0 || gdata.edges[pos].weight < parent_weight[idx]) {
+                parent_idx[idx] = (int)nbr;
+                parent_weight[idx] = gdata.edges[pos].weight;
+            }
+            if (mark[nbr] != (int)idx) {
+                mark[nbr] = (int)idx;
+                if (--degree[nbr] <= 1) {
+                    stack.push_back(nbr);
+                }
+            }
+        }
+    }
+
+    // nodes peeled without a parent are the roots of whole-tree components: they stay.
+    std::vector<int> slot(n, -1);
+    for (size_t k = order.size(); k-- > 0;) {
+        size_t idx = order[k];
+        if (parent_idx[idx] < 0) {
+            peeled[idx] = 0;
+            continue;
+        }
+        size_t par = (size_t)parent_idx[idx];
+        int s = (int)tp.node.size();
+        slot[idx] = s;
+        tp.node.push_back(gdata.index_to_node[idx]);
+        tp.position[gdata.index_to_node[idx]] = (size_t)s;
+        if (peeled[par]) {
+            tp.parent.push_back(slot[par]);
+            tp.attachment.push_back(tp.attachment[slot[par]]);
+            tp.dist.push_back(tp.dist[slot[par]] + parent_weight[idx]);
+            tp.depth.push_back(tp.depth[slot[par]] + 1);
+        }
+        else {
+            tp.parent.push_back(-1);
+            tp.attachment.push_back(gdata.index_to_node[par]);
+            tp.dist.push_back(parent_weight[idx]);
+            tp.depth.push_back(1);
+        }
+    }
+    if (tp.node.empty()) {
+        logger("tree pruning: the graph has no dead end.");
+        return;
+    }
+    for (size_t s = 0; s < tp.node.size(); ++s) {
+        tp.hanging[tp.attachment[s]].push_back((int)s);
+    }
+
+    std::vector<int> new_index(n, -1);
+    std::vector<int> index_to_node;
+    for (size_t idx = 0; idx < n; ++idx) {
+        if (!peeled[idx]) {
+            new_index[idx] = (int)index_to_node.size();
+            index_to_node.push_back(gdata.index_to_node[idx]);
+        }
+    }
+    huge_vector<size_t> offsets;
+    huge_vector<graph::edge_repr> edges;
+    offsets.reserve(index_to_node.size() + 1);
+    for (size_t idx = 0; idx < n; ++idx) {
+        if (peeled[idx]) {
+            continue;
+        }
+        offsets.push_back(edges.size());
+        auto [begin, end] = edgeRange(gdata, idx);
+        for (size_t pos = begin; pos < end; ++pos) {
+            int target = gdata.edges[pos].target;
+            if (!peeled[target]) {
+                edges.push_back({ new_index[target], gdata.edges[pos].weight });
+            }
+        }
+    }
+    offsets.push_back(edges.size());
+
+    gdata.node_to_index.clear();
+    for (size_t idx = 0; idx < index_to_node.size(); ++idx) {
+        gdata.node_to_index[index_to_node[idx]] = idx;
+    }
+    gdata.index_to_node = std::move(index_to_node);
+    gdata.index_count = gdata.index_to_node.size();
+    gdata.offsets = std::move(offsets);
+    gdata.edges = std::move(edges);
+    tp.built = true;
+
+    size_t kept_nodes = gdata.index_to_node.size();
+    size_t kept_edges = gdata.edges.size() / 2;
+    std::stringstream ss;
+    ss << "tree pruning: 2-core nodes " << tp.original_nodes << " -> " << kept_nodes
+       << " (-" << std::fixed << std::setprecision(1) << 100.0 * (double)(tp.original_nodes - kept_nodes) / (double)std::max<size_t>(tp.original_nodes, 1)
+       << "%), edges " << tp.original_edges << " -> " << kept_edges
+       << " (-" << 100.0 * (double)(tp.original_edges - kept_edges) / (double)std::max<size_t>(tp.original_edges, 1) << "%).";
+    console("success", ss.str());
+    logger(ss.str());
+}
+
+/**
+ * @brief Answers a point-to-point query on the 2-core, for any original node.
+ *
+ * @detailed
+ * - A pruned endpoint is replaced by its attachment; the answer is the core query between
+ *   the two attachments plus both tree walks (`dist` to the attachment).
+ * - Both endpoints in the same tree (same attachment, one of them possibly the attachment
+ *   itself): the only path is inside the tree, through their lowest common ancestor, and
+ *   no core query is run.
+ * - A pruned node queried against itself is answered directly (`0`, no steps), like the
+ *   engines answer a core node.
+ * - The core query goes through `routeThroughChains()`, so chain compression (applied to
+ *   the core) is handled too; with no pruning, this is exactly that call.
+ *
+ * @param gdata Reference to the graph data.
+ * @param start_node The starting node (original ID).
+ * @param end_node The target node (original ID).
+ * @param distance_only If `true`, only `total_time` is computed (`engine` must do the same).
+ * @param engine Point-to-point engine on the reduced graph.
+ * @return A `path_result` on the original graph (`-1` if no path or unknown node).
+ *
+ * @complexity
+ * - Time Complexity: one core query, plus O(depth) for the tree walks.
+ * - Space Complexity: O(P).
+ */
+path_result routeThroughTrees(const graph& gdata, int start_node, int end_node, bool distance_only, const std::function<path_result(int, int)>& engine)
+{
+    const auto& tp = gdata.trees;
+    if (!tp.built) {
+        return routeThroughChains(gdata, start_node, end_node, distance_only, engine);
+    }
+    if (start_node == end_node) {
+        return tp.position.count(start_node) ? path_result{ 0, 0, {} } : routeThroughChains(gdata, start_node, end_node, distance_only, engine);
+    }
+
+    auto it_start = tp.position.find(start_node);
+    auto it_end = tp.position.find(end_node);
+    int start_slot = (it_start == tp.position.end()) ? -1 : (int)it_start->second;
+    int end_slot = (it_end == tp.position.end()) ? -1 : (int)it_end->second;
+    if (start_slot < 0 && end_slot < 0) {
+        return routeThroughChains(gdata, start_node, end_node, distance_only, engine);
+    }
+
+    int start_root = (start_slot < 0) ? start_node : tp.attachment[start_slot];
+    int end_root = (end_slot < 0) ? end_node : tp.attachment[end_slot];
+    int start_dist = (start_slot < 0) ? 0 : tp.dist[start_slot];
+    int end_dist = (end_slot < 0) ? 0 : tp.dist[end_slot];
+
+    path_result result{};
+    std::vector<int> tail;
+    if (start_root == end_root) {
+        int a = start_slot;
+        int b = end_slot;
+        auto depthOf = [&](int s) { return (s < 0) ? 0 : tp.depth[s]; };
+        while (depthOf(a) > depthOf(b)) a = tp.parent[a];
+        while (depthOf(b) > depthOf(a)) b = tp.parent[b];
+        while (a != b) {
+            a = tp.parent[a];
+            b = tp.parent[b];
+        }
+        int lca_dist = (a < 0) ? 0 : tp.dist[a];
+        result.total_time = start_dist + end_dist - 2 * lca_dist;
+        if (distance_only) {
+            return { result.total_time, 0, {} };
+        }
+        appendTreeClimb(tp, start_slot, a, result.steps);
+        result.steps.push_back((a < 0) ? start_root : tp.node[a]);
+        appendTreeClimb(tp, end_slot, a, tail);
+    }
+    else {
+        path_result core = routeThroughChains(gdata, start_root, end_root, distance_only, engine);
+        if (core.total_time < 0) {
+            return { -1, 0, {} };
+        }
+        result.total_time = start_dist + core.total_time + end_dist;
+        if (distance_only) {
+            return { result.total_time, 0, {} };
+        }
+        appendTreeClimb(tp, start_slot, -1, result.steps);
+        result.steps.insert(result.steps.end(), core.steps.begin(), core.steps.end());
+        appendTreeClimb(tp, end_slot, -1, tail);
+    }
+    result.steps.insert(result.steps.end(), tail.rbegin(), tail.rend());
+    result.total_node = (int)result.steps.size();
+    return result;
+}
+
+/**
+ * @brief Tells whether an original node was removed from the search graph.
+ *
+ * @detailed
+ * Nodes pruned by `pruneTrees()` or collapsed by `compressChains()` are not in
+ * `node_to_index`: the searches reach them through `searchGraphExits()`.
+ *
+ * @param gdata Reference to the graph data.
+ * @param node Original node ID.
+ * @return `true` if the node exists in the CSV but not in the search graph.
+ */
+bool isReducedNode(const graph& gdata, int node)
+{
+    return (gdata.trees.built && gdata.trees.position.count(node)) || (gdata.chains.built && gdata.chains.position.count(node));
+}
+
+/**
+ * @brief Lists the search graph nodes through which an original node is reached.
+ *
+ * @detailed
+ * A node of the search graph is reached through itself. A pruned node goes through its
+ * attachment (`dist` further), which may itself be collapsed into a chain, and a chain
+ * node through both ends of its chain (`chainNodeExits()`). Every path from or to the
+ * node enters the search graph at one of these exits, at the listed cost, except the
+ * paths that stay inside one tree or chain (see `reducedLocalDistance()`).
+ *
+ * @param gdata Reference to the graph data.
+ * @param node Original node ID.
+ * @return `(node ID, cost)` pairs, at most two (empty for unknown nodes).
+ *
+ * @complexity
+ * - Time Complexity: O(log C) (chain lookup).
+ * - Space Complexity: O(1).
+ */
+std::vector<std::pair<int, int>> searchGraphExits(const graph& gdata, int node)
+{
+    int base = 0;
+    if (gdata.trees.built) {
+        auto it = gdata.trees.position.find(node);
+        if (it != gdata.trees.position.end()) {
+            base = gdata.trees.dist[it->second];
+            node = gdata.trees.attachment[it->second];
+        }
+    }
+    std::vector<std::pair<int, int>> exits = chainNodeExits(gdata, node);
+    for (auto& exit : exits) {
+        exit.second += base;
+    }
+    return exits;
+}
+
+/**
+ * @brief Length of the best path between two original nodes that needs no search.
+ *
+ * @detailed
+ * Two nodes of the same tree, of the same chain, or of trees hanging from the same chain,
+ * can be joined without running a search (LCA walk, walk along the chain). The one-to-many
+ * searches only see paths through `searchGraphExits()`, so they take the minimum of both.
+ * Runs `routeThroughTrees()` with an engine that never finds a path.
+ *
+ * @param gdata Reference to the graph data.
+ * @param a First original node ID.
+ * @param b Second original node ID.
+ * @return The distance, or `-1` if every path goes through a search.
+ *
+ * @complexity
+ * - Time Complexity: O(depth + log C).
+ * - Space Complexity: O(1).
+ */
+int reducedLocalDistance(const graph& gdata, int a, int b)
+{
+    return routeThroughTrees(gdata, a, b, true, [](int, int) {
+        return path_result{ -1, 0, {} };
+    }).total_time;
+}
@@ -0,0 +1,344 @@
+﻿#include "incl.h"
+#include "decl.h"
+
+namespace {
+    /**
+     * @brief Returns the CSR range `[begin, end)` of the edges of a node index.
+     */
+    inline std::pair<size_t, size_t> edgeRange(const graph& gdata, size_t idx)
+    {
+        size_t end = gdata.offsets[idx + 1];
+        return { gdata.offsets[idx], end };
+    }
+
+    /**
+     * @brief Lowers one landmark column below the decreased edges (incremental repair).
+     *
+     * @detailed
+     * The column is a feasible potential of the metric the landmarks were computed with:
+     * `d(v) <= d(u) + w(u, v)` on every edge. Increases keep it feasible; a decrease may
+     * break it on the changed edge only. Starting from the endpoints of the decreased edges,
+     * a label-correcting Dijkstra lowers every value that violates the inequality until none
+     * does. The column is then feasible (hence consistent and admissible) for the current
+     * weights, and only the region that got closer to the landmark is visited.
+     *
+     * Unreachable entries (`-1`) stay unreachable: the topology never changes.
+     *
+     * @param gdata Reference to the graph data (current weights).
+     * @param landmark Column to repair (full `int` rows only).
+     * @param decreased Edges `(u, v)` whose weight went down, as node indices.
+     *
+     * @complexity
+     * - Time Complexity: O(E' log V') over the lowered region.
+     * - Space Complexity: O(V').
+     */
+    void lowerLandmarkColumn(graph& gdata, size_t landmark, const std::vector<std::pair<size_t, size_t>>& decreased)
+    {
+        auto& table = gdata.dist_landmark;
+        using pq_item = std::pair<int, size_t>;
+        std::priority_queue<pq_item, std::vector<pq_item>, std::greater<pq_item>> queue;
+
+        auto relax = [&](size_t from, size_t to, int weight) {
+            int d_from = table.row(from)[landmark];
+            int& d_to = table.row(to)[landmark];
+            if (d_from >= 0 && d_to >= 0 && d_from + weight < d_to) {
+                d_to = d_from + weight;
+                queue.push({ d_to, to });
+            }
+        };
+
+        for (const auto& [u, v] : decreased) {
+            auto [begin, end] = edgeRange(gdata, u);
+            for (size_t pos = begin; pos < end; ++pos) {
+                if ((size_t)gdata.edges[pos].target == v) {
+                    relax(u, v, gdata.edges[pos].weight);
+                    relax(v, u, gdata.edges[pos].weight);
+                }
+            }
+        }
+
+        while (!queue.empty()) {
+            auto [d, idx] = queue.top();
+            queue.pop();
+            if (d != table.row(idx)[landmark]) {
+                continue;
+            }
+            auto [begin, end] = edgeRange(gdata, idx);
+            for (size_t pos = begin; pos < end; ++pos) {
+                relax(idx, (size_t)gdata.edges[pos].target, gdata.edges[pos].weight);
+            }
+        }
+    }
+
+    /**
+     * @brief Returns node `k` of chain `c`, counting `from[c]` as `0` and `to[c]` as the last one.
+     */
+    inline int chainNode(const chain_compression& cc, int c, size_t k)
+    {
+        size_t count = cc.first[c + 1] - cc.first[c];
+        return (k == 0) ? cc.from[c] : (k > count) ? cc.to[c] : cc.interior[cc.first[c] + k - 1];
+    }
+
+    /**
+     * @brief Returns the distance of node `k` of chain `c` from `from[c]` (same numbering as `chainNode()`).
+     */
+    inline int chainOffset(const chain_compression& cc, int c, size_t k)
+    {
+        size_t count = cc.first[c + 1] - cc.first[c];
+        return (k == 0) ? 0 : (k > count) ? cc.length[c] : cc.offset[cc.first[c] + k - 1];
+    }
+
+    /**
+     * @brief Finds the chain segment between two original nodes, one of them removed by `compressChains()`.
+     *
+     * @param removed The removed node (key of `cc.position`).
+     * @param other The other end of the edge.
+     * @param chain Receives the chain of `removed`.
+     * @param segment Receives `k` such that the edge joins nodes `k` and `k + 1` of the chain.
+     * @return `false` if `other` is not next to `removed` on its chain.
+     */
+    bool findChainSegment(const chain_compression& cc, int removed, int other, int& chain, size_t& segment)
+    {
+        size_t slot = cc.position.at(removed);
+        chain = (int)(std::upper_bound(cc.first.begin(), cc.first.end(), slot) - cc.first.begin()) - 1;
+        size_t k = slot - cc.first[chain] + 1;
+        if (chainNode(cc, chain, k - 1) == other) {
+            segment = k - 1;
+            return true;
+        }
+        if (chainNode(cc, chain, k + 1) == other) {
+            segment = k;
+            return true;
+        }
+        return false;
+    }
+}
+
+/**
+ * @brief Applies a batch of live travel time changes to the graph.
+ *
+ * @detailed
+ * Every edge of the batch must exist (same node IDs as the CSV, either direction) and its
+ * new weight must be at least `1`; otherwise nothing is applied. Each accepted update then
+ * patches every CSR entry between the two nodes, in both adjacency lists.
+ *
+ * With chain compression, the collapsed edges are not edges of the CSV: an update between
+ * two kept nodes only patches their original edges, and the chain edges between them are
+ * left alone. An update touching a removed node is mapped onto its chain segment: the
+ * offsets of the nodes after it and the chain length move by the difference, and the two
+ * CSR entries of the chain (none for a loop) take the new length.
+ *
+ * Preprocessing that depends on the weights:
+ * - Landmarks: increases keep every ALT bound admissible and consistent. Decreases are
+ *   summed in `gdata.updates.decrease_total` (per edge, against the weight the landmarks
+ *   were computed with) and published as `landmark_table::slack`, which the bounds subtract
+ *   until `repairLandmarks()` runs.
+ * - The contraction hierarchy used by PHAST is dropped (one-to-all queries fall back to
+ *   delta-stepping); the CCH metric has to be customized again by the caller.
+ *
+ * Consistency: the caller must not run queries while the batch is applied (the API applies
+ * it on the gateway thread, between requests), so every query sees a single epoch.
+ *
+ * @param gdata Reference to the graph data.
+ * @param batch Updates to apply.
+ * @return `false` if an update is invalid (the graph is left untouched).
+ *
+ * @complexity
+ * - Time Complexity: O(B × D) with `D` the degree of the updated nodes.
+ * - Space Complexity: O(B) for the tracked ALT weights.
+ */
+bool applyEdgeUpdates(graph& gdata, const std::vector<edge_update>& batch)
+{
+    auto& cc = gdata.chains;
+    auto entry_chain = [&](size_t pos) { return cc.built ? cc.edge_chain[pos] : -1; };
+
+    for (const auto& upd : batch) {
+        if (upd.weight < 1) {
+            return false;
+        }
+        int chain = -1;
+        size_t segment = 0;
+        if (cc.built && cc.position.count(upd.from)) {
+            if (!findChainSegment(cc, upd.from, upd.to, chain, segment)) {
+                return false;
+            }
+            continue;
+        }
+        if (cc.built && cc.position.count(upd.to)) {
+            if (!findChainSegment(cc, upd.to, upd.from, chain, segment)) {
+                return false;
+            }
+            continue;
+        }
+        auto it_from = gdata.node_to_index.find(upd.from);
+        auto it_to = gdata.node_to_index.find(upd.to);
+        if (it_from == gdata.node_to_index.end() || it_to == gdata.node_to_index.end()) {
+            return false;
+        }
+        auto [begin, end] = edgeRange(gdata, it_from->second);
+        bool found = false;
+        for (size_t pos = begin; pos < end && !found; ++pos) {
+            found = ((size_t)gdata.edges[pos].target == it_to->second && entry_chain(pos) < 0);
+        }
+        if (!found) {
+            return false;
+        }
+    }
+
+    auto& state = gdata.updates;
+    const bool track_alt = !gdata.dist_landmark.empty();
+    size_t increases = 0;
+    size_t decreases = 0;
+
+    for (const auto& upd : batch) {
+        int chain = -1;
+        size_t segment = 0;
+        int weight = upd.weight;
+        size_t idx_a = 0;
+        size_t idx_b = 0;
+        bool removed_from = cc.built && cc.position.count(upd.from);
+        if (removed_from || (cc.built && cc.position.count(upd.to))) {
+            findChainSegment(cc, removed_from ? upd.from : upd.to, removed_from ? upd.to : upd.from, chain, segment);
+            int delta = upd.weight - (chainOffset(cc, chain, segment + 1) - chainOffset(cc, chain, segment));
+            if (delta == 0) {
+                continue;
+            }
+            for (size_t slot = cc.first[chain] + segment; slot < cc.first[chain + 1]; ++slot) {
+                cc.offset[slot] += delta;
+            }
+            cc.length[chain] += delta;
+            if (cc.from[chain] == cc.to[chain]) {
+                increases += (delta > 0);
+                decreases += (delta < 0);
+                continue;
+            }
+            weight = cc.length[chain];
+            idx_a = gdata.node_to_index.at(cc.from[chain]);
+            idx_b = gdata.node_to_index.at(cc.to[chain]);
+        }
+        else {
+            idx_a = gdata.node_to_index.at(upd.from);
+            idx_b = gdata.node_to_index.at(upd.to);
+        }
+        size_t low = std::min(idx_a, idx_b);
+        size_t high = std::max(idx_a, idx_b);
+
+        auto [begin, end] = edgeRange(gdata, low);
+        for (size_t pos = begin; pos < end; ++pos) {
+            auto& e = gdata.edges[pos];
+            if ((size_t)e.target != high || entry_chain(pos) != chain || e.weight == weight) {
+                continue;
+            }
+            increases += (weight > e.weight);
+            decreases += (weight < e.weight);
+            if (track_alt) {
+                auto it = state.alt_weights.find(pos);
+                int alt_weight = (it == state.alt_weights.end()) ? e.weight : it->second;
+                state.decrease_total -= std::max(alt_weight - e.weight, 0);
+                state.decrease_total += std::max(alt_weight - weight, 0);
+                if (alt_weight == weight) {
+                    state.alt_weights.erase(pos);
+                }
+                else {
+                    state.alt_weights[pos] = alt_weight;
+                }
+            }
+            e.weight = weight;
+        }
+
+        auto [rbegin, rend] = edgeRange(gdata, high);
+        for (size_t pos = rbegin; pos < rend; ++pos) {
+            if ((size_t)gdata.edges[pos].target == low && entry_chain(pos) == chain) {
+                gdata.edges[pos].weight = weight;
+            }
+        }
+    }
+
+    state.epoch++;
+    state.increases += increases;
+    state.decreases += decreases;
+    gdata.dist_landmark.slack = (int)std::min<int64_t>(state.decrease_total, std::numeric_limits<int>::max());
+
+    if (gdata.ch.built) {
+        gdata.ch = contraction_hierarchy();
+        console("warning", "contraction hierarchy dropped after a weight update (one-to-all queries use delta-stepping).");
+        logger("warning: contraction hierarchy dropped after a weight update.");
+    }
+
+    std::string msg = "weight update epoch " + std::to_string(state.epoch) + ": " + std::to_string(batch.size())
+        + " edges, " + std::to_string(increases) + " increases, " + std::to_string(decreases) + " decreases, ALT slack "
+        + std::to_string(gdata.dist_landmark.slack) + ".";
+    console("info", msg);
+    logger(msg);
+    return true;
+}
+
+/**
+ * @brief Repairs the landmark rows after live weight decreases, so the ALT slack drops to `0`.
+ *
+ * @detailed
+ * - Full tables are repaired incrementally: each column is lowered from the decreased edges
+ *   by `lowerLandmarkColumn()`, which only visits the nodes that got closer to the landmark.
+ *   Columns stay valid lower bounds but are no longer exact after increases (they are never
+ *   raised), which only makes the heuristic weaker on the slowed-down routes.
+ * - Compact tables are quantised, so their columns are recomputed from the landmark nodes
+ *   with `computeOneToAll()` (exact again, including increases).
+ *
+ * Afterwards the current weights become the landmark metric: the tracked weights and the
+ * decrease total are cleared, `slack` is reset and the POI set ranges are recomputed
+ * (`refreshPoiBounds()`).
+ *
+ * @param gdata Reference to the graph data.
+ * @param conf Configuration (`nb_threads` for the compact recomputation).
+ * @return `false` if the table could not be repaired (compact table without landmark nodes).
+ *
+ * @complexity
+ * - Time Complexity: O(L × E' log V') (full), O(L × E log V / T) (compact).
+ * - Space Complexity: O(V).
+ */
+bool repairLandmarks(graph& gdata, const config& conf)
+{
+    auto& table = gdata.dist_landmark;
+    auto& state = gdata.updates;
+    if (table.empty() || state.alt_weights.empty()) {
+        return true;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if (table.compact) {
+        for (size_t l = 0; l < table.landmark_count; ++l) {
+            if (table.landmark_nodes[l] < 0) {
+                console("error", "landmark repair skipped: the ALT file does not record the landmark nodes.");
+                logger("error: landmark repair skipped: the ALT file does not record the landmark nodes.");
+                return false;
+            }
+        }
+        const size_t n = gdata.index_to_node.size();
+        for (size_t l = 0; l < table.landmark_count; ++l) {
+            setLandmarkColumn(table, l, computeOneToAll(gdata, table.landmark_nodes[l], n, conf.nb_threads));
+        }
+    }
+    else {
+        std::vector<std::pair<size_t, size_t>> decreased;
+        for (const auto& [pos, alt_weight] : state.alt_weights) {
+            if (gdata.edges[pos].weight < alt_weight) {
+                size_t low = (size_t)(std::upper_bound(gdata.offsets.begin(), gdata.offsets.end(), pos) - gdata.offsets.begin() - 1);
+                decreased.push_back({ low, (size_t)gdata.edges[pos].target });
+            }
+        }
+        for (size_t l = 0; l < table.landmark_count; ++l) {
+            lowerLandmarkColumn(gdata, l, decreased);
+        }
+    }
+
+    state.alt_weights.clear();
+    state.decrease_total = 0;
+    state.repairs++;
+    table.slack = 0;
+    refreshPoiBounds(gdata);
+
+    auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    console("success", "landmarks repaired after weight decreases in " + std::to_string(elapsed_ms) + " ms.");
+    logger("landmarks repaired after weight decreases in " + std::to_string(elapsed_ms) + " ms.");
+    return true;
+}